@@ -29,8 +29,10 @@
 #include <AMReX_DistributionMapping.H>
 #include <AMReX_FabSet.H>
 #include <AMReX_StateData.H>
+#include <AMReX_FillPatchUtil.H>
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_Print.H>
+#include <AMReX_Telemetry.H>
 
 #ifdef BL_LAZY
 #include <AMReX_Lazy.H>
@@ -108,6 +110,7 @@ namespace
     int  checkpoint_nfiles;
     int  regrid_on_restart;
     int  use_efficient_regrid;
+    int  cache_crse_fillpatch;
     int  plotfile_on_restart;
     int  insitu_on_restart;
     int  checkpoint_on_restart;
@@ -143,6 +146,7 @@ Amr::Initialize ()
     checkpoint_nfiles        = 64;
     regrid_on_restart        = 0;
     use_efficient_regrid     = 0;
+    cache_crse_fillpatch     = 0;
     plotfile_on_restart      = 0;
     insitu_on_restart        = 0;
     checkpoint_on_restart    = 0;
@@ -282,6 +286,7 @@ Amr::InitAmr ()
     //
     pp.query("regrid_on_restart",regrid_on_restart);
     pp.query("use_efficient_regrid",use_efficient_regrid);
+    pp.query("cache_crse_fillpatch",cache_crse_fillpatch);
     pp.query("plotfile_on_restart",plotfile_on_restart);
     pp.query("insitu_on_restart",insitu_on_restart);
     pp.query("checkpoint_on_restart",checkpoint_on_restart);
@@ -2107,6 +2112,23 @@ Amr::timeStep (int  level,
         {
             const int ncycle = n_cycle[lev_fine];
 
+            //
+            // The data at this level do not change while the finer level is
+            // subcycled.  So the coarse patches received by the finer level's
+            // FillPatch can be kept for all of its substeps.
+            //
+            Vector<FabArrayBase const*> crse_data;
+            if (cache_crse_fillpatch && ncycle > 1)
+            {
+                for (int i = 0; i < AmrLevel::get_desc_lst().size(); ++i)
+                {
+                    const StateData& sd = amr_level[level]->get_state_data(i);
+                    if (sd.hasOldData()) crse_data.push_back(&sd.oldData());
+                    if (sd.hasNewData()) crse_data.push_back(&sd.newData());
+                }
+            }
+            FillPatchCrseDataCache fpcache(crse_data, cache_crse_fillpatch && ncycle > 1);
+
             BL_COMM_PROFILE_NAMETAG("Amr::timeStep timeStep subcycle");
             for (int i = 1; i <= ncycle; i++)
                 timeStep(lev_fine,time+(i-1)*dt_level[lev_fine],i,ncycle,stop_time);
@@ -2163,6 +2185,8 @@ Amr::coarseTimeStep (Real stop_time)
 
     run_strt = amrex::second() ;
 
+    Telemetry::StartStep(level_steps[0], cumtime);
+
     //
     // Compute new dt.
     //
@@ -2421,6 +2445,8 @@ Amr::coarseTimeStep (Real stop_time)
     }
 #endif
 
+    Telemetry::StopStep();
+
     BL_PROFILE_ADD_STEP(level_steps[0]);
     BL_PROFILE_REGION_STOP("Amr::coarseTimeStep()");
     BL_COMM_PROFILE_NAMETAG(stepName.str());
@@ -2781,7 +2807,7 @@ Amr::defBaseLevel (Real              strt_time,
     }
 
     this->SetBoxArray(0, lev0);
-    this->SetDistributionMap(0, DistributionMapping(lev0));
+    this->SetDistributionMap(0, MakeDistributionMap(0, lev0));
 
     //
     // Now build level 0 grids.
@@ -2799,6 +2825,7 @@ Amr::regrid (int  lbase,
              bool initial)
 {
     BL_PROFILE("Amr::regrid()");
+    Telemetry::Region tel("regrid");
 
     if (lbase > std::min(finest_level,max_level-1)) return;
 
@@ -2870,7 +2897,7 @@ Amr::regrid (int  lbase,
             new_dmap[lev] = makeLoadBalanceDistributionMap(lev, time, new_grid_places[lev]);
         }
         else if (new_dmap[lev].empty()) {
-	    new_dmap[lev].define(new_grid_places[lev]);
+	    new_dmap[lev] = MakeDistributionMap(lev, new_grid_places[lev]);
 	}
 
         AmrLevel* a = (*levelbld)(*this,lev,Geom(lev),new_grid_places[lev],
@@ -3059,7 +3086,7 @@ Amr::regrid_level_0_on_restart()
 	//
 	// Construct skeleton of new level.
 	//
-	DistributionMapping dm(lev0);
+	DistributionMapping dm = MakeDistributionMap(0, lev0);
 	AmrLevel* a = (*levelbld)(*this,0,Geom(0),lev0,dm,cumtime);
 	
 	a->init(*amr_level[0]);
@@ -3271,7 +3298,7 @@ Amr::bldFineLevels (Real strt_time)
         //
         finest_level = new_finest;
 
-	DistributionMapping new_dm {new_grids[new_finest]};
+	DistributionMapping new_dm = MakeDistributionMap(new_finest, new_grids[new_finest]);
 
         AmrLevel* level = (*levelbld)(*this,
                                       new_finest,
@@ -6,6 +6,11 @@
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_Print.H>
 
+#ifdef AMREX_USE_EB
+#include <AMReX_EB2.H>
+#include <AMReX_EBFabFactory.H>
+#endif
+
 namespace amrex {
 
 AmrMesh::AmrMesh ()
@@ -354,6 +359,8 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 	pp.query("refine_grid_layout", refine_grid_layout);
     }
 
+    pp.query("eb_load_balance", eb_load_balance);
+
     pp.query("check_input", check_input);
 
     finest_level = -1;
@@ -462,6 +469,34 @@ AmrMesh::MakeBaseGrids () const
     return ba;
 }
 
+DistributionMapping
+AmrMesh::MakeDistributionMap (int lev, const BoxArray& ba) const
+{
+#ifdef AMREX_USE_EB
+    if (eb_load_balance)
+    {
+        const auto strategy = DistributionMapping::strategy();
+        const EB2::IndexSpace* ebis = EB2::TopIndexSpaceIfPresent();
+        if ((strategy == DistributionMapping::KNAPSACK || strategy == DistributionMapping::SFC)
+            && ebis && ebis->hasLevel(geom[lev].Domain()))
+        {
+            const EB2::Level& eblev = ebis->getLevel(geom[lev]);
+            if (!eblev.isAllRegular())
+            {
+                BL_PROFILE("AmrMesh::MakeDistributionMap()");
+                const Vector<Real>& cost = EBBoxCosts(eblev, ba);
+                if (strategy == DistributionMapping::KNAPSACK) {
+                    return DistributionMapping::makeKnapSack(cost);
+                } else {
+                    return DistributionMapping::makeSFC(cost, ba);
+                }
+            }
+        }
+    }
+#endif
+    return DistributionMapping(ba);
+}
+
 
 void
 AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>& new_grids)
@@ -786,7 +821,7 @@ AmrMesh::MakeNewGrids (Real time)
 	finest_level = 0;
 
 	const BoxArray& ba = MakeBaseGrids();
-	DistributionMapping dm(ba);
+	DistributionMapping dm = MakeDistributionMap(0, ba);
         const auto old_num_setdm = num_setdm;
 
 	MakeNewLevelFromScratch(0, time, ba, dm);
@@ -811,7 +846,7 @@ AmrMesh::MakeNewGrids (Real time)
 	    if (new_finest <= finest_level) break;
 	    finest_level = new_finest;
 
-	    DistributionMapping dm(new_grids[new_finest]);
+	    DistributionMapping dm = MakeDistributionMap(new_finest, new_grids[new_finest]);
             const auto old_num_setdm = num_setdm;
 
             MakeNewLevelFromScratch(new_finest, time, new_grids[finest_level], dm);
@@ -842,7 +877,7 @@ AmrMesh::MakeNewGrids (Real time)
 	        for (int lev = 1; lev <= new_finest; ++lev) {
 		    if (new_grids[lev] != grids[lev]) {
 		        grids_the_same = false;
-		        DistributionMapping dm(new_grids[lev]);
+		        DistributionMapping dm = MakeDistributionMap(lev, new_grids[lev]);
                         const auto old_num_setdm = num_setdm;
 
                         MakeNewLevelFromScratch(lev, time, new_grids[lev], dm);
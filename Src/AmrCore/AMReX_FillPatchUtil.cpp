@@ -1,4 +1,5 @@
 #include <AMReX_FillPatchUtil.H>
+#include <AMReX_Interp_C.H>
 
 #ifndef BL_NO_FORT
 #include <AMReX_FillPatchUtil_F.H>
@@ -6,6 +7,105 @@
 
 namespace amrex
 {
+    bool InterpFused (const FArrayBox& crse, int crse_comp,
+                      FArrayBox& fine, int fine_comp, int ncomp,
+                      const Box& fine_region, const IntVect& ratio,
+                      Interpolater* mapper, const Geometry& cgeom,
+                      Vector<BCRec> const& bcr, RunOn runon)
+    {
+        if (!cgeom.IsCartesian()) return false;
+
+        Array4<Real const> const& crsearr = crse.const_array();
+        Array4<Real> const& finearr = fine.array();
+
+        auto ccl = dynamic_cast<CellConservativeLinear*>(mapper);
+        if (ccl && ccl->doLinearLimiting())
+        {
+            BL_PROFILE("InterpFused(CellConservativeLinear)");
+            AMREX_ASSERT(fine_region.cellCentered());
+
+            bool run_on_gpu = (runon == RunOn::Gpu && Gpu::inLaunchRegion());
+
+            const Box& cslope_bx = amrex::coarsen(fine_region,ratio);
+            const Dim3 slo = amrex::lbound(cslope_bx);
+            const Dim3 shi = amrex::ubound(cslope_bx);
+
+            AsyncArray<BCRec> async_bcr(bcr.data(), (run_on_gpu) ? ncomp : 0);
+            BCRec const* bcrp = (run_on_gpu) ? async_bcr.data() : bcr.data();
+
+            // One work item per coarse cell, which writes all its fine cells.
+            AMREX_HOST_DEVICE_PARALLEL_FOR_3D_FLAG (runon, cslope_bx, i, j, k,
+            {
+                amrex::cellconslin_interp_fused(i, j, k, fine_region, finearr, fine_comp, ncomp,
+                                                crsearr, crse_comp, slo, shi, bcrp, ratio);
+            });
+            return true;
+        }
+        else if (dynamic_cast<NodeBilinear*>(mapper))
+        {
+            BL_PROFILE("InterpFused(NodeBilinear)");
+            AMREX_ASSERT(fine_region.type() == IntVect::TheNodeVector());
+
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D_FLAG (runon, fine_region, ncomp, i, j, k, n,
+            {
+                amrex::nodebilin_interp_fused<Real>(i, j, k, n, finearr, fine_comp,
+                                                    crsearr, crse_comp, ratio);
+            });
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    int FillPatchCrseDataCache::m_next_id = 0;
+    Vector<FillPatchCrseDataCache const*> FillPatchCrseDataCache::m_alive;
+
+    FillPatchCrseDataCache::FillPatchCrseDataCache (Vector<FabArrayBase const*> const& crse_data,
+                                                    bool enable)
+    {
+        if (enable) {
+            m_id = m_next_id++;
+            m_crse_data = crse_data;
+            m_alive.push_back(this);
+        }
+    }
+
+    FillPatchCrseDataCache::~FillPatchCrseDataCache ()
+    {
+        if (m_id < 0) return;
+
+        AMREX_ASSERT(!m_alive.empty() && m_alive.back() == this);
+        m_alive.pop_back();
+
+        for (auto& kv : FabArrayBase::m_TheFillPatchCache)
+        {
+            auto& patches = kv.second->crse_src_patches;
+            patches.erase(std::remove_if(patches.begin(), patches.end(),
+                                         [=] (FabArrayBase::FPinfo::CrseSrcPatch const& p)
+                                         { return p.cache_id == m_id; }),
+                          patches.end());
+        }
+    }
+
+    int FillPatchCrseDataCache::find (Vector<FabArrayBase const*> const& crse_data) noexcept
+    {
+        for (auto it = m_alive.rbegin(); it != m_alive.rend(); ++it)
+        {
+            auto const& reg = (*it)->m_crse_data;
+            bool found = true;
+            for (auto fa : crse_data) {
+                if (std::find(reg.begin(), reg.end(), fa) == reg.end()) {
+                    found = false;
+                    break;
+                }
+            }
+            if (found) return (*it)->m_id;
+        }
+        return -1;
+    }
+
 #ifndef BL_NO_FORT
     // B fields are assumed to be on staggered grids.
     void InterpCrseFineBndryEMfield (InterpEM_t interp_type,
@@ -10,10 +10,47 @@
 #include <AMReX_FLUXREG_F.H>
 #endif
 
+#include <algorithm>
 #include <vector>
 
 namespace amrex {
 
+namespace {
+
+    //! Array4 of a with indices shifted by s.
+    Array4<Real const> shifted (Array4<Real const> const& a, IntVect const& s)
+    {
+        const Dim3 d = s.dim3();
+        return Array4<Real const>(a.p, Dim3{a.begin.x+d.x, a.begin.y+d.y, a.begin.z+d.z},
+                                  Dim3{a.end.x+d.x, a.end.y+d.y, a.end.z+d.z}, a.ncomp);
+    }
+
+    //! Exchanges packed data with the other processes.
+    void exchange (std::map<int,Vector<Real> >& snd, std::map<int,Vector<Real> >& rcv)
+    {
+#ifdef BL_USE_MPI
+        BL_PROFILE("FluxRegister::exchange()");
+        const int seqno = ParallelDescriptor::SeqNum();
+        MPI_Comm comm = ParallelDescriptor::Communicator();
+        Vector<MPI_Request> reqs;
+        for (auto& kv : rcv) {
+            reqs.push_back(ParallelDescriptor::Arecv(kv.second.data(), kv.second.size(),
+                                                     kv.first, seqno, comm).req());
+        }
+        for (auto& kv : snd) {
+            reqs.push_back(ParallelDescriptor::Asend(kv.second.data(), kv.second.size(),
+                                                     kv.first, seqno, comm).req());
+        }
+        if (!reqs.empty()) {
+            Vector<MPI_Status> stats(reqs.size());
+            ParallelDescriptor::Waitall(reqs, stats);
+        }
+#else
+        amrex::ignore_unused(snd,rcv);
+#endif
+    }
+}
+
 FluxRegister::FluxRegister ()
 {
     fine_level = ncomp = -1;
@@ -74,6 +111,8 @@ FluxRegister::define (const BoxArray&            fine_boxes,
     fine_level = fine_lev;
     ncomp      = nvar;
 
+    m_comm_plans.clear();
+
     grids = fine_boxes;
     grids.coarsen(ratio);
 
@@ -95,6 +134,88 @@ void
 FluxRegister::clear ()
 {
     BndryRegister::clear();
+    m_comm_plans.clear();
+}
+
+const FluxRegister::CommPlan&
+FluxRegister::getCommPlan (const BoxArray& cba, const DistributionMapping& cdm,
+                           const Periodicity& period) const
+{
+    for (auto const& p : m_comm_plans) {
+        if (p->period == period && p->cdm == cdm && p->cba == cba) return *p;
+    }
+
+    BL_PROFILE("FluxRegister::getCommPlan()");
+
+    std::unique_ptr<CommPlan> plan(new CommPlan);
+    plan->cba = cba;
+    plan->cdm = cdm;
+    plan->period = period;
+
+    const int myproc = ParallelDescriptor::MyProc();
+    const std::vector<IntVect>& pshifts = period.shiftIntVect();
+    std::vector<std::pair<int,Box> > isects;
+
+    for (OrientationIter fi; fi; ++fi)
+    {
+        const Orientation face = fi();
+        const BoxArray& rba = bndry[face].boxArray();
+        const DistributionMapping& rdm = bndry[face].DistributionMap();
+        const BoxArray& fcba = amrex::convert(cba, IntVect::TheDimensionVector(face.coordDir()));
+
+        for (int ridx = 0, N = rba.size(); ridx < N; ++ridx)
+        {
+            if (rdm[ridx] != myproc) continue;
+            for (const auto& iv : pshifts)
+            {
+                fcba.intersections(rba[ridx]+iv, isects);
+                for (const auto& is : isects)
+                {
+                    const int cidx = is.first;
+                    const CommTag tag{is.second-iv, iv, face, ridx, cidx};
+                    if (cdm[cidx] == myproc) {
+                        plan->local_tags.push_back(tag);
+                    } else {
+                        plan->reg_tags[cdm[cidx]].push_back(tag);
+                    }
+                }
+            }
+        }
+
+        for (int cidx = 0, N = fcba.size(); cidx < N; ++cidx)
+        {
+            if (cdm[cidx] != myproc) continue;
+            for (const auto& iv : pshifts)
+            {
+                rba.intersections(fcba[cidx]-iv, isects);
+                for (const auto& is : isects)
+                {
+                    const int ridx = is.first;
+                    if (rdm[ridx] != myproc) {
+                        plan->crse_tags[rdm[ridx]].push_back(CommTag{is.second, iv, face, ridx, cidx});
+                    }
+                }
+            }
+        }
+    }
+
+    // Both sides of a message must agree on the order of the tags.
+    auto tag_less = [] (CommTag const& a, CommTag const& b) -> bool
+    {
+        if (a.face != b.face) return a.face < b.face;
+        if (a.ridx != b.ridx) return a.ridx < b.ridx;
+        if (a.cidx != b.cidx) return a.cidx < b.cidx;
+        return a.shift < b.shift;
+    };
+    for (auto& kv : plan->reg_tags) {
+        std::sort(kv.second.begin(), kv.second.end(), tag_less);
+    }
+    for (auto& kv : plan->crse_tags) {
+        std::sort(kv.second.begin(), kv.second.end(), tag_less);
+    }
+
+    m_comm_plans.push_back(std::move(plan));
+    return *m_comm_plans.back();
 }
 
 FluxRegister::~FluxRegister () {}
@@ -251,6 +372,148 @@ FluxRegister::CrseInit (const MultiFab& mflx,
     CrseInit(mflx,area,dir,srccomp,destcomp,numcomp,mult,op);
 }
 
+void
+FluxRegister::CrseInit (const Array<MultiFab const*,AMREX_SPACEDIM>& mflx,
+                        const Array<MultiFab const*,AMREX_SPACEDIM>& area,
+                        int             srccomp,
+                        int             destcomp,
+                        int             numcomp,
+                        Real            mult,
+                        FrOp            op)
+{
+    CrseInit_doit(mflx, area, srccomp, destcomp, numcomp, mult, op);
+}
+
+void
+FluxRegister::CrseInit (const Array<MultiFab const*,AMREX_SPACEDIM>& mflx,
+                        int             srccomp,
+                        int             destcomp,
+                        int             numcomp,
+                        Real            mult,
+                        FrOp            op)
+{
+    CrseInit_doit(mflx, {AMREX_D_DECL(nullptr,nullptr,nullptr)},
+                  srccomp, destcomp, numcomp, mult, op);
+}
+
+void
+FluxRegister::CrseInit_doit (const Array<MultiFab const*,AMREX_SPACEDIM>& mflx,
+                             const Array<MultiFab const*,AMREX_SPACEDIM>& area,
+                             int srccomp, int destcomp, int numcomp, Real mult, FrOp op)
+{
+    BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= mflx[0]->nComp());
+    BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= ncomp);
+
+    if (Gpu::inLaunchRegion())
+    {
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            if (area[dir]) {
+                CrseInit(*mflx[dir], *area[dir], dir, srccomp, destcomp, numcomp, mult, op);
+            } else {
+                CrseInit(*mflx[dir], dir, srccomp, destcomp, numcomp, mult, op);
+            }
+        }
+        return;
+    }
+
+    BL_PROFILE("FluxRegister::CrseInit()");
+
+    const CommPlan& plan = getCommPlan(amrex::convert(mflx[0]->boxArray(),
+                                                      IntVect::TheCellVector()),
+                                       mflx[0]->DistributionMap(),
+                                       Periodicity::NonPeriodic());
+
+    // Scaled coarse flux, as in the single direction version.
+    auto crse_value = [&] (CommTag const& tag) -> std::pair<Array4<Real const>,Array4<Real const> >
+    {
+        const int dir = tag.face.coordDir();
+        Array4<Real const> f = shifted((*mflx[dir])[tag.cidx].const_array(srccomp), -tag.shift);
+        Array4<Real const> a;
+        if (area[dir]) a = shifted((*area[dir])[tag.cidx].const_array(), -tag.shift);
+        return std::make_pair(f,a);
+    };
+
+    // With ADD, the coarse data are first copied into a zeroed FabSet, so
+    // that register cells covered by more than one coarse box are added once.
+    Vector<std::unique_ptr<FabSet> > tmp(2*AMREX_SPACEDIM);
+    if (op == FluxRegister::ADD) {
+        for (OrientationIter fi; fi; ++fi) {
+            const Orientation face = fi();
+            tmp[face].reset(new FabSet(bndry[face].boxArray(), bndry[face].DistributionMap(),
+                                       numcomp));
+            tmp[face]->setVal(0);
+        }
+    }
+    const int dcomp = (op == FluxRegister::COPY) ? destcomp : 0;
+    auto dst_array = [&] (CommTag const& tag) -> Array4<Real>
+    {
+        FabSet& fs = (op == FluxRegister::COPY) ? bndry[tag.face] : *tmp[tag.face];
+        return fs[tag.ridx].array();
+    };
+
+    std::map<int,Vector<Real> > snd, rcv;
+    for (auto const& kv : plan.crse_tags)
+    {
+        Long n = 0;
+        for (auto const& tag : kv.second) n += tag.rbox.numPts()*numcomp;
+        Vector<Real>& buf = snd[kv.first];
+        buf.resize(n);
+        Real* p = buf.data();
+        for (auto const& tag : kv.second)
+        {
+            auto fa = crse_value(tag);
+            Array4<Real const> const& f = fa.first;
+            Array4<Real const> const& a = fa.second;
+            amrex::LoopOnCpu(tag.rbox, numcomp, [&] (int i, int j, int k, int n) noexcept
+            {
+                *p++ = (a) ? f(i,j,k,n)*mult*a(i,j,k) : f(i,j,k,n)*mult;
+            });
+        }
+    }
+    for (auto const& kv : plan.reg_tags)
+    {
+        Long n = 0;
+        for (auto const& tag : kv.second) n += tag.rbox.numPts()*numcomp;
+        rcv[kv.first].resize(n);
+    }
+
+    exchange(snd, rcv);
+
+    for (auto const& tag : plan.local_tags)
+    {
+        auto fa = crse_value(tag);
+        Array4<Real const> const& f = fa.first;
+        Array4<Real const> const& a = fa.second;
+        Array4<Real> const& d = dst_array(tag);
+        amrex::LoopConcurrentOnCpu(tag.rbox, numcomp, [&] (int i, int j, int k, int n) noexcept
+        {
+            d(i,j,k,n+dcomp) = (a) ? f(i,j,k,n)*mult*a(i,j,k) : f(i,j,k,n)*mult;
+        });
+    }
+
+    for (auto const& kv : plan.reg_tags)
+    {
+        Real const* p = rcv[kv.first].data();
+        for (auto const& tag : kv.second)
+        {
+            Array4<Real> const& d = dst_array(tag);
+            amrex::LoopOnCpu(tag.rbox, numcomp, [&] (int i, int j, int k, int n) noexcept
+            {
+                d(i,j,k,n+dcomp) = *p++;
+            });
+        }
+    }
+
+    if (op == FluxRegister::ADD)
+    {
+        for (OrientationIter fi; fi; ++fi)
+        {
+            const Orientation face = fi();
+            bndry[face].plusFrom(*tmp[face], 0, destcomp, numcomp);
+        }
+    }
+}
+
 void
 FluxRegister::CrseAdd (const MultiFab& mflx,
                        const MultiFab& area,
@@ -349,6 +612,46 @@ FluxRegister::FineAdd (const MultiFab& mflx,
     }
 }
 
+void
+FluxRegister::FineAdd (const Array<MultiFab const*,AMREX_SPACEDIM>& mflx,
+                       int             srccomp,
+                       int             destcomp,
+                       int             numcomp,
+                       Real            mult)
+{
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*mflx[0]); mfi.isValid(); ++mfi)
+    {
+        const int k = mfi.index();
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            FineAdd((*mflx[dir])[k],dir,k,srccomp,destcomp,numcomp,mult,RunOn::Gpu);
+        }
+    }
+}
+
+void
+FluxRegister::FineAdd (const Array<MultiFab const*,AMREX_SPACEDIM>& mflx,
+                       const Array<MultiFab const*,AMREX_SPACEDIM>& area,
+                       int             srccomp,
+                       int             destcomp,
+                       int             numcomp,
+                       Real            mult)
+{
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*mflx[0]); mfi.isValid(); ++mfi)
+    {
+        const int k = mfi.index();
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            FineAdd((*mflx[dir])[k],(*area[dir])[k],dir,k,srccomp,destcomp,numcomp,mult,
+                    RunOn::Gpu);
+        }
+    }
+}
+
 void
 FluxRegister::FineAdd (const FArrayBox& flux,
                        int              dir,
@@ -481,10 +784,102 @@ FluxRegister::Reflux (MultiFab&       mf,
 		      int             nc,
 		      const Geometry& geom)
 {
-    for (OrientationIter fi; fi; ++fi)
+    if (Gpu::inLaunchRegion())
     {
-	const Orientation& face = fi();
-        Reflux(mf, volume, face, scale, scomp, dcomp, nc, geom);
+        for (OrientationIter fi; fi; ++fi)
+        {
+            const Orientation& face = fi();
+            Reflux(mf, volume, face, scale, scomp, dcomp, nc, geom);
+        }
+        return;
+    }
+
+    BL_PROFILE("FluxRegister::Reflux()");
+
+    const CommPlan& plan = getCommPlan(mf.boxArray(), mf.DistributionMap(), geom.periodicity());
+
+    std::map<int,Vector<Real> > snd, rcv;
+    for (auto const& kv : plan.reg_tags)
+    {
+        Long n = 0;
+        for (auto const& tag : kv.second) n += tag.rbox.numPts()*nc;
+        Vector<Real>& buf = snd[kv.first];
+        buf.resize(n);
+        Real* p = buf.data();
+        for (auto const& tag : kv.second)
+        {
+            Array4<Real const> const& r = bndry[tag.face][tag.ridx].const_array(scomp);
+            amrex::LoopOnCpu(tag.rbox, nc, [&] (int i, int j, int k, int n) noexcept
+            {
+                *p++ = r(i,j,k,n);
+            });
+        }
+    }
+    for (auto const& kv : plan.crse_tags)
+    {
+        Long n = 0;
+        for (auto const& tag : kv.second) n += tag.rbox.numPts()*nc;
+        rcv[kv.first].resize(n);
+    }
+
+    exchange(snd, rcv);
+
+    // Register data to be applied to each local coarse box, indexed in the
+    // coarse index space.
+    struct RefluxItem
+    {
+        Orientation        face;
+        Box                fbox;
+        Array4<Real const> flux;
+    };
+    Vector<Vector<RefluxItem> > items(mf.local_size());
+
+    for (auto const& tag : plan.local_tags)
+    {
+        Array4<Real const> const& r = bndry[tag.face][tag.ridx].const_array(scomp);
+        items[mf.localindex(tag.cidx)].push_back(RefluxItem{tag.face, tag.rbox+tag.shift,
+                                                            shifted(r, tag.shift)});
+    }
+
+    for (auto const& kv : plan.crse_tags)
+    {
+        Real const* p = rcv[kv.first].data();
+        for (auto const& tag : kv.second)
+        {
+            const Box& rbox = tag.rbox;
+            const Dim3 hi = amrex::ubound(rbox);
+            Array4<Real const> r(p, amrex::lbound(rbox), Dim3{hi.x+1,hi.y+1,hi.z+1}, nc);
+            items[mf.localindex(tag.cidx)].push_back(RefluxItem{tag.face, rbox+tag.shift,
+                                                                shifted(r, tag.shift)});
+            p += rbox.numPts()*nc;
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        auto& bitems = items[mfi.LocalIndex()];
+        // Same order of faces as the single face version.
+        std::stable_sort(bitems.begin(), bitems.end(),
+                         [] (RefluxItem const& a, RefluxItem const& b) { return a.face < b.face; });
+
+        const Box& vbx = mfi.validbox();
+        Array4<Real> const& sfab = mf.array(mfi);
+        Array4<Real const> const& vfab = volume.const_array(mfi);
+        for (auto const& item : bitems)
+        {
+            // The coarse cells that take the flux on the faces in item.fbox
+            Box bx(item.fbox.smallEnd(), item.fbox.bigEnd());
+            if (item.face.isLow()) {
+                bx.shift(item.face.coordDir(),-1);
+            }
+            bx &= vbx;
+            if (bx.ok()) {
+                fluxreg_reflux(bx, sfab, dcomp, item.flux, vfab, nc, scale, item.face);
+            }
+        }
     }
 }
 
@@ -749,6 +1144,8 @@ FluxRegister::read (const std::string& name, std::istream& is)
     BndryRegister* br = this;
 
     br->read(name,is);
+
+    m_comm_plans.clear();
 }
 
 }
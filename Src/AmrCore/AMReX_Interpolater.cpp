@@ -47,6 +47,39 @@ Interpolater::BoxCoarsener (const IntVect& ratio)
     return InterpolaterBoxCoarsener(this, ratio);
 }
 
+void
+Interpolater::interpBatch (Vector<FArrayBox const*> const& crse,
+                           int                             crse_comp,
+                           Vector<FArrayBox*> const&       fine,
+                           int                             fine_comp,
+                           int                             ncomp,
+                           Vector<Box> const&              fine_region,
+                           const IntVect&                  ratio,
+                           const Geometry&                 crse_geom,
+                           const Geometry&                 fine_geom,
+                           Vector<Vector<BCRec> > const&   bcr,
+                           RunOn                           runon)
+{
+    const int nbox = crse.size();
+    AMREX_ASSERT(fine.size() == nbox && fine_region.size() == nbox && bcr.size() == nbox);
+
+    // Node centered fine regions of different boxes may overlap.
+    bool cc = true;
+    for (int ib = 0; ib < nbox; ++ib) {
+        cc = cc && fine_region[ib].cellCentered();
+    }
+    ignore_unused(cc);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if (cc && Gpu::notInLaunchRegion())
+#endif
+    for (int ib = 0; ib < nbox; ++ib)
+    {
+        interp(*crse[ib], crse_comp, *fine[ib], fine_comp, ncomp, fine_region[ib], ratio,
+               crse_geom, fine_geom, bcr[ib], 0, 0, runon);
+    }
+}
+
 Box
 InterpolaterBoxCoarsener::doit (const Box& fine) const
 {
@@ -360,6 +393,291 @@ CellConservativeLinear::interp (const FArrayBox& crse,
     }
 }
 
+namespace {
+    // Splits the boxes into planes normal to the last direction.  These
+    // are the work items of CellConservativeLinear::interpBatch.
+    void make_planes (Vector<Box> const& bxs, Vector<std::pair<int,Box> >& planes)
+    {
+        planes.clear();
+        for (int ib = 0, N = bxs.size(); ib < N; ++ib)
+        {
+            const Box& bx = bxs[ib];
+            if (bx.isEmpty()) continue;
+#if (AMREX_SPACEDIM == 1)
+            planes.emplace_back(ib, bx);
+#else
+            constexpr int dir = AMREX_SPACEDIM-1;
+            for (int p = bx.smallEnd(dir); p <= bx.bigEnd(dir); ++p) {
+                Box pbx(bx);
+                pbx.setRange(dir, p);
+                planes.emplace_back(ib, pbx);
+            }
+#endif
+        }
+    }
+
+    // Interpolates the fine cells of the coarse row (iclo:ichi,jc,kc) with
+    // the limited linear slopes.  The slopes and their factors, which are
+    // the min over the components, are first computed for the whole coarse
+    // row into buf.  They are then spread over the fine row so that every
+    // fine row is written by one contiguous loop over i.
+    void cellconslin_interp_row (int iclo, int ichi, int jc, int kc, Box const& fine_region,
+                                 Array4<Real> const& fine, int fcomp, int ncomp,
+                                 Array4<Real const> const& crse, int ccomp,
+                                 Dim3 const& slo, Dim3 const& shi,
+                                 BCRec const* bcr, IntVect const& ratio, Vector<Real>& buf)
+    {
+        const auto flo = amrex::lbound(fine_region);
+        const auto fhi = amrex::ubound(fine_region);
+        const int nx = ichi-iclo+1;
+        const int nfx = fhi.x-flo.x+1;
+#if (AMREX_SPACEDIM > 1)
+        const int jlo = amrex::max(jc*ratio[1], flo.y);
+        const int jhi = amrex::min(jc*ratio[1]+ratio[1]-1, fhi.y);
+#else
+        const int jlo = 0, jhi = 0;
+#endif
+#if (AMREX_SPACEDIM == 3)
+        const int klo = amrex::max(kc*ratio[2], flo.z);
+        const int khi = amrex::min(kc*ratio[2]+ratio[2]-1, fhi.z);
+#else
+        const int klo = 0, khi = 0;
+#endif
+
+        // buf : factors for x, y and z-direction, then the slopes of every
+        //       component for x, y and z-direction, then the fine row
+        buf.resize((ncomp+1)*AMREX_SPACEDIM*nx + AMREX_SPACEDIM*nfx);
+        Real* AMREX_RESTRICT sf = buf.data();
+        Real* AMREX_RESTRICT slp = sf + AMREX_SPACEDIM*nx;
+        Real* AMREX_RESTRICT frow = slp + ncomp*AMREX_SPACEDIM*nx;
+
+        for (int m = 0; m < AMREX_SPACEDIM*nx; ++m) {
+            sf[m] = 1.0_rt;
+        }
+
+        for (int n = 0; n < ncomp; ++n) {
+            const int nu = n + ccomp;
+            Real* AMREX_RESTRICT s = slp + n*AMREX_SPACEDIM*nx;
+            for (int ic = iclo; ic <= ichi; ++ic) {
+                const int m = ic-iclo;
+                Real cen;
+                s[m] = cellconslin_limited_slope([&] (int ii) { return crse(ii,jc,kc,nu); },
+                                                 ic, slo.x, shi.x, bcr[n].lo(0), bcr[n].hi(0), cen);
+                sf[m] = (cen != 0.0_rt) ? amrex::min(sf[m], s[m]/cen) : 0.0_rt;
+#if (AMREX_SPACEDIM > 1)
+                s[m+nx] = cellconslin_limited_slope([&] (int jj) { return crse(ic,jj,kc,nu); },
+                                                    jc, slo.y, shi.y, bcr[n].lo(1), bcr[n].hi(1), cen);
+                sf[m+nx] = (cen != 0.0_rt) ? amrex::min(sf[m+nx], s[m+nx]/cen) : 0.0_rt;
+#endif
+#if (AMREX_SPACEDIM == 3)
+                s[m+2*nx] = cellconslin_limited_slope([&] (int kk) { return crse(ic,jc,kk,nu); },
+                                                      kc, slo.z, shi.z, bcr[n].lo(2), bcr[n].hi(2), cen);
+                sf[m+2*nx] = (cen != 0.0_rt) ? amrex::min(sf[m+2*nx], s[m+2*nx]/cen) : 0.0_rt;
+#endif
+            }
+        }
+
+        for (int n = 0; n < ncomp; ++n) {
+            const int nu = n + ccomp;
+            Real const* AMREX_RESTRICT s = slp + n*AMREX_SPACEDIM*nx;
+            // frow : c + xoff*slpx, then slpy and slpz of every fine cell in the row
+            for (int ic = iclo; ic <= ichi; ++ic) {
+                const int m = ic-iclo;
+                const Real c = crse(ic,jc,kc,nu);
+                AMREX_D_TERM(const Real slpx = sf[m]*s[m];,
+                             const Real slpy = sf[m+nx]*s[m+nx];,
+                             const Real slpz = sf[m+2*nx]*s[m+2*nx];)
+                const int ilo = amrex::max(ic*ratio[0], flo.x);
+                const int ihi = amrex::min(ic*ratio[0]+ratio[0]-1, fhi.x);
+                for (int i = ilo; i <= ihi; ++i) {
+                    const Real xoff = (i - ic*ratio[0] + 0.5_rt)/ratio[0] - 0.5_rt;
+                    AMREX_D_TERM(frow[i-flo.x] = c + xoff * slpx;,
+                                 frow[i-flo.x+nfx] = slpy;,
+                                 frow[i-flo.x+2*nfx] = slpz;)
+                }
+            }
+
+            for (int k = klo; k <= khi; ++k) {
+#if (AMREX_SPACEDIM == 3)
+                const Real zoff = (k - kc*ratio[2] + 0.5_rt)/ratio[2] - 0.5_rt;
+#endif
+                for (int j = jlo; j <= jhi; ++j) {
+#if (AMREX_SPACEDIM > 1)
+                    const Real yoff = (j - jc*ratio[1] + 0.5_rt)/ratio[1] - 0.5_rt;
+#endif
+                    AMREX_PRAGMA_SIMD
+                    for (int i = flo.x; i <= fhi.x; ++i) {
+                        const int m = i-flo.x;
+                        fine(i,j,k,n+fcomp) = AMREX_D_TERM(frow[m],
+                                                           + yoff * frow[m+nfx],
+                                                           + zoff * frow[m+2*nfx]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+CellConservativeLinear::interpBatch (Vector<FArrayBox const*> const& crse,
+                                     int                             crse_comp,
+                                     Vector<FArrayBox*> const&       fine,
+                                     int                             fine_comp,
+                                     int                             ncomp,
+                                     Vector<Box> const&              fine_region,
+                                     const IntVect&                  ratio,
+                                     const Geometry&                 crse_geom,
+                                     const Geometry&                 fine_geom,
+                                     Vector<Vector<BCRec> > const&   bcr,
+                                     RunOn                           runon)
+{
+    if (runon == RunOn::Gpu && Gpu::inLaunchRegion()) {
+        Interpolater::interpBatch(crse, crse_comp, fine, fine_comp, ncomp, fine_region, ratio,
+                                  crse_geom, fine_geom, bcr, runon);
+        return;
+    }
+
+    BL_PROFILE("CellConservativeLinear::interpBatch()");
+
+    const int nbox = crse.size();
+    AMREX_ASSERT(fine.size() == nbox && fine_region.size() == nbox && bcr.size() == nbox);
+
+    if (do_linear_limiting && crse_geom.IsCartesian())
+    {
+        // No slope fabs are needed.  The work items are planes of the
+        // coarse cells of the fine regions, which are done row by row.
+        Vector<Box> cbx(nbox);
+        for (int ib = 0; ib < nbox; ++ib) {
+            AMREX_ASSERT(fine[ib]->box().contains(fine_region[ib]));
+            cbx[ib] = amrex::coarsen(fine_region[ib],ratio);
+        }
+
+        Vector<std::pair<int,Box> > cplanes;
+        make_planes(cbx, cplanes);
+        const int ncp = cplanes.size();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Vector<Real> buf;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int ip = 0; ip < ncp; ++ip)
+            {
+                const int ib = cplanes[ip].first;
+                const Box& fbx = fine_region[ib];
+                Array4<Real> const& finearr = fine[ib]->array();
+                Array4<Real const> const& crsearr = crse[ib]->const_array();
+                BCRec const* bcrp = bcr[ib].data();
+                const Dim3 slo = amrex::lbound(cbx[ib]);
+                const Dim3 shi = amrex::ubound(cbx[ib]);
+                const Dim3 plo = amrex::lbound(cplanes[ip].second);
+                const Dim3 phi = amrex::ubound(cplanes[ip].second);
+                for (int k = plo.z; k <= phi.z; ++k) {
+                for (int j = plo.y; j <= phi.y; ++j) {
+                    cellconslin_interp_row(plo.x, phi.x, j, k, fbx, finearr, fine_comp, ncomp,
+                                           crsearr, crse_comp, slo, shi, bcrp, ratio, buf);
+                }}
+            }
+        }
+        return;
+    }
+
+    // See CellConservativeLinear::interp for the layout of ccfab.
+    const int ntmp = do_linear_limiting ? (ncomp+1)*AMREX_SPACEDIM : ncomp*(AMREX_SPACEDIM+2);
+
+    Vector<Box> cslope_bx(nbox);
+    Vector<Box> fslope_bx(do_linear_limiting ? 0 : nbox);
+    Vector<FArrayBox> ccfab(nbox);
+    Vector<FArrayBox> fafab(do_linear_limiting ? 0 : nbox);
+    Vector<Vector<Real> > voff(nbox);
+    for (int ib = 0; ib < nbox; ++ib)
+    {
+        AMREX_ASSERT(fine[ib]->box().contains(fine_region[ib]));
+        cslope_bx[ib] = amrex::grow(CoarseBox(fine_region[ib],ratio),-1);
+        ccfab[ib].resize(cslope_bx[ib], ntmp);
+        voff[ib] = amrex::ccinterp_compute_voff(cslope_bx[ib], ratio, crse_geom, fine_geom);
+        if (!do_linear_limiting) {
+            fslope_bx[ib] = amrex::refine(cslope_bx[ib],ratio);
+            fafab[ib].resize(fslope_bx[ib], ncomp);
+        }
+    }
+
+    Vector<std::pair<int,Box> > cplanes, fsplanes, fplanes;
+    make_planes(cslope_bx, cplanes);
+    make_planes(fslope_bx, fsplanes);
+    make_planes(fine_region, fplanes);
+    const int ncp = cplanes.size();
+    const int nfsp = fsplanes.size();
+    const int nfp = fplanes.size();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        if (do_linear_limiting)
+        {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int ip = 0; ip < ncp; ++ip)
+            {
+                const int ib = cplanes[ip].first;
+                amrex::cellconslin_slopes_linlim(cplanes[ip].second, ccfab[ib].array(),
+                                                 crse[ib]->const_array(), crse_comp, ncomp,
+                                                 bcr[ib].data());
+            }
+        }
+        else
+        {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int ip = 0; ip < ncp; ++ip)
+            {
+                const int ib = cplanes[ip].first;
+                amrex::cellconslin_slopes_mclim(cplanes[ip].second, ccfab[ib].array(),
+                                                crse[ib]->const_array(), crse_comp, ncomp,
+                                                bcr[ib].data());
+            }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int ip = 0; ip < nfsp; ++ip)
+            {
+                const int ib = fsplanes[ip].first;
+                amrex::cellconslin_fine_alpha(fsplanes[ip].second, fafab[ib].array(),
+                                              ccfab[ib].const_array(), ncomp,
+                                              voff[ib].data(), ratio);
+            }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int ip = 0; ip < ncp; ++ip)
+            {
+                const int ib = cplanes[ip].first;
+                amrex::cellconslin_slopes_mmlim(cplanes[ip].second, ccfab[ib].array(),
+                                                fafab[ib].const_array(), ncomp, ratio);
+            }
+        }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (int ip = 0; ip < nfp; ++ip)
+        {
+            const int ib = fplanes[ip].first;
+            amrex::cellconslin_interp(fplanes[ip].second, fine[ib]->array(), fine_comp, ncomp,
+                                      ccfab[ib].const_array(), crse[ib]->const_array(),
+                                      crse_comp, voff[ib].data(), ratio);
+        }
+    }
+}
+
 #ifndef BL_NO_FORT
 CellQuadratic::CellQuadratic (bool limit)
 {
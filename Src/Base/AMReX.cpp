@@ -30,6 +30,10 @@
 #include <AMReX_iMultiFab.H>
 #include <AMReX_VisMF.H>
 #include <AMReX_AsyncOut.H>
+#include <AMReX_Telemetry.H>
+#include <AMReX_MemSites.H>
+#include <AMReX_MFTuner.H>
+#include <AMReX_MFCostSched.H>
 #endif
 
 #ifdef BL_LAZY
@@ -456,6 +460,7 @@ amrex::Initialize (int& argc, char**& argv, bool build_parm_parse,
 
     Arena::Initialize();
     amrex_mempool_init();
+    MemSites::Initialize();
 
     //
     // Initialize random seed after we're running in parallel.
@@ -469,10 +474,13 @@ amrex::Initialize (int& argc, char**& argv, bool build_parm_parse,
     FArrayBox::Initialize();
     IArrayBox::Initialize();
     FabArrayBase::Initialize();
+    MFTuner::Initialize();
+    MFCostSched::Initialize();
     MultiFab::Initialize();
     iMultiFab::Initialize();
     VisMF::Initialize();
     AsyncOut::Initialize();
+    Telemetry::Initialize();
 #ifdef AMREX_USE_EB
     EB2::Initialize();
 #endif
@@ -4,6 +4,7 @@
 #include <AMReX_CArena.H>
 #include <AMReX_DArena.H>
 #include <AMReX_EArena.H>
+#include <AMReX_MemSites.H>
 
 #include <AMReX.H>
 #include <AMReX_Print.H>
@@ -111,7 +112,10 @@ Arena::allocate_system (std::size_t nbytes)
     p = std::malloc(nbytes);
     if (p && arena_info.device_use_hostalloc) AMREX_MLOCK(p, nbytes);
 #endif
-    if (p == nullptr) amrex::Abort("Sorry, malloc failed");
+    if (p == nullptr) {
+        if (MemSites::Enabled()) MemSites::ReportLocal(amrex::ErrorStream());
+        amrex::Abort("Sorry, malloc failed");
+    }
     return p;
 }
 
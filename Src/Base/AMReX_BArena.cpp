@@ -1,13 +1,17 @@
 #include <AMReX_BArena.H>
+#include <AMReX_MemSites.H>
 
 void*
 amrex::BArena::alloc (std::size_t sz_)
 {
-    return std::malloc(sz_);
+    void* p = std::malloc(sz_);
+    if (MemSites::Enabled()) MemSites::Alloc(this, p, sz_);
+    return p;
 }
 
 void
 amrex::BArena::free (void* pt)
 {
+    if (MemSites::Enabled()) MemSites::Free(pt);
     std::free(pt);
 }
@@ -11,6 +11,8 @@
 #include <AMReX_NFiles.H>
 #include <AMReX_Print.H>
 #include <AMReX_ParmParse.H>
+#include <AMReX_ParallelReduce.H>
+#include <AMReX_FileSystem.H>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -22,6 +24,8 @@
 #include <limits>
 #include <cstdlib>
 #include <cmath>
+#include <cstdio>
+#include <deque>
 
 namespace amrex {
 
@@ -34,6 +38,7 @@ bool BLProfiler::groupSets = false;
 bool BLProfiler::bFirstCommWrite = true;  // header
 bool BLProfiler::bInitialized = false;
 bool BLProfiler::bFlushPrint = true;
+bool BLProfiler::bChromeTrace = false;
 
 const int defaultFlushSize = 8192000;
 const int defaultReserveSize = 8192000;
@@ -71,6 +76,146 @@ Vector<BLProfiler *> BLProfiler::mFortProfsInt;
 Vector<std::string> BLProfiler::mFortProfsIntNames;
 const int mFortProfsIntMaxFuncs(32);
 std::map<std::string, BLProfiler::CommFuncType> BLProfiler::CommStats::cftNames;
+
+namespace {
+// ---- the Chrome Trace Event JSON of this process.  The events are
+// ---- appended to a per-process file and merged by WriteChromeTrace.
+namespace ChromeTrace {
+  const int mainTid(0), regionTid(1), mpiTid(2);
+  const std::size_t flushSize(8 * 1024 * 1024);
+  std::string buffer;
+  std::string fileName;
+  Real t0(0.0);
+  int myProc(0);
+
+  struct Pending {
+    Real t = -1.0;
+    int peer = -1, tag = -1, size = 0;
+    std::string name;
+  };
+  std::map<int, Pending> pending;                              // [cft, call]
+  std::map<std::pair<int,int>, Long> sendSeq;                  // [(dst,tag), nsent]
+  std::map<std::pair<int,int>, Long> recvSeq;                  // [(src,tag), nposted]
+  std::map<std::pair<int,int>, std::deque<Long> > recvPosted;  // [(src,tag), seqs]
+
+  void Flush() {
+    if( ! buffer.empty()) {
+      std::ofstream ofs(fileName, std::ios::app | std::ios::binary);
+      ofs.write(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  }
+
+  void Append(const char *s) {
+    buffer += s;
+    if(buffer.size() > flushSize) {
+      Flush();
+    }
+  }
+
+  void Name(const std::string &name) {
+    buffer += '"';
+    for(char c : name) {
+      if(c == '"' || c == '\\') {
+        buffer += '\\';
+      }
+      if(static_cast<unsigned char>(c) >= 0x20) {
+        buffer += c;
+      }
+    }
+    buffer += '"';
+  }
+
+  double Micro(Real t) { return (t - t0) * 1.0e6; }
+
+  void Slice(const std::string &name, int tid, Real tstart, Real dt,
+             const char *args = "")
+  {
+    char s[256];
+    buffer += "{\"name\":";
+    Name(name);
+    std::snprintf(s, sizeof(s), ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f%s},\n",
+                  myProc, tid, Micro(tstart), dt * 1.0e6, args);
+    Append(s);
+  }
+
+  void Phase(char ph, const std::string &name, int tid, Real t) {
+    char s[128];
+    buffer += "{\"name\":";
+    Name(name);
+    std::snprintf(s, sizeof(s), ",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f},\n",
+                  ph, myProc, tid, Micro(t));
+    Append(s);
+  }
+
+  // ---- a message flow arrow from (src, seq) to (dst, seq)
+  void Flow(char ph, int src, int dst, int tag, Long seq, double ts) {
+    char s[256];
+    std::snprintf(s, sizeof(s), "{\"name\":\"msg\",\"cat\":\"mpi\",\"ph\":\"%c\","
+                  "\"id\":\"%d.%d.%d.%lld\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f%s},\n",
+                  ph, src, dst, tag, static_cast<long long>(seq), myProc, mpiTid, ts,
+                  (ph == 'f') ? ",\"bp\":\"e\"" : "");
+    Append(s);
+  }
+
+  void Metadata(const char *what, int tid, const std::string &value) {
+    char s[128];
+    std::snprintf(s, sizeof(s), "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                  what, myProc, tid);
+    buffer += s;
+    Name(value);
+    buffer += "}},\n";
+  }
+
+  bool IsSend(BLProfiler::CommFuncType cft) {
+    return cft == BLProfiler::AsendTsii || cft == BLProfiler::AsendTsiiM ||
+           cft == BLProfiler::AsendvTii || cft == BLProfiler::SendTsii ||
+           cft == BLProfiler::SendvTii;
+  }
+
+  bool IsRecv(BLProfiler::CommFuncType cft) {
+    return cft == BLProfiler::ArecvTsii || cft == BLProfiler::ArecvTsiiM ||
+           cft == BLProfiler::ArecvTii  || cft == BLProfiler::ArecvvTii ||
+           cft == BLProfiler::RecvTsii  || cft == BLProfiler::RecvvTii;
+  }
+
+  bool IsBlockingRecv(BLProfiler::CommFuncType cft) {
+    return cft == BLProfiler::RecvTsii || cft == BLProfiler::RecvvTii;
+  }
+
+  // ---- a call before it starts
+  void Begin(BLProfiler::CommFuncType cft, int peer, int tag, int size,
+             const std::string &name)
+  {
+    Pending &p = pending[cft];
+    p.t = amrex::second();
+    p.peer = peer;
+    p.tag = tag;
+    p.size = size;
+    p.name = name;
+  }
+
+  // ---- a received message, matched to its receive in posting order
+  void Received(int src, int tag, double ts) {
+    auto it = recvPosted.find(std::make_pair(src, tag));
+    if(it != recvPosted.end() && ! it->second.empty()) {
+      Flow('f', src, myProc, tag, it->second.front(), ts);
+      it->second.pop_front();
+    }
+  }
+
+  // ---- the call has returned, write it as a slice
+  Pending *End(BLProfiler::CommFuncType cft, Real t, const char *args = "") {
+    auto it = pending.find(cft);
+    if(it == pending.end() || it->second.t < 0.0) {
+      return nullptr;
+    }
+    Slice(it->second.name, mpiTid, it->second.t, t - it->second.t, args);
+    return &(it->second);
+  }
+}
+}
+
 std::set<BLProfiler::CommFuncType> BLProfiler::CommStats::cftExclude;
 int BLProfiler::CommStats::barrierNumber(0);
 int BLProfiler::CommStats::reductionNumber(0);
@@ -278,6 +423,32 @@ void BLProfiler::InitParams() {
   pParse.query("prof_flushinterval", flushInterval);
   pParse.query("prof_flushtimeinterval", flushTimeInterval);
   pParse.query("prof_flushprint", bFlushPrint);
+  pParse.query("chrome_trace", bChromeTrace);
+
+  if(bChromeTrace) {
+    if( ! blProfDirCreated) {
+      amrex::UtilCreateCleanDirectory(blProfDirName);
+      blProfDirCreated = true;
+    }
+    const std::string tdir(blProfDirName + "/chrome_trace");
+    amrex::UtilCreateCleanDirectory(tdir);
+    ChromeTrace::myProc = ParallelDescriptor::MyProc();
+    ChromeTrace::fileName = amrex::Concatenate(tdir + "/trace_", ChromeTrace::myProc, 5) + ".json";
+    // ---- the time lines of the processes start together
+    ParallelDescriptor::Barrier("BLProfiler::ChromeTrace");
+    ChromeTrace::t0 = amrex::second();
+    ChromeTrace::buffer.clear();
+    ChromeTrace::Metadata("process_name", 0, "rank " + std::to_string(ChromeTrace::myProc)
+                                             + " (" + procName + ")");
+    char s[128];
+    std::snprintf(s, sizeof(s), "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,"
+                  "\"args\":{\"sort_index\":%d}},\n", ChromeTrace::myProc, ChromeTrace::myProc);
+    ChromeTrace::buffer += s;
+    // ---- the timers only run on the OpenMP master thread
+    ChromeTrace::Metadata("thread_name", ChromeTrace::mainTid, "timers (master thread)");
+    ChromeTrace::Metadata("thread_name", ChromeTrace::regionTid, "regions");
+    ChromeTrace::Metadata("thread_name", ChromeTrace::mpiTid, "MPI");
+  }
 #if 0
   amrex::Print() << "PPPPPPPP::  nProfFiles         = " << nProfFiles << '\n';
   amrex::Print() << "PPPPPPPP::  csFlushSize        = " << csFlushSize << '\n';
@@ -367,6 +538,10 @@ void BLProfiler::stop() {
   }
   mProfStats[fname].totalTime += thisFuncTime;
 
+  if(bChromeTrace) {
+    ChromeTrace::Slice(fname, ChromeTrace::mainTid, bltstart, tDiff);
+  }
+
 #ifdef BL_TRACE_PROFILING
   prevCallStackDepth = callStackDepth;
   --callStackDepth;
@@ -442,6 +617,10 @@ void BLProfiler::RegionStart(const std::string &rname) {
     rnameNumber = it->second;
   }
   rStartStop.push_back(RStartStop(rsTime, rnameNumber, true));
+
+  if(bChromeTrace && rname != noRegionName) {
+    ChromeTrace::Phase('B', rname, ChromeTrace::regionTid, rsTime + startTime);
+  }
 }
 
 
@@ -460,6 +639,10 @@ void BLProfiler::RegionStop(const std::string &rname) {
   }
   rStartStop.push_back(RStartStop(rsTime, rnameNumber, false));
 
+  if(bChromeTrace && rname != noRegionName) {
+    ChromeTrace::Phase('E', rname, ChromeTrace::regionTid, rsTime + startTime);
+  }
+
   if(rname != noRegionName) {
     --inNRegions;
   }
@@ -494,6 +677,13 @@ void BLProfiler::Finalize(bool bFlushing, bool memCheck) {
 #endif
 
   WriteFortProfErrors();
+
+  if(bFlushing) {
+    ChromeTrace::Flush();
+  } else {
+    WriteChromeTrace();
+  }
+
 #ifdef AMREX_DEBUG
 #else
   if (!bFlushing)
@@ -1336,6 +1526,88 @@ void BLProfiler::WriteCommStats(bool bFlushing, bool memCheck) {
 }
 
 
+void BLProfiler::WriteChromeTrace() {
+  if( ! bChromeTrace) {
+    return;
+  }
+  Real wctStart(amrex::second());
+  ChromeTrace::Flush();
+
+  // ---- every process copies its events to its offset in one file,
+  // ---- nProfFiles processes at a time
+  const int nProcs(ParallelDescriptor::NProcs());
+  const std::string header("[\n");
+  const std::string traceName(blProfDirName + "/chrome_trace.json");
+
+  Long mySize(0);
+  {
+    std::ifstream ifs(ChromeTrace::fileName, std::ios::binary | std::ios::ate);
+    if(ifs.good()) {
+      mySize = ifs.tellg();
+    }
+  }
+  Vector<Long> sizes(nProcs);
+  ParallelAllGather::AllGather(mySize, sizes.dataPtr(), ParallelDescriptor::Communicator());
+  Long myOffset(header.size()), totalSize(header.size());
+  for(int i(0); i < nProcs; ++i) {
+    if(i < ChromeTrace::myProc) {
+      myOffset += sizes[i];
+    }
+    totalSize += sizes[i];
+  }
+
+  if(ParallelDescriptor::IOProcessor()) {
+    std::ofstream ofs(traceName, std::ios::trunc | std::ios::binary);
+    if( ! ofs.good()) {
+      amrex::FileOpenFailed(traceName);
+    }
+    ofs << header;
+  }
+  ParallelDescriptor::Barrier("BLProfiler::WriteChromeTrace::header");
+
+  const int nWaves((nProcs + nProfFiles - 1) / nProfFiles);
+  for(int iWave(0); iWave < nWaves; ++iWave) {
+    if(ChromeTrace::myProc % nWaves == iWave && mySize > 0) {
+      std::ifstream ifs(ChromeTrace::fileName, std::ios::binary);
+      std::fstream ofs(traceName, std::ios::in | std::ios::out | std::ios::binary);
+      if( ! ofs.good()) {
+        amrex::FileOpenFailed(traceName);
+      }
+      ofs.seekp(myOffset);
+      Vector<char> chunk(ChromeTrace::flushSize);
+      while(ifs) {
+        ifs.read(chunk.dataPtr(), chunk.size());
+        ofs.write(chunk.dataPtr(), ifs.gcount());
+      }
+    }
+    ParallelDescriptor::Barrier("BLProfiler::WriteChromeTrace::wave");
+  }
+
+  amrex::FileSystem::Remove(ChromeTrace::fileName);
+  ParallelDescriptor::Barrier("BLProfiler::WriteChromeTrace::remove");
+
+  if(ParallelDescriptor::IOProcessor()) {
+    // ---- the events end with commas, so the last one is a repeated name
+    std::fstream ofs(traceName, std::ios::in | std::ios::out | std::ios::binary);
+    ofs.seekp(totalSize);
+    ofs << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":"
+        << "\"rank 0 (" << procName << ")\"}}\n]\n";
+    amrex::FileSystem::RemoveAll(blProfDirName + "/chrome_trace");
+  }
+
+  ChromeTrace::pending.clear();
+  ChromeTrace::sendSeq.clear();
+  ChromeTrace::recvSeq.clear();
+  ChromeTrace::recvPosted.clear();
+  bChromeTrace = false;
+
+  if(bFlushPrint) {
+    amrex::Print() << "BLProfiler::WriteChromeTrace():  time:  "
+                   << amrex::second() - wctStart << "  bytes:  " << totalSize << "\n";
+  }
+}
+
+
 void BLProfiler::WriteFortProfErrors() {
   // report any fortran errors.  should really check with all procs, just iop for now
   if(ParallelDescriptor::IOProcessor()) {
@@ -1398,6 +1670,38 @@ void BLProfiler::AddCommStat(const CommFuncType cft, const int size,
     return;
   }
   vCommStats.push_back(CommStats(cft, size, pid, tag, amrex::second()));
+
+  if(bChromeTrace) {
+    const bool afterCall(size == AfterCall() || pid == AfterCall());
+    if(ChromeTrace::IsSend(cft)) {
+      if( ! afterCall) {
+        ChromeTrace::Begin(cft, pid, tag, size, CommStats::CFTToString(cft));
+      } else {
+        const Real t(amrex::second());
+        const ChromeTrace::Pending &p = ChromeTrace::pending[cft];
+        char args[128];
+        std::snprintf(args, sizeof(args), ",\"args\":{\"to\":%d,\"tag\":%d,\"bytes\":%d}",
+                      p.peer, p.tag, p.size);
+        if(ChromeTrace::End(cft, t, args)) {
+          const Long seq(++ChromeTrace::sendSeq[std::make_pair(p.peer, p.tag)]);
+          ChromeTrace::Flow('s', ChromeTrace::myProc, p.peer, p.tag, seq,
+                            ChromeTrace::Micro(p.t));
+        }
+      }
+    } else if(ChromeTrace::IsRecv(cft)) {
+      if( ! afterCall) {
+        const auto key(std::make_pair(pid, tag));
+        ChromeTrace::recvPosted[key].push_back(++ChromeTrace::recvSeq[key]);
+        ChromeTrace::Begin(cft, pid, tag, size, CommStats::CFTToString(cft));
+      } else if(ChromeTrace::IsBlockingRecv(cft)) {
+        const Real t(amrex::second());
+        const ChromeTrace::Pending *p = ChromeTrace::End(cft, t);
+        if(p) {
+          ChromeTrace::Received(p->peer, p->tag, ChromeTrace::Micro(t) - 0.001);
+        }
+      }
+    }
+  }
 }
 
 
@@ -1412,10 +1716,16 @@ void BLProfiler::AddBarrier(const std::string &message, const bool beforecall) {
                                    amrex::second()));
     CommStats::barrierNames.push_back(std::make_pair(message, vCommStats.size() - 1));
     ++CommStats::barrierNumber;
+    if(bChromeTrace) {
+      ChromeTrace::Begin(cft, -1, tag, 0, message.empty() ? "Barrier" : "Barrier " + message);
+    }
   } else {
     int tag(CommStats::barrierNumber - 1);  // it was incremented before the call
     vCommStats.push_back(CommStats(cft, AfterCall(), AfterCall(), tag,
                                    amrex::second()));
+    if(bChromeTrace) {
+      ChromeTrace::End(cft, amrex::second());
+    }
   }
 }
 
@@ -1451,10 +1761,18 @@ void BLProfiler::AddAllReduce(const CommFuncType cft, const int size,
     vCommStats.push_back(CommStats(cft, size, BeforeCall(), tag,
                                    amrex::second()));
     ++CommStats::reductionNumber;
+    if(bChromeTrace) {
+      ChromeTrace::Begin(cft, -1, tag, size, CommStats::CFTToString(cft));
+    }
   } else {
     int tag(CommStats::reductionNumber - 1);
     vCommStats.push_back(CommStats(cft, size, AfterCall(), tag,
                                    amrex::second()));
+    if(bChromeTrace) {
+      char args[64];
+      std::snprintf(args, sizeof(args), ",\"args\":{\"bytes\":%d}", size);
+      ChromeTrace::End(cft, amrex::second(), args);
+    }
   }
 }
 
@@ -1468,11 +1786,20 @@ void BLProfiler::AddWait(const CommFuncType cft, const MPI_Request &req,
   if(beforecall) {
     vCommStats.push_back(CommStats(cft, BeforeCall(), BeforeCall(), NoTag(),
                          amrex::second()));
+    if(bChromeTrace) {
+      ChromeTrace::Begin(cft, -1, NoTag(), 0, CommStats::CFTToString(cft));
+    }
   } else {
       int c;
       BL_MPI_REQUIRE( MPI_Get_count(const_cast<MPI_Status*>(&status), MPI_UNSIGNED_CHAR, &c) );
       vCommStats.push_back(CommStats(cft, c, status.MPI_SOURCE, status.MPI_TAG,
                            amrex::second()));
+      if(bChromeTrace) {
+        const Real t(amrex::second());
+        if(ChromeTrace::End(cft, t)) {
+          ChromeTrace::Received(status.MPI_SOURCE, status.MPI_TAG, ChromeTrace::Micro(t) - 0.001);
+        }
+      }
   }
 #endif
 }
@@ -1488,6 +1815,9 @@ void BLProfiler::AddWaitsome(const CommFuncType cft, const Vector<MPI_Request> &
   if(beforecall) {
     vCommStats.push_back(CommStats(cft, BeforeCall(), BeforeCall(), NoTag(),
                          amrex::second()));
+    if(bChromeTrace) {
+      ChromeTrace::Begin(cft, -1, NoTag(), 0, CommStats::CFTToString(cft));
+    }
   } else {
     for(int i(0); i < completed; ++i) {
       MPI_Status stat(status[i]);
@@ -1496,6 +1826,16 @@ void BLProfiler::AddWaitsome(const CommFuncType cft, const Vector<MPI_Request> &
       vCommStats.push_back(CommStats(cft, c, stat.MPI_SOURCE, stat.MPI_TAG,
                            amrex::second()));
     }
+    if(bChromeTrace) {
+      const Real t(amrex::second());
+      if(ChromeTrace::End(cft, t)) {
+        // ---- the statuses of send requests do not match posted receives
+        for(int i(0); i < completed; ++i) {
+          ChromeTrace::Received(status[i].MPI_SOURCE, status[i].MPI_TAG,
+                                ChromeTrace::Micro(t) - 0.001);
+        }
+      }
+    }
   }
 #endif
 }
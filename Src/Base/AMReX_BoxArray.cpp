@@ -5,6 +5,7 @@
 #include <AMReX_Utility.H>
 #include <AMReX_MFIter.H>
 #include <AMReX_BaseFab.H>
+#include <AMReX_ParmParse.H>
 
 #ifdef AMREX_MEM_PROFILING
 #include <AMReX_MemProfiler.H>
@@ -14,6 +15,8 @@
 #include <omp.h>
 #endif
 
+#include <algorithm>
+
 namespace amrex {
 
 #ifdef AMREX_MEM_PROFILING
@@ -27,6 +30,9 @@ Long BARef::total_hash_bytes_hwm = 0L;
 
 bool    BARef::initialized = false;
 bool BoxArray::initialized = false;
+bool BoxArray::use_sorted_index = false;
+bool BoxArray::use_compact_io = false;
+bool BoxArray::use_structured_max_size = false;
 
 namespace {
     const int bl_ignore_max = 100000;
@@ -71,11 +77,15 @@ BARef::BARef (BoxList&& bl) noexcept
 BARef::BARef (std::istream& is)
 { 
     int ndims;
-    define(is, ndims); 
+    IndexType typ;
+    define(is, ndims, typ); 
 }
 
 BARef::BARef (const BARef& rhs) 
-    : m_abox(rhs.m_abox) // don't copy hash
+    : m_abox(rhs.m_abox), // don't copy hash
+      is_structured(rhs.is_structured),
+      structured(rhs.structured),
+      has_boxes(rhs.HasBoxes())
 {
 #ifdef AMREX_MEM_PROFILING
     updateMemoryUsage_box(1);
@@ -91,16 +101,18 @@ BARef::~BARef ()
 }
 
 void
-BARef::define (std::istream& is, int& ndims)
+BARef::define (std::istream& is, int& ndims, IndexType& typ)
 {
     //
     // TODO -- completely remove the fiction of a hash value.
+    // A value of 1 marks the compact form of a structured BoxArray.
     //
     BL_ASSERT(m_abox.size() == 0);
     int   maxbox;
     ULong tmphash;
     is.ignore(bl_ignore_max, '(') >> maxbox >> tmphash;
-    resize(maxbox);
+    const bool compact = (tmphash == 1);
+    if (!compact) resize(maxbox);
     auto pos = is.tellg();
     {
         ndims = AMREX_SPACEDIM;
@@ -129,13 +141,180 @@ BARef::define (std::istream& is, int& ndims)
         }
     }
     is.seekg(pos, std::ios_base::beg);
-    for (Vector<Box>::iterator it = m_abox.begin(), End = m_abox.end(); it != End; ++it)
-        is >> *it;
+    if (compact)
+    {
+        Box domain;
+        IntVect chunk;
+        int nholes;
+        is >> domain >> chunk >> nholes;
+        Vector<int> holes(nholes);
+        for (auto& h : holes) {
+            is >> h;
+        }
+        typ = domain.ixType();
+        define(amrex::enclosedCells(domain), chunk, holes, false);
+        if (structured.size() != maxbox) {
+            amrex::Error("BoxArray::define(istream&) inconsistent structured BoxArray");
+        }
+    }
+    else
+    {
+        for (Vector<Box>::iterator it = m_abox.begin(), End = m_abox.end(); it != End; ++it)
+            is >> *it;
+        typ = m_abox.empty() ? IndexType() : m_abox[0].ixType();
+    }
     is.ignore(bl_ignore_max, ')');
     if (is.fail())
         amrex::Error("BoxArray::define(istream&) failed");
 }
 
+void
+BARef::define (const Box& domain, const IntVect& chunk, const Vector<int>& holes,
+               bool boxes_built)
+{
+    BL_ASSERT(domain.ixType().cellCentered());
+
+    Structured& st = structured;
+    st.domain = domain;
+    st.chunk = chunk;
+    st.holes = holes;
+    std::sort(st.holes.begin(), st.holes.end());
+    st.holes.erase(std::unique(st.holes.begin(), st.holes.end()), st.holes.end());
+
+    // The blocks of BoxList::maxSize in each direction: numblk-1 chops from
+    // the high end, of sizes (k < extra ? sz+1 : sz)*ratio, and the rest.
+    st.npos = 1;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        auto& blo = st.blo[idim];
+        blo.clear();
+        const int len = domain.length(idim);
+        if (len > chunk[idim])
+        {
+            int ratio = 1;
+            int bs    = chunk[idim];
+            int nlen  = len;
+            while ((bs%2 == 0) && (nlen%2 == 0))
+            {
+                ratio *= 2;
+                bs    /= 2;
+                nlen  /= 2;
+            }
+            const int numblk = nlen/bs + (nlen%bs ? 1 : 0);
+            const int sz     = nlen/numblk;
+            const int extra  = nlen%numblk;
+            blo.resize(numblk);
+            int hi = domain.bigEnd(idim);
+            for (int k = 0; k < numblk-1; ++k)
+            {
+                hi -= (k < extra ? sz+1 : sz) * ratio;
+                blo[numblk-1-k] = hi+1;
+            }
+            blo[0] = domain.smallEnd(idim);
+        }
+        else
+        {
+            blo.push_back(domain.smallEnd(idim));
+        }
+        st.nblocks[idim] = blo.size();
+        st.npos *= blo.size();
+    }
+
+    BL_ASSERT(st.holes.empty() || (st.holes.front() >= 0 && st.holes.back() < st.npos));
+
+    is_structured = true;
+
+    if (!boxes_built) {
+#ifdef AMREX_MEM_PROFILING
+        updateMemoryUsage_box(-1);
+#endif
+        Vector<Box>().swap(m_abox);
+        has_boxes = false;
+    }
+}
+
+void
+BARef::expand ()
+{
+#ifdef _OPENMP
+#pragma omp critical(boxarray_expand)
+#endif
+    if (!has_boxes)
+    {
+        BL_PROFILE("BARef::expand()");
+
+        BoxList bl(structured.domain);
+        bl.maxSize(structured.chunk);
+        BL_ASSERT(bl.size() == structured.npos);
+
+        const auto& holes = structured.holes;
+        if (holes.empty()) {
+            m_abox = std::move(bl.data());
+        } else {
+            m_abox.clear();
+            m_abox.reserve(structured.size());
+            auto h = holes.cbegin();
+            for (Long pos = 0, N = bl.size(); pos < N; ++pos) {
+                if (h != holes.cend() && *h == pos) {
+                    ++h;
+                } else {
+                    m_abox.push_back(bl.data()[pos]);
+                }
+            }
+        }
+#ifdef AMREX_MEM_PROFILING
+        updateMemoryUsage_box(1);
+#endif
+
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+        has_boxes = true;
+    }
+}
+
+Long
+BARef::Structured::position (const IntVect& blk) const noexcept
+{
+    // BoxList::maxSize appends the boxes chopped in a direction after all
+    // the boxes made so far, the highest block first and the lowest block
+    // staying in place.
+    Long pos = 0;
+    Long np  = 1;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const int n = nblocks[idim];
+        const int q = (blk[idim] == 0) ? 0 : n - blk[idim];
+        if (q > 0) {
+            pos = np + pos*(n-1) + (q-1);
+        }
+        np *= n;
+    }
+    return pos;
+}
+
+int
+BARef::Structured::index (Long pos) const noexcept
+{
+    if (holes.empty()) return static_cast<int>(pos);
+    auto it = std::lower_bound(holes.cbegin(), holes.cend(), pos);
+    if (it != holes.cend() && *it == pos) return -1;
+    return static_cast<int>(pos - (it - holes.cbegin()));
+}
+
+Box
+BARef::Structured::box (const IntVect& blk) const noexcept
+{
+    Box b = domain;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const int k = blk[idim];
+        b.setSmall(idim, blo[idim][k]);
+        b.setBig(idim, (k+1 < nblocks[idim]) ? blo[idim][k+1]-1 : domain.bigEnd(idim));
+    }
+    return b;
+}
+
 void
 BARef::define (const Box& bx)
 {
@@ -182,6 +361,10 @@ BARef::resize (Long n) {
     m_abox.resize(n);
     hash.clear();
     has_hashmap = false;
+    Vector<Long>().swap(sorted.keys);
+    Vector<int>().swap(sorted.index);
+    Vector<int>().swap(sorted.rowstart);
+    has_sorted_index = false;
 #ifdef AMREX_MEM_PROFILING
     updateMemoryUsage_box(1);
 #endif
@@ -208,12 +391,14 @@ BARef::updateMemoryUsage_box (int s)
 void
 BARef::updateMemoryUsage_hash (int s)
 {
-    if (hash.size() > 0) {
+    if (hash.size() > 0 || sorted.keys.size() > 0) {
 	Long b = sizeof(hash);
 	for (const auto& x: hash) {
 	    b += amrex::gcc_map_node_extra_bytes
 		+ sizeof(IntVect) + amrex::bytesOf(x.second);
 	}
+        b += amrex::bytesOf(sorted.keys) + amrex::bytesOf(sorted.index)
+            + amrex::bytesOf(sorted.rowstart);
 	if (s > 0) {
 	    total_hash_bytes += b;
 	    total_hash_bytes_hwm = std::max(total_hash_bytes_hwm, total_hash_bytes);
@@ -260,6 +445,11 @@ BoxArray::Initialize ()
     if (!initialized) {
 	initialized = true;
 	BARef::Initialize();
+
+        ParmParse pp("boxarray");
+        pp.query("sorted_index", use_sorted_index);
+        pp.query("compact_io", use_compact_io);
+        pp.query("structured_max_size", use_structured_max_size);
     }
 
     amrex::ExecOnFinalize(BoxArray::Finalize);
@@ -299,6 +489,15 @@ BoxArray::BoxArray (BoxList&& bl) noexcept
     type_update();
 }
 
+BoxArray::BoxArray (const Box& domain, const IntVect& chunk, const Vector<int>& holes)
+    :
+    m_bat(domain.ixType()),
+    m_ref(std::make_shared<BARef>())
+{
+    BL_ASSERT(domain.ixType().cellCentered());
+    m_ref->define(domain, chunk, holes, false);
+}
+
 BoxArray::BoxArray (size_t n)
     :
     m_bat(),
@@ -311,7 +510,7 @@ BoxArray::BoxArray (const Box* bxvec, int nbox)
     m_ref(std::make_shared<BARef>(nbox))
 {
     for (int i = 0; i < nbox; i++) {
-        m_ref->m_abox[i] = amrex::enclosedCells(*bxvec++);
+        m_ref->boxes()[i] = amrex::enclosedCells(*bxvec++);
     }
 }
 
@@ -375,7 +574,7 @@ BoxArray::numPts () const noexcept
 {
     Long result = 0;
     const int N = size();
-    auto const& bxs = this->m_ref->m_abox;
+    auto const& bxs = this->m_ref->boxes();
     if (m_bat.is_null()) {
 #ifdef _OPENMP
 #pragma omp parallel for reduction(+:result)
@@ -412,7 +611,7 @@ BoxArray::d_numPts () const noexcept
 {
     double result = 0;
     const int N = size();
-    auto const& bxs = this->m_ref->m_abox;
+    auto const& bxs = this->m_ref->boxes();
     if (m_bat.is_null()) {
 #ifdef _OPENMP
 #pragma omp parallel for reduction(+:result)
@@ -450,9 +649,12 @@ BoxArray::readFrom (std::istream& is)
     BL_ASSERT(size() == 0);
     clear();
     int ndims;
-    m_ref->define(is, ndims);
-    if (not m_ref->m_abox.empty()) {
-        m_bat = BATransformer(m_ref->m_abox[0].ixType());
+    IndexType typ;
+    m_ref->define(is, ndims, typ);
+    if (m_ref->is_structured) {
+        m_bat = BATransformer(typ);
+    } else if (not m_ref->boxes().empty()) {
+        m_bat = BATransformer(typ);
         type_update();
     }
     return ndims;
@@ -464,10 +666,24 @@ BoxArray::writeOn (std::ostream& os) const
     //
     // TODO -- completely remove the fiction of a hash value.
     //
+    if (use_compact_io && m_ref->is_structured && m_bat.is_null())
+    {
+        const auto& st = m_ref->structured;
+        os << '(' << size() << ' ' << 1 << '\n'
+           << st.domain << ' ' << st.chunk << ' ' << st.holes.size() << '\n';
+        for (int h : st.holes) {
+            os << h << '\n';
+        }
+        os << ')';
+        if (os.fail())
+            amrex::Error("BoxArray::writeOn(ostream&) failed");
+        return os;
+    }
+
     os << '(' << size() << ' ' << 0 << '\n';
 
     const int N = size();
-    auto const& bxs = this->m_ref->m_abox;
+    auto const& bxs = this->m_ref->boxes();
     if (m_bat.is_null()) {
         for (int i = 0; i < N; ++i) {
             os << bxs[i] << '\n';
@@ -496,7 +712,7 @@ bool
 BoxArray::operator== (const BoxArray& rhs) const noexcept
 {
     return m_bat == rhs.m_bat and
-        (m_ref == rhs.m_ref || m_ref->m_abox == rhs.m_ref->m_abox);
+        (m_ref == rhs.m_ref || m_ref->boxes() == rhs.m_ref->boxes());
 }
 
 bool
@@ -525,7 +741,7 @@ bool
 BoxArray::CellEqual (const BoxArray& rhs) const noexcept
 {
     return crseRatio() == rhs.crseRatio()
-        && (m_ref == rhs.m_ref || m_ref->m_abox == rhs.m_ref->m_abox);
+        && (m_ref == rhs.m_ref || m_ref->boxes() == rhs.m_ref->boxes());
 }
 
 BoxArray&
@@ -540,11 +756,17 @@ BoxArray::maxSize (const IntVect& block_size)
     if ((not m_bat.is_simple()) or (crseRatio() != IntVect::TheUnitVector())) {
         uniqify();
     }
+    // Remember a regular decomposition of a single cell-centered box.
+    const bool structured = use_structured_max_size && (size() == 1) && m_bat.is_null();
+    const Box domain = structured ? m_ref->boxes()[0] : Box();
     BoxList blst(*this);
     blst.maxSize(block_size);
     const int N = blst.size();
     if (size() != N) { // If size doesn't change, do nothing.
         define(std::move(blst));
+        if (structured) {
+            m_ref->define(domain, block_size, Vector<int>(), true);
+        }
     }
     return *this;
 }
@@ -560,13 +782,13 @@ BoxArray::refine (const IntVect& iv)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-	BL_ASSERT(m_ref->m_abox[i].ok());
-        m_ref->m_abox[i].refine(iv);
+	BL_ASSERT(m_ref->boxes()[i].ok());
+        m_ref->boxes()[i].refine(iv);
     }
     return *this;
 }
@@ -587,7 +809,7 @@ BoxArray::coarsenable(const IntVect& refinement_ratio, int min_width) const
     bool res = first.coarsenable(refinement_ratio,min_width);
     if (res == false) return false;
 
-    auto const& bxs = this->m_ref->m_abox;
+    auto const& bxs = this->m_ref->boxes();
     if (m_bat.is_null()) {
 #ifdef _OPENMP
 #pragma omp parallel for reduction(&&:res)
@@ -646,12 +868,12 @@ BoxArray::growcoarsen (IntVect const& ngrow, const IntVect& iv)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].grow(ngrow).coarsen(iv);
+        m_ref->boxes()[i].grow(ngrow).coarsen(iv);
     }
     return *this;
 }
@@ -661,12 +883,12 @@ BoxArray::grow (int n)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].grow(n);
+        m_ref->boxes()[i].grow(n);
     }
     return *this;
 }
@@ -676,12 +898,12 @@ BoxArray::grow (const IntVect& iv)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].grow(iv);
+        m_ref->boxes()[i].grow(iv);
     }
     return *this;
 }
@@ -692,12 +914,12 @@ BoxArray::grow (int dir,
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].grow(dir, n_cell);
+        m_ref->boxes()[i].grow(dir, n_cell);
     }
     return *this;
 }
@@ -708,12 +930,12 @@ BoxArray::growLo (int dir,
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].growLo(dir, n_cell);
+        m_ref->boxes()[i].growLo(dir, n_cell);
     }
     return *this;
 }
@@ -724,12 +946,12 @@ BoxArray::growHi (int dir,
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].growHi(dir, n_cell);
+        m_ref->boxes()[i].growHi(dir, n_cell);
     }
     return *this;
 }
@@ -803,12 +1025,12 @@ BoxArray::shift (int dir,
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].shift(dir, nzones);
+        m_ref->boxes()[i].shift(dir, nzones);
     }
     return *this;
 }
@@ -818,12 +1040,12 @@ BoxArray::shift (const IntVect& iv)
 {
     uniqify();
 
-    const int N = m_ref->m_abox.size();
+    const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < N; i++) {
-        m_ref->m_abox[i].shift(iv);
+        m_ref->boxes()[i].shift(iv);
     }
     return *this;
 }
@@ -835,7 +1057,7 @@ BoxArray::set (int i, const Box& ibox)
     if (i == 0) {
         m_bat.set_index_type(ibox.ixType());
     }
-    m_ref->m_abox[i] = amrex::enclosedCells(ibox);
+    m_ref->boxes()[i] = amrex::enclosedCells(ibox);
 }
 
 Box
@@ -850,7 +1072,7 @@ BoxArray::ok () const
     const int N = size();
     if (N > 0)
     {
-        auto const& bxs = this->m_ref->m_abox;
+        auto const& bxs = this->m_ref->boxes();
         if (m_bat.is_null()) {
             for (int i = 0; i < N; ++i) {
                 if (not bxs[i].ok()) return false;
@@ -878,7 +1100,7 @@ BoxArray::isDisjoint () const
     std::vector< std::pair<int,Box> > isects;
 
     const int N = size();
-    auto const& bxs = this->m_ref->m_abox;
+    auto const& bxs = this->m_ref->boxes();
     if (m_bat.is_null()) {
         for (int i = 0; i < N; ++i) {
             intersections(bxs[i],isects);
@@ -909,7 +1131,7 @@ BoxArray::boxList () const
     newb.data().reserve(N);
     if (N > 0) {
 	newb.set(ixType());
-        auto const& bxs = this->m_ref->m_abox;
+        auto const& bxs = this->m_ref->boxes();
         if (m_bat.is_null()) {
             for (int i = 0; i < N; ++i) {
                 newb.push_back(bxs[i]);
@@ -1011,14 +1233,14 @@ BoxArray::minimalBox () const
 #endif
 	if (use_single_thread)
 	{
-	    minbox = m_ref->m_abox[0];
+	    minbox = m_ref->boxes()[0];
 	    for (int i = 1; i < N; ++i) {
-		minbox.minBox(m_ref->m_abox[i]);
+		minbox.minBox(m_ref->boxes()[i]);
 	    }
 	}
 	else
 	{
-	    Vector<Box> bxs(nthreads, m_ref->m_abox[0]);
+	    Vector<Box> bxs(nthreads, m_ref->boxes()[0]);
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1030,7 +1252,7 @@ BoxArray::minimalBox () const
 #pragma omp for
 #endif
 		for (int i = 0; i < N; ++i) {
-		    bxs[tid].minBox(m_ref->m_abox[i]);
+		    bxs[tid].minBox(m_ref->boxes()[i]);
 		}
 	    }
 	    minbox = bxs[0];
@@ -1061,16 +1283,16 @@ BoxArray::minimalBox (Long& npts_avg_box) const
 #endif
         if (use_single_thread)
         {
-            minbox = m_ref->m_abox[0];
-            npts_tot += m_ref->m_abox[0].numPts();
+            minbox = m_ref->boxes()[0];
+            npts_tot += m_ref->boxes()[0].numPts();
             for (int i = 1; i < N; ++i) {
-                minbox.minBox(m_ref->m_abox[i]);
-                npts_tot += m_ref->m_abox[i].numPts();
+                minbox.minBox(m_ref->boxes()[i]);
+                npts_tot += m_ref->boxes()[i].numPts();
             }
         }
         else
         {
-            Vector<Box> bxs(nthreads, m_ref->m_abox[0]);
+            Vector<Box> bxs(nthreads, m_ref->boxes()[0]);
 #ifdef _OPENMP
 #pragma omp parallel reduction(+:npts_tot)
 #endif
@@ -1082,8 +1304,8 @@ BoxArray::minimalBox (Long& npts_avg_box) const
 #pragma omp for
 #endif
                 for (int i = 0; i < N; ++i) {
-                    bxs[tid].minBox(m_ref->m_abox[i]);
-                    Long npts = m_ref->m_abox[i].numPts();
+                    bxs[tid].minBox(m_ref->boxes()[i]);
+                    Long npts = m_ref->boxes()[i].numPts();
                     npts_tot += npts;
                 }
             }
@@ -1163,37 +1385,68 @@ BoxArray::intersections (const Box&                         bx,
 			 bool                               first_only,
 			 const IntVect&                     ng) const
 {
-  // This is called too many times BL_PROFILE("BoxArray::intersections()");
+    intersections(bx, isects, first_only, ng, !use_sorted_index);
+}
+
+void
+BoxArray::intersections (const Vector<Box>& bxs, Vector<std::vector< std::pair<int,Box> > >& isects,
+                         const IntVect& ng) const
+{
+    BL_PROFILE("BoxArray::intersections(batch)");
 
-    BARef::HashType& BoxHashMap = getHashMap();
+    const bool use_hash = !use_sorted_index;
+    // Build the index before the threads start querying it.
+    if (isStructured()) {
+        m_ref->boxes();
+    } else if (use_hash) {
+        getHashMap();
+    } else {
+        getSortedIndex();
+    }
 
-    isects.resize(0);
+    const int N = bxs.size();
+    isects.resize(N);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,16) if (N > 64)
+#endif
+    for (int i = 0; i < N; ++i) {
+        intersections(bxs[i], isects[i], false, ng, use_hash);
+    }
+}
 
-    if (!BoxHashMap.empty())
-    {
-        BL_ASSERT(bx.ixType() == ixType());
+template <class F>
+void
+BoxArray::forEachBinned (Box const& a_gbx, bool use_hash, F&& f) const
+{
+    Box gbx = a_gbx;
+
+    IntVect glo = gbx.smallEnd();
+    IntVect ghi = gbx.bigEnd();
+    const IntVect& doilo = getDoiLo();
+    const IntVect& doihi = getDoiHi();
 
-	Box gbx = amrex::grow(bx,ng);
+    gbx.setSmall(glo - doihi).setBig(ghi + doilo);
 
-	IntVect glo = gbx.smallEnd();
-	IntVect ghi = gbx.bigEnd();
-	const IntVect& doilo = getDoiLo();
-	const IntVect& doihi = getDoiHi();
+    if (isStructured())
+    {
+        forEachStructured(gbx, std::forward<F>(f));
+    }
+    else if (use_hash)
+    {
+        BARef::HashType& BoxHashMap = getHashMap();
+        if (BoxHashMap.empty()) return;
 
-	gbx.setSmall(glo - doihi).setBig(ghi + doilo);
         gbx.refine(crseRatio()).coarsen(m_ref->crsn);
-	
+
         const IntVect& sm = amrex::max(gbx.smallEnd()-1, m_ref->bbox.smallEnd());
         const IntVect& bg = amrex::min(gbx.bigEnd(),     m_ref->bbox.bigEnd());
 
         Box cbx(sm,bg);
         cbx.normalize();
 
-	if (!cbx.intersects(m_ref->bbox)) return;
+        if (!cbx.intersects(m_ref->bbox)) return;
 
-	auto TheEnd = BoxHashMap.cend();
-
-        auto& abox = m_ref->m_abox;
+        auto TheEnd = BoxHashMap.cend();
 
         for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
         {
@@ -1201,48 +1454,150 @@ BoxArray::intersections (const Box&                         bx,
 
             if (it != TheEnd)
             {
-                if (m_bat.is_null()) {
-                    for (const int index : it->second)
-                    {
-                        const Box& ibox = abox[index];
-                        const Box& isect = bx & amrex::grow(ibox,ng);
-
-                        if (isect.ok())
-                        {
-                            isects.push_back(std::pair<int,Box>(index,isect));
-                            if (first_only) return;
-                        }
-                    }
-                } else if (m_bat.is_simple()) {
-                    IndexType t = ixType();
-                    IntVect cr = crseRatio();
-                    for (const int index : it->second)
-                    {
-                        const Box& ibox = amrex::convert(amrex::coarsen(abox[index],cr),t);
-                        const Box& isect = bx & amrex::grow(ibox,ng);
-
-                        if (isect.ok())
-                        {
-                            isects.push_back(std::pair<int,Box>(index,isect));
-                            if (first_only) return;
-                        }
-                    }
-                } else {
-                    for (const int index : it->second)
-                    {
-                        const Box& ibox = m_bat.m_op.m_bndryReg(abox[index]);
-                        const Box& isect = bx & amrex::grow(ibox,ng);
-
-                        if (isect.ok())
-                        {
-                            isects.push_back(std::pair<int,Box>(index,isect));
-                            if (first_only) return;
-                        }
-                    }
+                for (const int index : it->second)
+                {
+                    if (f(index)) return;
                 }
             }
         }
     }
+    else
+    {
+        const BARef::SortedIndex& sidx = getSortedIndex();
+        if (sidx.keys.empty()) return;
+
+        gbx.refine(crseRatio()).coarsen(sidx.crsn);
+
+        const IntVect& sm = amrex::max(gbx.smallEnd()-1, sidx.bbox.smallEnd());
+        const IntVect& bg = amrex::min(gbx.bigEnd(),     sidx.bbox.bigEnd());
+
+        Box cbx(sm,bg);
+        cbx.normalize();
+
+        if (!cbx.intersects(sidx.bbox)) return;
+
+        const IntVect blo = sidx.bbox.smallEnd();
+        const IntVect len = sidx.bbox.length();
+        auto key = [&] (const IntVect& iv) -> Long {
+            Long k = 0;
+            for (int idim = AMREX_SPACEDIM-1; idim >= 0; --idim) {
+                k = k*len[idim] + (iv[idim]-blo[idim]);
+            }
+            return k;
+        };
+
+        // The bins in a row along the first direction have consecutive keys.
+        Box rows = cbx;
+        rows.setBig(0, cbx.smallEnd(0));
+        const int nx = cbx.length(0);
+        const bool has_rowstart = !sidx.rowstart.empty();
+        const auto kbegin = sidx.keys.cbegin();
+        for (IntVect iv = rows.smallEnd(), End = rows.bigEnd(); iv <= End; rows.next(iv))
+        {
+            const Long klo = key(iv);
+            const Long khi = klo + nx - 1;
+            auto rbegin = kbegin;
+            auto rend   = sidx.keys.cend();
+            if (has_rowstart) {
+                const Long row = klo / len[0];
+                rbegin = kbegin + sidx.rowstart[row];
+                rend   = kbegin + sidx.rowstart[row+1];
+            }
+            for (auto it = std::lower_bound(rbegin, rend, klo); it != rend && *it <= khi; ++it)
+            {
+                if (f(sidx.index[it-kbegin])) return;
+            }
+        }
+    }
+}
+
+template <class F>
+void
+BoxArray::forEachStructured (Box const& a_gbx, F&& f) const
+{
+    const BARef::Structured& st = m_ref->structured;
+
+    // The cells of the structured boxes near gbx, with one coarse cell to
+    // spare for the index type and the coarsening.
+    const IntVect& cr = crseRatio();
+    IntVect lo = (a_gbx.smallEnd() - 1) * cr;
+    IntVect hi = (a_gbx.bigEnd() + 2) * cr - 1;
+    lo.max(st.domain.smallEnd());
+    hi.min(st.domain.bigEnd());
+    if (!(lo <= hi)) return;
+
+    IntVect blo, bhi;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const auto& b = st.blo[idim];
+        blo[idim] = static_cast<int>(std::upper_bound(b.cbegin(), b.cend(), lo[idim]) - b.cbegin()) - 1;
+        bhi[idim] = static_cast<int>(std::upper_bound(b.cbegin(), b.cend(), hi[idim]) - b.cbegin()) - 1;
+    }
+
+    const Box blocks(blo, bhi);
+    for (IntVect blk = blocks.smallEnd(), End = blocks.bigEnd(); blk <= End; blocks.next(blk))
+    {
+        const int index = st.index(st.position(blk));
+        if (index >= 0 && f(index)) return;
+    }
+}
+
+void
+BoxArray::intersections (const Box&                         bx,
+                         std::vector< std::pair<int,Box> >& isects,
+			 bool                               first_only,
+			 const IntVect&                     ng,
+                         bool                               use_hash) const
+{
+  // This is called too many times BL_PROFILE("BoxArray::intersections()");
+
+    isects.resize(0);
+
+    if (empty()) return;
+
+    BL_ASSERT(bx.ixType() == ixType());
+
+    auto& abox = m_ref->boxes();
+
+    if (m_bat.is_null()) {
+        forEachBinned(amrex::grow(bx,ng), use_hash, [&] (int index) -> bool
+        {
+            const Box& ibox = abox[index];
+            const Box& isect = bx & amrex::grow(ibox,ng);
+            if (isect.ok())
+            {
+                isects.push_back(std::pair<int,Box>(index,isect));
+                return first_only;
+            }
+            return false;
+        });
+    } else if (m_bat.is_simple()) {
+        IndexType t = ixType();
+        IntVect cr = crseRatio();
+        forEachBinned(amrex::grow(bx,ng), use_hash, [&] (int index) -> bool
+        {
+            const Box& ibox = amrex::convert(amrex::coarsen(abox[index],cr),t);
+            const Box& isect = bx & amrex::grow(ibox,ng);
+            if (isect.ok())
+            {
+                isects.push_back(std::pair<int,Box>(index,isect));
+                return first_only;
+            }
+            return false;
+        });
+    } else {
+        forEachBinned(amrex::grow(bx,ng), use_hash, [&] (int index) -> bool
+        {
+            const Box& ibox = m_bat.m_op.m_bndryReg(abox[index]);
+            const Box& isect = bx & amrex::grow(ibox,ng);
+            if (isect.ok())
+            {
+                isects.push_back(std::pair<int,Box>(index,isect));
+                return first_only;
+            }
+            return false;
+        });
+    }
 }
 
 BoxList
@@ -1262,96 +1617,47 @@ BoxArray::complementIn (BoxList& bl, const Box& bx) const
 
     if (!empty()) 
     {
-	BARef::HashType& BoxHashMap = getHashMap();
-
 	BL_ASSERT(bx.ixType() == ixType());
 
-	Box gbx = bx;
-
-	IntVect glo = gbx.smallEnd();
-	IntVect ghi = gbx.bigEnd();
-	const IntVect& doilo = getDoiLo();
-	const IntVect& doihi = getDoiHi();
-
-	gbx.setSmall(glo - doihi).setBig(ghi + doilo);
-        gbx.refine(crseRatio()).coarsen(m_ref->crsn);
-	
-        const IntVect& sm = amrex::max(gbx.smallEnd()-1, m_ref->bbox.smallEnd());
-        const IntVect& bg = amrex::min(gbx.bigEnd(),     m_ref->bbox.bigEnd());
-
-        Box cbx(sm,bg);
-        cbx.normalize();
-
-	if (!cbx.intersects(m_ref->bbox)) return;
-
-	auto TheEnd = BoxHashMap.cend();
-
         BoxList newbl(bl.ixType());
         newbl.reserve(bl.capacity());
         BoxList newdiff(bl.ixType());
 
-        auto& abox = m_ref->m_abox;
+        auto& abox = m_ref->boxes();
 
-	for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); 
-	     iv <= End && bl.isNotEmpty(); 
-	     cbx.next(iv))
+        auto subtract = [&] (const Box& ibox) -> bool
         {
-            auto it = BoxHashMap.find(iv);
-
-            if (it != TheEnd)
+            const Box& isect = bx & ibox;
+            if (isect.ok())
             {
-                if (m_bat.is_null()) {
-                    for (const int index : it->second)
-                    {
-                        const Box& ibox = abox[index];
-                        const Box& isect = bx & ibox;
-
-                        if (isect.ok())
-                        {
-                            newbl.clear();
-                            for (const Box& b : bl) {
-                                amrex::boxDiff(newdiff, b, isect);
-                                newbl.join(newdiff);
-                            }
-                            bl.swap(newbl);
-                        }
-                    }
-                } else if (m_bat.is_simple()) {
-                    IndexType t = ixType();
-                    IntVect cr = crseRatio();
-                    for (const int index : it->second)
-                    {
-                        const Box& ibox = amrex::convert(amrex::coarsen(abox[index],cr),t);
-                        const Box& isect = bx & ibox;
-
-                        if (isect.ok())
-                        {
-                            newbl.clear();
-                            for (const Box& b : bl) {
-                                amrex::boxDiff(newdiff, b, isect);
-                                newbl.join(newdiff);
-                            }
-                            bl.swap(newbl);
-                        }
-                    }
-                } else {
-                    for (const int index : it->second)
-                    {
-                        const Box& ibox = m_bat.m_op.m_bndryReg(abox[index]);
-                        const Box& isect = bx & ibox;
-
-                        if (isect.ok())
-                        {
-                            newbl.clear();
-                            for (const Box& b : bl) {
-                                amrex::boxDiff(newdiff, b, isect);
-                                newbl.join(newdiff);
-                            }
-                            bl.swap(newbl);
-                        }
-                    }
+                newbl.clear();
+                for (const Box& b : bl) {
+                    amrex::boxDiff(newdiff, b, isect);
+                    newbl.join(newdiff);
                 }
+                bl.swap(newbl);
             }
+            return bl.isEmpty();
+        };
+
+        const bool use_hash = !use_sorted_index;
+        if (m_bat.is_null()) {
+            forEachBinned(bx, use_hash, [&] (int index) -> bool
+            {
+                return subtract(abox[index]);
+            });
+        } else if (m_bat.is_simple()) {
+            IndexType t = ixType();
+            IntVect cr = crseRatio();
+            forEachBinned(bx, use_hash, [&] (int index) -> bool
+            {
+                return subtract(amrex::convert(amrex::coarsen(abox[index],cr),t));
+            });
+        } else {
+            forEachBinned(bx, use_hash, [&] (int index) -> bool
+            {
+                return subtract(m_bat.m_op.m_bndryReg(abox[index]));
+            });
         }
     }
 }
@@ -1359,13 +1665,17 @@ BoxArray::complementIn (BoxList& bl, const Box& bx) const
 void
 BoxArray::clear_hash_bin () const
 {
-    if (!m_ref->hash.empty())
+    if (!m_ref->hash.empty() || m_ref->has_sorted_index)
     {
 #ifdef AMREX_MEM_PROFILING
 	m_ref->updateMemoryUsage_hash(-1);
 #endif
         m_ref->hash.clear();
         m_ref->has_hashmap = false;
+        Vector<Long>().swap(m_ref->sorted.keys);
+        Vector<int>().swap(m_ref->sorted.index);
+        Vector<int>().swap(m_ref->sorted.rowstart);
+        m_ref->has_sorted_index = false;
     }
 }
 
@@ -1403,15 +1713,16 @@ BoxArray::removeOverlap (bool simplify)
 
     for (int i = 0; i < size(); i++)
     {
-        if (m_ref->m_abox[i].ok())
+        if (m_ref->boxes()[i].ok())
         {
-            intersections(m_ref->m_abox[i],isects);
+            // The hash is updated below as boxes are added.
+            intersections(m_ref->boxes()[i], isects, false, IntVect::TheZeroVector(), true);
 
             for (int j = 0, N = isects.size(); j < N; j++)
             {
                 if (isects[j].first == i) continue;
 
-                Box& bx = m_ref->m_abox[isects[j].first];
+                Box& bx = m_ref->boxes()[isects[j].first];
 
                 amrex::boxDiff(bl_diff, bx, isects[j].second);
 
@@ -1419,7 +1730,7 @@ BoxArray::removeOverlap (bool simplify)
 
                 for (const Box& b : bl_diff)
                 {
-                    m_ref->m_abox.push_back(b);
+                    m_ref->boxes().push_back(b);
                     BoxHashMap[amrex::coarsen(b.smallEnd(),m_ref->crsn)].push_back(size()-1);
                 }
             }
@@ -1432,7 +1743,7 @@ BoxArray::removeOverlap (bool simplify)
     // We now have "holes" in our BoxArray. Make us good.
     //
     BoxList bl(ixType());
-    for (const auto& b : m_ref->m_abox) {
+    for (const auto& b : m_ref->boxes()) {
         if (b.ok()) {
             bl.push_back(b);
         }
@@ -1460,7 +1771,7 @@ BoxArray::type_update ()
     {
 	if (not ixType().cellCentered())
 	{
-            for (auto& bx : m_ref->m_abox) {
+            for (auto& bx : m_ref->boxes()) {
 		bx.enclosedCells();
 	    }
 	}
@@ -1496,12 +1807,12 @@ BoxArray::getHashMap () const
             // Calculate the bounding box & maximum extent of the boxes.
             //
 	    IntVect maxext = IntVect::TheUnitVector();
-            Box boundingbox = m_ref->m_abox[0];
+            Box boundingbox = m_ref->boxes()[0];
 
 	    const int N = size();
 	    for (int i = 0; i < N; ++i)
             {
-                Box bx = m_ref->m_abox[i];
+                Box bx = m_ref->boxes()[i];
                 bx.normalize();
                 maxext = amrex::max(maxext, bx.size());
                 boundingbox.minBox(bx);
@@ -1510,7 +1821,7 @@ BoxArray::getHashMap () const
             for (int i = 0; i < N; i++)
             {
                 const IntVect& crsnsmlend 
-		    = amrex::coarsen(m_ref->m_abox[i].smallEnd(),maxext);
+		    = amrex::coarsen(m_ref->boxes()[i].smallEnd(),maxext);
                 BoxHashMap[crsnsmlend].push_back(i);
             }
 
@@ -1533,6 +1844,158 @@ BoxArray::getHashMap () const
     return BoxHashMap;
 }
 
+const BARef::SortedIndex&
+BoxArray::getSortedIndex () const
+{
+    BARef::SortedIndex& sidx = m_ref->sorted;
+
+    if (m_ref->HasSortedIndex()) return sidx;
+
+#ifdef _OPENMP
+#pragma omp critical(intersections_lock)
+#endif
+    if (!m_ref->has_sorted_index && size() > 0)
+    {
+        BL_PROFILE("BoxArray::getSortedIndex()");
+
+        const auto& abox = m_ref->boxes();
+        const int N = size();
+
+        //
+        // Calculate the bounding box & maximum extent of the boxes.
+        //
+        int nthreads = 1;
+#ifdef _OPENMP
+        nthreads = omp_in_parallel() ? 1 : omp_get_max_threads();
+#endif
+        Vector<IntVect> t_maxext(nthreads, IntVect::TheUnitVector());
+        Vector<Box> t_bbox(nthreads);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            IntVect maxext = IntVect::TheUnitVector();
+            Box boundingbox;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (int i = 0; i < N; ++i)
+            {
+                Box bx = abox[i];
+                bx.normalize();
+                maxext = amrex::max(maxext, bx.size());
+                if (boundingbox.ok()) {
+                    boundingbox.minBox(bx);
+                } else {
+                    boundingbox = bx;
+                }
+            }
+            t_maxext[tid] = maxext;
+            t_bbox[tid] = boundingbox;
+        }
+
+        IntVect maxext = IntVect::TheUnitVector();
+        Box boundingbox;
+        for (int t = 0; t < nthreads; ++t) {
+            maxext = amrex::max(maxext, t_maxext[t]);
+            if (!t_bbox[t].ok()) continue;
+            if (boundingbox.ok()) {
+                boundingbox.minBox(t_bbox[t]);
+            } else {
+                boundingbox = t_bbox[t];
+            }
+        }
+
+        sidx.crsn = maxext;
+        sidx.bbox = boundingbox.coarsen(maxext);
+        sidx.bbox.normalize();
+
+        const IntVect blo = sidx.bbox.smallEnd();
+        const IntVect len = sidx.bbox.length();
+
+        // Sort the (key, index) pairs in chunks, one per thread, and then
+        // merge the chunks pairwise.  Ties are broken by the index, so the
+        // boxes in a bin are in the same order as in the hash.
+        Vector<std::pair<Long,int> > kv(N);
+        Vector<int> chunk(nthreads+1);
+        for (int t = 0; t <= nthreads; ++t) {
+            chunk[t] = static_cast<int>((static_cast<Long>(N)*t)/nthreads);
+        }
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            for (int i = chunk[tid]; i < chunk[tid+1]; ++i)
+            {
+                const IntVect iv = amrex::coarsen(abox[i].smallEnd(),maxext);
+                Long k = 0;
+                for (int idim = AMREX_SPACEDIM-1; idim >= 0; --idim) {
+                    k = k*len[idim] + (iv[idim]-blo[idim]);
+                }
+                kv[i] = std::make_pair(k,i);
+            }
+            std::sort(kv.begin()+chunk[tid], kv.begin()+chunk[tid+1]);
+        }
+
+        for (int width = 1; width < nthreads; width *= 2)
+        {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads)
+#endif
+            for (int t = 0; t < nthreads-width; t += 2*width)
+            {
+                std::inplace_merge(kv.begin()+chunk[t],
+                                   kv.begin()+chunk[t+width],
+                                   kv.begin()+chunk[std::min(t+2*width,nthreads)]);
+            }
+        }
+
+        sidx.keys.resize(N);
+        sidx.index.resize(N);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads)
+#endif
+        for (int i = 0; i < N; ++i) {
+            sidx.keys[i] = kv[i].first;
+            sidx.index[i] = kv[i].second;
+        }
+
+        const Long nrows = sidx.bbox.numPts() / len[0];
+        if (nrows <= 4*static_cast<Long>(N))
+        {
+            sidx.rowstart.resize(nrows+1);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads)
+#endif
+            for (Long row = 0; row <= nrows; ++row) {
+                sidx.rowstart[row] = std::lower_bound(sidx.keys.cbegin(), sidx.keys.cend(),
+                                                      row*len[0]) - sidx.keys.cbegin();
+            }
+        }
+
+#ifdef AMREX_MEM_PROFILING
+        m_ref->updateMemoryUsage_hash(-1);
+        m_ref->updateMemoryUsage_hash(1);
+#endif
+
+#ifdef _OPENMP
+#pragma omp flush
+#pragma omp atomic write
+#endif
+        m_ref->has_sorted_index = true;
+    }
+
+    return sidx;
+}
+
 void
 BoxArray::uniqify ()
 {
@@ -1542,14 +2005,20 @@ BoxArray::uniqify ()
 	auto p = std::make_shared<BARef>(*m_ref);
 	std::swap(m_ref,p);
     }
+    if (m_ref->is_structured) {
+        // The boxes are about to change.
+        m_ref->boxes();
+        m_ref->is_structured = false;
+        m_ref->structured = BARef::Structured();
+    }
     IntVect cr = crseRatio();
     if (cr != IntVect::TheUnitVector()) {
-        const int N = m_ref->m_abox.size();
+        const int N = m_ref->boxes().size();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
         for (int i = 0; i < N; i++) {
-            m_ref->m_abox[i].coarsen(cr);
+            m_ref->boxes()[i].coarsen(cr);
         }
         m_bat.set_coarsen_ratio(IntVect::TheUnitVector());
     }
@@ -3,6 +3,7 @@
 #include <cstring>
 
 #include <AMReX_CArena.H>
+#include <AMReX_MemSites.H>
 #include <AMReX_BLassert.H>
 #include <AMReX_Gpu.H>
 #include <AMReX_ParallelReduce.H>
@@ -104,12 +105,16 @@ CArena::alloc (std::size_t nbytes)
 
     BL_ASSERT(!(vp == 0));
 
+    if (MemSites::Enabled()) MemSites::Alloc(this, vp, nbytes);
+
     return vp;
 }
 
 void
 CArena::free (void* vp)
 {
+    if (MemSites::Enabled()) MemSites::Free(vp);
+
     std::lock_guard<std::mutex> lock(carena_mutex);
 
     if (vp == 0)
@@ -3,6 +3,7 @@
 #include <cmath>
 
 #include <AMReX_DArena.H>
+#include <AMReX_MemSites.H>
 #include <AMReX_BLassert.H>
 #include <AMReX_Gpu.H>
 #include <AMReX_Print.H>
@@ -78,11 +79,12 @@ DArena::alloc (std::size_t nbytes)
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    void* p;
     std::ptrdiff_t offset = allocate_order(order);
     if (offset >= 0) {
         offset *= m_block_size; // # of order 0 blocks -> # of bytes
         m_used.insert({offset,order});
-        return m_baseptr + offset;
+        p = m_baseptr + offset;
     } else {
         if (amrex::Verbose()) {
             if (!warning_printed) {
@@ -95,15 +97,20 @@ DArena::alloc (std::size_t nbytes)
                 warning_printed = true;
             }
         }
-        void* p = allocate_system(nbytes); // use the system malloc as backup.
+        p = allocate_system(nbytes); // use the system malloc as backup.
         m_system.insert({p,nbytes});
-        return p;
     }
+
+    if (MemSites::Enabled()) MemSites::Alloc(this, p, nbytes);
+
+    return p;
 }
 
 void
 DArena::free (void* p)
 {
+    if (MemSites::Enabled()) MemSites::Free(p);
+
     std::lock_guard<std::mutex> lock(m_mutex);
 
     std::ptrdiff_t offset = (char*)p - m_baseptr;
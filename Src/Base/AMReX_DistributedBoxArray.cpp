@@ -0,0 +1,415 @@
+
+#include <AMReX_DistributedBoxArray.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParallelReduce.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace amrex {
+
+Long
+DistributedBoxArray::Neighborhood::bytes () const
+{
+    Long b = amrex::bytesOf(index) + amrex::bytesOf(local);
+    if (!ba.empty()) {
+        b += ba.size()*sizeof(Box) + ba.size()*sizeof(int);  // boxes and owners
+    }
+    return b;
+}
+
+DistributedBoxArray::DistributedBoxArray (const Vector<Box>& boxes, const Vector<int>& indices,
+                                          const IntVect& ng, const Periodicity& period)
+    : m_ng(ng), m_period(period)
+{
+    define(boxes, indices);
+}
+
+DistributedBoxArray::DistributedBoxArray (const BoxArray& ba, const DistributionMapping& dm,
+                                          const IntVect& ng, const Periodicity& period)
+    : m_typ(ba.ixType()), m_ng(ng), m_period(period)
+{
+    const int myproc = ParallelDescriptor::MyProc();
+    Vector<Box> boxes;
+    Vector<int> indices;
+    for (int i = 0, N = ba.size(); i < N; ++i) {
+        if (dm[i] == myproc) {
+            boxes.push_back(ba[i]);
+            indices.push_back(i);
+        }
+    }
+    define(boxes, indices);
+}
+
+DistributedBoxArray::DistributedBoxArray (DistributedBoxArray&& rhs) noexcept
+    : m_typ(rhs.m_typ), m_ng(rhs.m_ng), m_period(rhs.m_period), m_size(rhs.m_size),
+      m_nbh(std::move(rhs.m_nbh)),
+      m_crsn(rhs.m_crsn), m_binbox(rhs.m_binbox),
+      m_keys(std::move(rhs.m_keys)), m_ranks(std::move(rhs.m_ranks))
+{
+#ifdef AMREX_MEM_PROFILING
+    m_counted_bytes = rhs.m_counted_bytes;
+    rhs.m_counted_bytes = 0;
+#endif
+}
+
+DistributedBoxArray::~DistributedBoxArray ()
+{
+#ifdef AMREX_MEM_PROFILING
+    BARef::total_box_bytes -= m_counted_bytes;
+#endif
+}
+
+void
+DistributedBoxArray::define (const Vector<Box>& boxes, const Vector<int>& indices)
+{
+    BL_PROFILE("DistributedBoxArray::define()");
+
+    AMREX_ALWAYS_ASSERT(boxes.size() == indices.size());
+
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    // The IndexType of the processes without boxes comes from the others.
+    int ityp[AMREX_SPACEDIM] = {AMREX_D_DECL(-1,-1,-1)};
+    if (!boxes.empty()) {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            ityp[idim] = boxes[0].type(idim);
+        }
+    }
+    ParallelDescriptor::ReduceIntMax(ityp, AMREX_SPACEDIM);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        m_typ.setType(idim, (ityp[idim] == 1) ? IndexType::NODE : IndexType::CELL);
+    }
+
+    for (const auto& b : boxes) {
+        AMREX_ALWAYS_ASSERT(b.ixType() == m_typ);
+    }
+
+    //
+    // Global size, bounding box and maximum box extent.
+    //
+    m_size = boxes.size();
+    ParallelDescriptor::ReduceLongSum(m_size);
+
+    int lo[AMREX_SPACEDIM], hi[AMREX_SPACEDIM], ext[AMREX_SPACEDIM];
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        lo[idim] = std::numeric_limits<int>::max();
+        hi[idim] = std::numeric_limits<int>::lowest();
+        ext[idim] = 1;
+    }
+    for (const auto& b : boxes) {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            lo[idim] = std::min(lo[idim], b.smallEnd(idim));
+            hi[idim] = std::max(hi[idim], b.bigEnd(idim));
+            ext[idim] = std::max(ext[idim], b.length(idim));
+        }
+    }
+    ParallelDescriptor::ReduceIntMin(lo, AMREX_SPACEDIM);
+    ParallelDescriptor::ReduceIntMax(hi, AMREX_SPACEDIM);
+    ParallelDescriptor::ReduceIntMax(ext, AMREX_SPACEDIM);
+
+    if (m_size == 0) return;
+
+    //
+    // Bins of about half the width of the region of a process in each
+    // direction, so that a process is in a few bins and a bin has a few
+    // processes.
+    //
+    const double boxes_per_proc = std::max(1.0, double(m_size)/double(nprocs));
+    const int f = std::max(1, static_cast<int>(0.5*std::pow(boxes_per_proc, 1.0/AMREX_SPACEDIM)));
+    m_crsn = IntVect(AMREX_D_DECL(ext[0]*f, ext[1]*f, ext[2]*f));
+    m_binbox = Box(IntVect(AMREX_D_DECL(lo[0],lo[1],lo[2])),
+                   IntVect(AMREX_D_DECL(hi[0],hi[1],hi[2])), m_typ);
+    m_binbox = amrex::enclosedCells(m_binbox).coarsen(m_crsn);
+
+    Vector<Long> mykeys;
+    for (const auto& b : boxes) {
+        Box bins = amrex::coarsen(amrex::enclosedCells(b), m_crsn);
+        for (IntVect iv = bins.smallEnd(), End = bins.bigEnd(); iv <= End; bins.next(iv)) {
+            mykeys.push_back(binKey(iv));
+        }
+    }
+    std::sort(mykeys.begin(), mykeys.end());
+    mykeys.erase(std::unique(mykeys.begin(), mykeys.end()), mykeys.end());
+
+    //
+    // Replicate the occupancy grid.
+    //
+    Vector<int> counts(nprocs);
+    int mycount = mykeys.size();
+#ifdef BL_USE_MPI
+    ParallelAllGather::AllGather(mycount, counts.dataPtr(), ParallelDescriptor::Communicator());
+#else
+    counts[0] = mycount;
+#endif
+    Vector<int> offsets(nprocs+1, 0);
+    for (int i = 0; i < nprocs; ++i) {
+        offsets[i+1] = offsets[i] + counts[i];
+    }
+
+    Vector<Long> allkeys(offsets[nprocs]);
+#ifdef BL_USE_MPI
+    MPI_Allgatherv(mykeys.data(), mycount, ParallelDescriptor::Mpi_typemap<Long>::type(),
+                   allkeys.data(), counts.data(), offsets.data(),
+                   ParallelDescriptor::Mpi_typemap<Long>::type(),
+                   ParallelDescriptor::Communicator());
+#else
+    allkeys = mykeys;
+#endif
+
+    Vector<std::pair<Long,int> > kr(allkeys.size());
+    for (int r = 0; r < nprocs; ++r) {
+        for (int i = offsets[r]; i < offsets[r+1]; ++i) {
+            kr[i] = std::make_pair(allkeys[i], r);
+        }
+    }
+    std::sort(kr.begin(), kr.end());
+    m_keys.resize(kr.size());
+    m_ranks.resize(kr.size());
+    for (int i = 0, N = kr.size(); i < N; ++i) {
+        m_keys[i] = kr[i].first;
+        m_ranks[i] = kr[i].second;
+    }
+
+    m_nbh = neighborhood(boxes, indices, *this, boxes, m_ng, m_period);
+
+#ifdef AMREX_MEM_PROFILING
+    m_counted_bytes = bytes() - m_nbh.ba.size()*sizeof(Box);  // the BoxArray counts itself
+    BARef::total_box_bytes += m_counted_bytes;
+    BARef::total_box_bytes_hwm = std::max(BARef::total_box_bytes_hwm, BARef::total_box_bytes);
+#endif
+}
+
+Long
+DistributedBoxArray::binKey (const IntVect& bin) const noexcept
+{
+    const IntVect blo = m_binbox.smallEnd();
+    const IntVect len = m_binbox.length();
+    Long k = 0;
+    for (int idim = AMREX_SPACEDIM-1; idim >= 0; --idim) {
+        k = k*len[idim] + (bin[idim]-blo[idim]);
+    }
+    return k;
+}
+
+void
+DistributedBoxArray::ranksNear (const Box& bx, Vector<int>& ranks) const
+{
+    ranks.clear();
+    if (m_keys.empty()) return;
+
+    // The cells touched by bx.  A node touches the cells on both sides.
+    Box cbx = amrex::enclosedCells(amrex::convert(bx,m_typ));
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (m_typ.nodeCentered(idim)) cbx.grow(idim,1);
+    }
+    Box bins = amrex::coarsen(cbx, m_crsn);
+    bins &= m_binbox;
+    if (!bins.ok()) return;
+
+    // The bins in a row along the first direction have consecutive keys.
+    Box rows = bins;
+    rows.setBig(0, bins.smallEnd(0));
+    const int nx = bins.length(0);
+    for (IntVect iv = rows.smallEnd(), End = rows.bigEnd(); iv <= End; rows.next(iv))
+    {
+        const Long klo = binKey(iv);
+        const Long khi = klo + nx - 1;
+        for (auto it = std::lower_bound(m_keys.cbegin(), m_keys.cend(), klo);
+             it != m_keys.cend() && *it <= khi; ++it)
+        {
+            ranks.push_back(m_ranks[it-m_keys.cbegin()]);
+        }
+    }
+
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+}
+
+bool
+DistributedBoxArray::mayIntersect (const Box& bx) const
+{
+    Vector<int> ranks;
+    ranksNear(bx, ranks);
+    return !ranks.empty();
+}
+
+DistributedBoxArray::Neighborhood
+DistributedBoxArray::neighborhood (const DistributedBoxArray& near, const IntVect& ng,
+                                   const Periodicity& period) const
+{
+    Vector<Box> boxes, near_boxes;
+    Vector<int> indices, near_indices;
+    localBoxes(boxes, indices);
+    near.localBoxes(near_boxes, near_indices);
+    return neighborhood(boxes, indices, near, near_boxes, ng, period);
+}
+
+void
+DistributedBoxArray::localBoxes (Vector<Box>& boxes, Vector<int>& indices) const
+{
+    const int nlocal = m_nbh.local.size();
+    boxes.resize(nlocal);
+    indices.resize(nlocal);
+    for (int i = 0; i < nlocal; ++i) {
+        boxes[i] = m_nbh.ba[i];
+        indices[i] = m_nbh.index[i];
+    }
+}
+
+DistributedBoxArray::Neighborhood
+DistributedBoxArray::neighborhood (const Vector<Box>& boxes, const Vector<int>& indices,
+                                   const DistributedBoxArray& near, const Vector<Box>& near_boxes,
+                                   const IntVect& ng, const Periodicity& period) const
+{
+    BL_PROFILE("DistributedBoxArray::neighborhood()");
+
+    const int myproc = ParallelDescriptor::MyProc();
+    const int nlocal = boxes.size();
+
+    // A box is sent to the processes of near that own boxes within ng of
+    // it.  As that is symmetric, each process receives the boxes within ng
+    // of its own boxes of near.
+    Vector<std::pair<int,int> > dest;  // (rank, local box)
+    {
+        const std::vector<IntVect>& pshifts = period.shiftIntVect();
+        Vector<int> ranks;
+        for (int i = 0; i < nlocal; ++i) {
+            const Box& gbx = amrex::grow(amrex::convert(boxes[i],near.ixType()), ng);
+            for (const auto& iv : pshifts) {
+                near.ranksNear(gbx-iv, ranks);
+                for (int r : ranks) {
+                    if (r != myproc) dest.push_back(std::make_pair(r,i));
+                }
+            }
+        }
+        std::sort(dest.begin(), dest.end());
+        dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
+    }
+
+    // Each box is sent as its corners and global index.
+    constexpr int nints = 2*AMREX_SPACEDIM+1;
+    Vector<int> recvbuf;
+    Vector<int> recvfrom;
+
+#ifdef BL_USE_MPI
+    const int nprocs = ParallelDescriptor::NProcs();
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+
+    Vector<int> sendto;
+    Vector<int> sendoffset;
+    Vector<int> sendbuf;
+    sendbuf.reserve(dest.size()*nints);
+    for (int n = 0, N = dest.size(); n < N; ++n) {
+        if (sendto.empty() || sendto.back() != dest[n].first) {
+            sendto.push_back(dest[n].first);
+            sendoffset.push_back(sendbuf.size());
+        }
+        const Box& b = boxes[dest[n].second];
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            sendbuf.push_back(b.smallEnd(idim));
+        }
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            sendbuf.push_back(b.bigEnd(idim));
+        }
+        sendbuf.push_back(indices[dest[n].second]);
+    }
+    sendoffset.push_back(sendbuf.size());
+
+    // Number of processes sending to this process
+    Vector<int> nsenders(nprocs, 0);
+    for (int r : sendto) nsenders[r] = 1;
+    int nrecv = 0;
+    MPI_Reduce_scatter_block(nsenders.data(), &nrecv, 1, MPI_INT, MPI_SUM, comm);
+    nsenders.clear();
+
+    const int tag = ParallelDescriptor::SeqNum();
+    Vector<MPI_Request> reqs(sendto.size());
+    for (int n = 0, N = sendto.size(); n < N; ++n) {
+        MPI_Isend(sendbuf.data()+sendoffset[n], sendoffset[n+1]-sendoffset[n], MPI_INT,
+                  sendto[n], tag, comm, &reqs[n]);
+    }
+
+    for (int n = 0; n < nrecv; ++n) {
+        MPI_Status status;
+        MPI_Probe(MPI_ANY_SOURCE, tag, comm, &status);
+        int cnt;
+        MPI_Get_count(&status, MPI_INT, &cnt);
+        const std::size_t offset = recvbuf.size();
+        recvbuf.resize(offset+cnt);
+        MPI_Recv(recvbuf.data()+offset, cnt, MPI_INT, status.MPI_SOURCE, tag, comm, MPI_STATUS_IGNORE);
+        recvfrom.insert(recvfrom.end(), cnt/nints, status.MPI_SOURCE);
+    }
+
+    if (!reqs.empty()) {
+        MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+    }
+#endif
+
+    // The bins are coarse, so the received boxes that are not within ng of
+    // the local boxes of near are dropped.
+    const int nrecv_boxes = recvfrom.size();
+    Vector<int> order;
+    if (nrecv_boxes > 0)
+    {
+        BoxList nearbl(near.ixType());
+        for (const auto& b : near_boxes) nearbl.push_back(b);
+        const BoxArray nearba(std::move(nearbl));
+        const std::vector<IntVect>& pshifts = period.shiftIntVect();
+        for (int n = 0; n < nrecv_boxes; ++n) {
+            const int* p = recvbuf.data() + n*nints;
+            const Box b = amrex::convert(Box(IntVect(p), IntVect(p+AMREX_SPACEDIM), m_typ),
+                                         near.ixType());
+            for (const auto& iv : pshifts) {
+                if (nearba.intersects(b-iv, ng)) {
+                    order.push_back(n);
+                    break;
+                }
+            }
+        }
+    }
+
+    // The received boxes in the order of their global indices, so that the
+    // result does not depend on the order of the messages.
+    const int nremote = order.size();
+    std::sort(order.begin(), order.end(), [&] (int a, int b) {
+        return recvbuf[a*nints+nints-1] < recvbuf[b*nints+nints-1];
+    });
+
+    Neighborhood nbh;
+    BoxList bl(m_typ);
+    bl.reserve(nlocal+nremote);
+    Vector<int> pmap;
+    pmap.reserve(nlocal+nremote);
+    nbh.index.reserve(nlocal+nremote);
+    for (int i = 0; i < nlocal; ++i) {
+        bl.push_back(boxes[i]);
+        pmap.push_back(myproc);
+        nbh.index.push_back(indices[i]);
+        nbh.local.push_back(i);
+    }
+    for (int n : order) {
+        const int* p = recvbuf.data() + n*nints;
+        bl.push_back(Box(IntVect(p), IntVect(p+AMREX_SPACEDIM), m_typ));
+        pmap.push_back(recvfrom[n]);
+        nbh.index.push_back(p[nints-1]);
+    }
+
+    if (bl.isNotEmpty()) {
+        nbh.ba = BoxArray(std::move(bl));
+        nbh.dm = DistributionMapping(std::move(pmap));
+    }
+
+    return nbh;
+}
+
+Long
+DistributedBoxArray::bytes () const
+{
+    return m_nbh.bytes() + amrex::bytesOf(m_keys) + amrex::bytesOf(m_ranks);
+}
+
+}
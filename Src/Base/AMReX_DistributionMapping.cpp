@@ -20,6 +20,7 @@
 #include <numeric>
 #include <string>
 #include <cstring>
+#include <cstdint>
 #include <iomanip>
 
 namespace {
@@ -893,6 +894,7 @@ namespace
         int     m_box;
         IntVect m_idx;
         Real    m_vol;
+        std::uint64_t m_key = 0;
 
         static int MaxPower;
     };
@@ -926,6 +928,52 @@ SFCToken::Compare::operator () (const SFCToken& lhs,
     return false;
 }
 
+//
+// Put the tokens in Morton order.  If the indices are nonnegative and
+// their bits fit in 64 bits, the bits of each token are interleaved once
+// into a key, in the order in which SFCToken::Compare looks at them.
+// Comparing the keys then gives the same results, so std::sort gives the
+// same order, without dividing the indices in every comparison.
+//
+static
+void
+SortSFCTokens (std::vector<SFCToken>& tokens)
+{
+    const int m = SFCToken::MaxPower;
+    bool use_key = (m*AMREX_SPACEDIM <= 64);
+    for (const SFCToken& tok : tokens) {
+        if (!tok.m_idx.allGE(IntVect::TheZeroVector())) {
+            use_key = false;
+            break;
+        }
+    }
+
+    if (use_key)
+    {
+        const int N = tokens.size();
+#ifdef _OPENMP
+#pragma omp parallel for if (N > 4096)
+#endif
+        for (int n = 0; n < N; ++n)
+        {
+            SFCToken& tok = tokens[n];
+            std::uint64_t key = 0;
+            for (int i = m-1; i >= 0; --i) {
+                for (int j = AMREX_SPACEDIM-1; j >= 0; --j) {
+                    key = (key << 1) | ((tok.m_idx[j] >> i) & 1);
+                }
+            }
+            tok.m_key = key;
+        }
+        std::sort(tokens.begin(), tokens.end(),
+                  [] (const SFCToken& lhs, const SFCToken& rhs) { return lhs.m_key < rhs.m_key; });
+    }
+    else
+    {
+        std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    }
+}
+
 static
 void
 Distribute (const std::vector<SFCToken>&     tokens,
@@ -1077,7 +1125,7 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
     //
     // Put'm in Morton space filling curve order.
     //
-    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    SortSFCTokens(tokens);
     //
     // Split'm up as equitably as possible per team.
     //
@@ -1341,7 +1389,7 @@ DistributionMapping::RRSFCDoIt (const BoxArray&          boxes,
     //
     // Put'm in Morton space filling curve order.
     //
-    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    SortSFCTokens(tokens);
 
     Vector<int> ord;
 
@@ -1855,7 +1903,7 @@ DistributionMapping::makeSFC (const BoxArray& ba, bool use_box_vol, const int np
     //
     // Put'm in Morton space filling curve order.
     //
-    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    SortSFCTokens(tokens);
 
     Real volper;
     volper = vol_sum / nprocs;
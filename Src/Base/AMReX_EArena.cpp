@@ -3,6 +3,7 @@
 #include <cstring>
 
 #include <AMReX_EArena.H>
+#include <AMReX_MemSites.H>
 #include <AMReX_BLassert.H>
 #include <AMReX_Gpu.H>
 
@@ -75,12 +76,17 @@ EArena::alloc (std::size_t nbytes)
     }
 
     AMREX_ASSERT(vp != nullptr);
+
+    if (MemSites::Enabled()) MemSites::Alloc(this, vp, nbytes);
+
     return vp;
 }
 
 void
 EArena::free (void* vp)
 {
+    if (MemSites::Enabled()) MemSites::Free(vp);
+
     std::lock_guard<std::mutex> lock(earena_mutex);
     if (vp == nullptr) return;
 
@@ -1,13 +1,18 @@
 
 #include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
 #include <AMReX_FabArrayBase.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Utility.H>
 #include <AMReX_Geometry.H>
 #include <AMReX_FArrayBox.H>
+#include <AMReX_NFiles.H>
 
 #include <AMReX_BArena.H>
 #include <AMReX_CArena.H>
+#include <AMReX_MemSites.H>
 
 #ifdef AMREX_MEM_PROFILING
 #include <AMReX_MemProfiler.H>
@@ -72,6 +77,12 @@ std::map<FabArrayBase::BDKey, int> FabArrayBase::m_BD_count;
 FabArrayBase::FabArrayStats        FabArrayBase::m_FA_stats;
 
 std::map<std::string,FabArrayBase::meminfo> FabArrayBase::m_mem_usage;
+FabArrayBase::CommCounts FabArrayBase::m_comm_counts;
+bool                                        FabArrayBase::m_comm_record = false;
+std::string                                 FabArrayBase::m_comm_record_file;
+int                                         FabArrayBase::m_comm_record_max = 100000;
+bool                                        FabArrayBase::m_comm_record_full = false;
+Vector<FabArrayBase::CommRecord>            FabArrayBase::m_comm_records;
 std::vector<std::string>                    FabArrayBase::m_region_tag;
 
 namespace
@@ -116,6 +127,15 @@ FabArrayBase::Initialize ()
         MaxComp = 1;
     }
 
+    m_comm_record = false;
+    m_comm_record_file = "comm_pattern";
+    m_comm_record_max = 100000;
+    m_comm_record_full = false;
+    m_comm_records.clear();
+    pp.query("comm_record", m_comm_record);
+    pp.query("comm_record_file", m_comm_record_file);
+    pp.query("comm_record_max", m_comm_record_max);
+
     if (ParallelDescriptor::UseGpuAwareMpi()) {
         the_fa_arena = The_Device_Arena();
     } else {
@@ -216,6 +236,8 @@ FabArrayBase::clear ()
     indexArray.clear();
     ownership.clear();
     m_bdkey = BDKey();
+    m_skipped.reset();
+    m_skipped_tile_array.clear();
 }
 
 Box
@@ -249,6 +271,9 @@ FabArrayBase::CPC::bytes () const
     if (m_RcvTags)
 	cnt += FabArrayBase::bytesOfMapOfCopyComTagContainers(*m_RcvTags);
 
+    if (m_CovTags)
+	cnt += amrex::bytesOf(*m_CovTags);
+
     return cnt;
 }
 
@@ -266,6 +291,9 @@ FabArrayBase::FB::bytes () const
     if (m_RcvTags)
 	cnt += FabArrayBase::bytesOfMapOfCopyComTagContainers(*m_RcvTags);
 
+    if (m_CovTags)
+	cnt += amrex::bytesOf(*m_CovTags);
+
     return cnt;
 }
 
@@ -280,6 +308,63 @@ FabArrayBase::TileArray::bytes () const
 	+ (amrex::bytesOf(this->tileArray)         - sizeof(this->tileArray));
 }
 
+void
+FabArrayBase::removeSkippedTags (CommMetaData& cmd, const FabArrayBase& dstfa,
+                                 const FabArrayBase& srcfa, CopyComTagsContainer* covtags)
+{
+    auto skipped = [&] (const CopyComTag& tag) -> bool {
+        return dstfa.isSkipped(tag.dstIndex) || srcfa.isSkipped(tag.srcIndex);
+    };
+
+    if (covtags) {
+        auto covered = [&] (const CopyComTag& tag) -> bool {
+            return !dstfa.isSkipped(tag.dstIndex) && srcfa.isSkipped(tag.srcIndex);
+        };
+        std::copy_if(cmd.m_LocTags->begin(), cmd.m_LocTags->end(),
+                     std::back_inserter(*covtags), covered);
+        for (auto const& kv : *cmd.m_RcvTags) {
+            std::copy_if(kv.second.begin(), kv.second.end(),
+                         std::back_inserter(*covtags), covered);
+        }
+    }
+
+    auto& loc = *cmd.m_LocTags;
+    loc.erase(std::remove_if(loc.begin(), loc.end(), skipped), loc.end());
+
+    for (auto* tags : {cmd.m_SndTags.get(), cmd.m_RcvTags.get()}) {
+        for (auto it = tags->begin(); it != tags->end(); ) {
+            auto& v = it->second;
+            v.erase(std::remove_if(v.begin(), v.end(), skipped), v.end());
+            if (v.empty()) {
+                it = tags->erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void
+FabArrayBase::remapTagIndices (CommMetaData& cmd, const Vector<int>& dstidx,
+                               const Vector<int>& srcidx)
+{
+    for (auto& tag : *cmd.m_LocTags) {
+        tag.dstIndex = dstidx[tag.dstIndex];
+        tag.srcIndex = srcidx[tag.srcIndex];
+    }
+
+    for (auto* tags : {cmd.m_SndTags.get(), cmd.m_RcvTags.get()}) {
+        for (auto& kv : *tags) {
+            for (auto& tag : kv.second) {
+                tag.dstIndex = dstidx[tag.dstIndex];
+                tag.srcIndex = srcidx[tag.srcIndex];
+            }
+            // We need to fix the order so that the send and recv processes match.
+            std::sort(kv.second.begin(), kv.second.end());
+        }
+    }
+}
+
 //
 // Stuff used for copy() caching.
 //
@@ -294,10 +379,16 @@ FabArrayBase::CPC::CPC (const FabArrayBase& dstfa, const IntVect& dstng,
       m_period(period),
       m_srcba(srcfa.boxArray()), 
       m_dstba(dstfa.boxArray()),
+      m_srcskip_id(srcfa.m_skipped ? srcfa.m_skipped->id : 0),
+      m_dstskip_id(dstfa.m_skipped ? dstfa.m_skipped->id : 0),
       m_nuse(0)
 {
     this->define(m_dstba, dstfa.DistributionMap(), dstfa.IndexArray(), 
 		 m_srcba, srcfa.DistributionMap(), srcfa.IndexArray());
+    if (srcfa.hasSkippedBoxes() || dstfa.hasSkippedBoxes()) {
+        if (srcfa.hasSkippedBoxes()) m_CovTags.reset(new CopyComTag::CopyComTagsContainer);
+        removeSkippedTags(*this, dstfa, srcfa, m_CovTags.get());
+    }
 }
 
 FabArrayBase::CPC::CPC (const BoxArray& dstba, const DistributionMapping& dstdm, 
@@ -317,6 +408,37 @@ FabArrayBase::CPC::CPC (const BoxArray& dstba, const DistributionMapping& dstdm,
     this->define(dstba, dstdm, dstidx, srcba, srcdm, srcidx, myproc);
 }
 
+FabArrayBase::CPC::CPC (const DistributedBoxArray& dstdba, const IntVect& dstng,
+                        const DistributedBoxArray& srcdba, const IntVect& srcng,
+                        const Periodicity& period)
+    : m_srcbdk(),
+      m_dstbdk(),
+      m_srcng(srcng),
+      m_dstng(dstng),
+      m_period(period),
+      m_nuse(0)
+{
+    BL_PROFILE("FabArrayBase::CPC::CPC(dba)");
+
+    // The destination boxes near the local source boxes and the other way
+    // around.  Both are needed to build the send and the recv tags.
+    const IntVect ng = dstng + srcng;
+    const DistributedBoxArray::Neighborhood dstnbh = dstdba.neighborhood(srcdba, ng, period);
+    const DistributedBoxArray::Neighborhood srcnbh = srcdba.neighborhood(dstdba, ng, period);
+
+    m_dstba = dstnbh.ba;
+    m_srcba = srcnbh.ba;
+
+    if (m_dstba.empty() || m_srcba.empty()) {
+        m_LocTags.reset(new CopyComTag::CopyComTagsContainer);
+        m_SndTags.reset(new CopyComTag::MapOfCopyComTagContainers);
+        m_RcvTags.reset(new CopyComTag::MapOfCopyComTagContainers);
+    } else {
+        this->define(m_dstba, dstnbh.dm, dstnbh.local, m_srcba, srcnbh.dm, srcnbh.local);
+        remapTagIndices(*this, dstnbh.index, srcnbh.index);
+    }
+}
+
 FabArrayBase::CPC::~CPC ()
 {}
 
@@ -343,20 +465,31 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
 	const int nlocal_dst = imap_dst.size();
 	const IntVect& ng_dst = m_dstng;
 
-	std::vector< std::pair<int,Box> > isects;
-
 	const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
+	const int nshifts = pshifts.size();
+
+	// The queries of all local boxes are done at once in parallel.
+	Vector<Box> query;
+	Vector<std::vector< std::pair<int,Box> > > isects_all;
+
+	query.reserve(nlocal_src*nshifts);
+	for (int i = 0; i < nlocal_src; ++i) {
+	    const Box& bx_src = amrex::grow(ba_src[imap_src[i]], ng_src);
+	    for (const auto& iv : pshifts) {
+		query.push_back(bx_src+iv);
+	    }
+	}
+	ba_dst.intersections(query, isects_all, ng_dst);
 
 	auto& send_tags = *m_SndTags;
 	
 	for (int i = 0; i < nlocal_src; ++i)
 	{
 	    const int   k_src = imap_src[i];
-	    const Box& bx_src = amrex::grow(ba_src[k_src], ng_src);
 
 	    for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
 	    {
-		ba_dst.intersections(bx_src+(*pit), isects, false, ng_dst);
+		const auto& isects = isects_all[i*nshifts + (pit-pshifts.begin())];
 	    
 		for (int j = 0, M = isects.size(); j < M; ++j)
 		{
@@ -394,6 +527,16 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
         m_threadsafe_loc = not check_local;
         m_threadsafe_rcv = not check_remote;
 
+	query.clear();
+	query.reserve(nlocal_dst*nshifts);
+	for (int i = 0; i < nlocal_dst; ++i) {
+	    const Box& bx_dst = amrex::grow(ba_dst[imap_dst[i]], ng_dst);
+	    for (const auto& iv : pshifts) {
+		query.push_back(bx_dst+iv);
+	    }
+	}
+	ba_src.intersections(query, isects_all, ng_src);
+
 	for (int i = 0; i < nlocal_dst; ++i)
 	{
 	    const int   k_dst = imap_dst[i];
@@ -411,7 +554,7 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
 	    
 	    for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
 	    {
-		ba_src.intersections(bx_dst+(*pit), isects, false, ng_src);
+		const auto& isects = isects_all[i*nshifts + (pit-pshifts.begin())];
 	    
 		for (int j = 0, M = isects.size(); j < M; ++j)
 		{
@@ -588,7 +731,9 @@ FabArrayBase::getCPC (const IntVect& dstng, const FabArrayBase& src, const IntVe
 	    it->second->m_dstbdk == dstkey &&
 	    it->second->m_period == period &&
 	    it->second->m_srcba  == src.boxArray() &&
-	    it->second->m_dstba  == boxArray())
+	    it->second->m_dstba  == boxArray() &&
+	    it->second->m_srcskip_id == (src.m_skipped ? src.m_skipped->id : 0) &&
+	    it->second->m_dstskip_id == (    m_skipped ?     m_skipped->id : 0))
 	{
 	    ++(it->second->m_nuse);
 	    m_CPC_stats.recordUse();
@@ -625,6 +770,7 @@ FabArrayBase::FB::FB (const FabArrayBase& fa, const IntVect& nghost,
     : m_typ(fa.boxArray().ixType()), m_crse_ratio(fa.boxArray().crseRatio()),
       m_ngrow(nghost), m_cross(cross),
       m_epo(enforce_periodicity_only), m_period(period),
+      m_skip_id(fa.m_skipped ? fa.m_skipped->id : 0),
       m_nuse(0)
 {
     BL_PROFILE("FabArrayBase::FB::FB()");
@@ -638,38 +784,79 @@ FabArrayBase::FB::FB (const FabArrayBase& fa, const IntVect& nghost,
 	    BL_ASSERT(m_cross==false);
 	    define_epo(fa);
 	} else {
-	    define_fb(fa);
+	    define_fb(fa.boxArray(), fa.DistributionMap(), fa.IndexArray());
 	}
+        if (fa.hasSkippedBoxes()) {
+            m_CovTags.reset(new CopyComTag::CopyComTagsContainer);
+            removeSkippedTags(*this, fa, fa, m_CovTags.get());
+        }
+    }
+}
+
+FabArrayBase::FB::FB (const DistributedBoxArray& dba, const IntVect& nghost,
+                      bool cross, const Periodicity& period)
+    : m_typ(dba.ixType()), m_crse_ratio(IntVect::TheUnitVector()),
+      m_ngrow(nghost), m_cross(cross),
+      m_epo(false), m_period(period),
+      m_nuse(0)
+{
+    BL_PROFILE("FabArrayBase::FB::FB(dba)");
+
+    m_LocTags.reset(new CopyComTag::CopyComTagsContainer);
+    m_SndTags.reset(new CopyComTag::MapOfCopyComTagContainers);
+    m_RcvTags.reset(new CopyComTag::MapOfCopyComTagContainers);
+
+    // The neighbors kept by dba are enough unless more ghost cells or a
+    // different periodicity are asked for.
+    DistributedBoxArray::Neighborhood tmp;
+    const bool use_kept = nghost.allLE(dba.nGrow()) && period == dba.period();
+    if (!use_kept) {
+        tmp = dba.neighborhood(dba, nghost, period);
+    }
+    const DistributedBoxArray::Neighborhood& nbh = (use_kept) ? dba.neighborhood() : tmp;
+
+    if (!nbh.local.empty()) {
+        define_fb(nbh.ba, nbh.dm, nbh.local);
+        remapTagIndices(*this, nbh.index, nbh.index);
     }
 }
 
 void
-FabArrayBase::FB::define_fb(const FabArrayBase& fa)
+FabArrayBase::FB::define_fb (const BoxArray& ba, const DistributionMapping& dm,
+                             const Vector<int>& imap)
 {
     const int                  MyProc   = ParallelDescriptor::MyProc();
-    const BoxArray&            ba       = fa.boxArray();
-    const DistributionMapping& dm       = fa.DistributionMap();
-    const Vector<int>&         imap     = fa.IndexArray();
 
     // For local copy, all workers in the same team will have the identical copy of tags
     // so that they can share work.  But for remote communication, they are all different.
     
     const int nlocal = imap.size();
     const IntVect& ng = m_ngrow;
-    std::vector< std::pair<int,Box> > isects;
     
     const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
+    const int nshifts = pshifts.size();
+
+    // The queries of all local boxes are done at once in parallel.
+    Vector<Box> query;
+    Vector<std::vector< std::pair<int,Box> > > isects_all;
+
+    query.reserve(nlocal*nshifts);
+    for (int i = 0; i < nlocal; ++i) {
+	for (const auto& iv : pshifts) {
+	    query.push_back(ba[imap[i]]+iv);
+	}
+    }
+    ba.intersections(query, isects_all, ng);
     
     auto& send_tags = *m_SndTags;
     
     for (int i = 0; i < nlocal; ++i)
     {
 	const int ksnd = imap[i];
-	const Box& vbx = ba[ksnd];
 	
 	for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
 	{
-	    ba.intersections(vbx+(*pit), isects, false, ng);
+	    const auto& isects = isects_all[i*nshifts + (pit-pshifts.cbegin())];
 
 	    for (int j = 0, M = isects.size(); j < M; ++j)
 	    {
@@ -709,6 +896,16 @@ FabArrayBase::FB::define_fb(const FabArrayBase& fa)
     m_threadsafe_loc = not check_local;
     m_threadsafe_rcv = not check_remote;
 
+    query.clear();
+    query.reserve(nlocal*nshifts);
+    for (int i = 0; i < nlocal; ++i) {
+	const Box& bxrcv = amrex::grow(ba[imap[i]], ng);
+	for (const auto& iv : pshifts) {
+	    query.push_back(bxrcv+iv);
+	}
+    }
+    ba.intersections(query, isects_all);
+
     for (int i = 0; i < nlocal; ++i)
     {
 	const int   krcv = imap[i];
@@ -727,7 +924,7 @@ FabArrayBase::FB::define_fb(const FabArrayBase& fa)
 	
 	for (auto pit=pshifts.cbegin(); pit!=pshifts.cend(); ++pit)
 	{
-	    ba.intersections(bxrcv+(*pit), isects);
+	    const auto& isects = isects_all[i*nshifts + (pit-pshifts.cbegin())];
 
 	    for (int j = 0, M = isects.size(); j < M; ++j)
 	    {
@@ -1052,7 +1249,8 @@ FabArrayBase::getFB (const IntVect& nghost, const Periodicity& period,
 	    it->second->m_ngrow      == nghost                   &&
 	    it->second->m_cross      == cross                    &&
 	    it->second->m_epo        == enforce_periodicity_only &&
-	    it->second->m_period     == period              )
+	    it->second->m_period     == period                   &&
+	    it->second->m_skip_id    == (m_skipped ? m_skipped->id : 0))
 	{
 	    ++(it->second->m_nuse);
 	    m_FBC_stats.recordUse();
@@ -1159,9 +1357,21 @@ FabArrayBase::FPinfo::bytes () const
     Long cnt = sizeof(FabArrayBase::FPinfo);
     cnt += sizeof(Box) * (ba_crse_patch.capacity() + dst_boxes.capacity());
     cnt += sizeof(int) * (dm_crse_patch.capacity() + dst_idxs.capacity());
+    cnt += mf_crse_patch_bytes;
     return cnt;
 }
 
+void
+FabArrayBase::FPinfo::setCrsePatch (FabArrayBase* mf, Long nbytes) const
+{
+#ifdef AMREX_MEM_PROFILING
+    m_FPinfo_stats.bytes += nbytes - mf_crse_patch_bytes;
+    m_FPinfo_stats.bytes_hwm = std::max(m_FPinfo_stats.bytes_hwm, m_FPinfo_stats.bytes);
+#endif
+    mf_crse_patch.reset(mf);
+    mf_crse_patch_bytes = (mf) ? nbytes : 0L;
+}
+
 const FabArrayBase::FPinfo&
 FabArrayBase::TheFPinfo (const FabArrayBase& srcfa,
                          const FabArrayBase& dstfa,
@@ -1240,6 +1450,7 @@ FabArrayBase::flushFPinfo (bool no_assertion)
 	    }
 	} 
 
+	it->second->setCrsePatch(nullptr, 0L);
 #ifdef AMREX_MEM_PROFILING
 	m_FPinfo_stats.bytes -= it->second->bytes();
 #endif
@@ -1390,6 +1601,11 @@ FabArrayBase::flushCFinfo (bool no_assertion)
 void
 FabArrayBase::Finalize ()
 {
+    if (m_comm_record) {
+        writeCommRecords();
+        m_comm_record = false;
+    }
+
     FabArrayBase::flushFBCache();
     FabArrayBase::flushCPCache();
     FabArrayBase::flushTileArrayCache();
@@ -1446,6 +1662,21 @@ FabArrayBase::getTileArray (const IntVect& tilesize) const
 					     m_TAC_stats.bytes);
 #endif
 	}
+        if (m_skipped) {
+            TileArray* ps = &m_skipped_tile_array[std::pair<IntVect,IntVect>(tilesize,crse_ratio)];
+            if (ps->nuse == -1) {
+                for (int i = 0, N = p->indexMap.size(); i < N; ++i) {
+                    if (m_skipped->skip[p->indexMap[i]]) continue;
+                    ps->indexMap.push_back(p->indexMap[i]);
+                    ps->localIndexMap.push_back(p->localIndexMap[i]);
+                    ps->localTileIndexMap.push_back(p->localTileIndexMap[i]);
+                    ps->numLocalTiles.push_back(p->numLocalTiles[i]);
+                    ps->tileArray.push_back(p->tileArray[i]);
+                }
+                ps->nuse = 0;
+            }
+            p = ps;
+        }
 #ifdef _OPENMP
 #pragma omp master
 #endif
@@ -1775,18 +2006,21 @@ void
 FabArrayBase::pushRegionTag (const char* t)
 {
     m_region_tag.emplace_back(t);
+    if (MemSites::Enabled()) MemSites::PushSite(m_region_tag.back());
 }
 
 void
 FabArrayBase::pushRegionTag (std::string t)
 {
     m_region_tag.emplace_back(std::move(t));
+    if (MemSites::Enabled()) MemSites::PushSite(m_region_tag.back());
 }
 
 void
 FabArrayBase::popRegionTag ()
 {
     m_region_tag.pop_back();
+    if (MemSites::Enabled()) MemSites::PopSite();
 }
 
 bool
@@ -1807,4 +2041,129 @@ FabArrayBase::is_cell_centered () const noexcept
     return boxArray().ixType().cellCentered();
 }
 
+int
+FabArrayBase::beginCommRecord (int kind, int tag, int ncomp)
+{
+    if (!m_comm_record) return -1;
+    if (static_cast<int>(m_comm_records.size()) >= m_comm_record_max) {
+        if (!m_comm_record_full) {
+            m_comm_record_full = true;
+            amrex::Warning("FabArrayBase: process " + std::to_string(ParallelDescriptor::MyProc())
+                           + " has " + std::to_string(m_comm_record_max)
+                           + " communication records and records no more calls;"
+                           + " raise fabarray.comm_record_max to keep them");
+        }
+        return -1;
+    }
+    CommRecord r;
+    r.kind = kind;
+    r.tag = tag;
+    r.ncomp = ncomp;
+    r.t0 = amrex::second();
+    r.dt = 0.0;
+    m_comm_records.push_back(std::move(r));
+    return m_comm_records.size()-1;
+}
+
+void
+FabArrayBase::addCommRecord (int irec,
+                             Vector<int> const& send_rank, Vector<std::size_t> const& send_size,
+                             Vector<int> const& recv_rank, Vector<std::size_t> const& recv_size)
+{
+    if (irec < 0) return;
+    CommRecord& r = m_comm_records[irec];
+    // The passes of a ParallelCopy have the same peers in the same order.
+    if (r.send_rank.empty() && r.recv_rank.empty()) {
+        r.send_rank = send_rank;
+        r.send_bytes.assign(send_rank.size(), 0L);
+        r.recv_rank = recv_rank;
+        r.recv_bytes.assign(recv_rank.size(), 0L);
+    }
+    for (int i = 0, N = std::min(r.send_bytes.size(), send_size.size()); i < N; ++i) {
+        r.send_bytes[i] += send_size[i];
+    }
+    for (int i = 0, N = std::min(r.recv_bytes.size(), recv_size.size()); i < N; ++i) {
+        r.recv_bytes[i] += recv_size[i];
+    }
+}
+
+void
+FabArrayBase::endCommRecord (int irec)
+{
+    if (irec < 0) return;
+    CommRecord& r = m_comm_records[irec];
+    r.dt = amrex::second() - r.t0;
+}
+
+void
+FabArrayBase::writeCommRecords ()
+{
+    BL_PROFILE("FabArrayBase::writeCommRecords()");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    const int nfiles = std::max(1, std::min(nprocs, 64));
+    const std::string& dir = m_comm_record_file;
+    const std::string prefix = "Data_";
+
+    amrex::UtilCreateCleanDirectory(dir, true);
+
+    // Each line is "E kind tag ncomp t0 dt nsends nrecvs", followed by the
+    // lines "S rank bytes ..." and "R rank bytes ...".  Records without
+    // messages on this process are skipped.
+    Long seekpos = 0;
+    Long nrecords = 0;
+    for (NFilesIter nfi(nfiles, dir + "/" + prefix, false, true); nfi.ReadyToWrite(); ++nfi)
+    {
+        std::ostream& os = nfi.Stream();
+        seekpos = nfi.SeekPos();
+        os << std::setprecision(9);
+        for (auto const& r : m_comm_records)
+        {
+            const int ns = r.send_bytes.size() - std::count(r.send_bytes.begin(), r.send_bytes.end(), 0L);
+            const int nr = r.recv_bytes.size() - std::count(r.recv_bytes.begin(), r.recv_bytes.end(), 0L);
+            if (ns == 0 && nr == 0) continue;
+            ++nrecords;
+            os << "E " << r.kind << " " << r.tag << " " << r.ncomp << " "
+               << r.t0 << " " << r.dt << " " << ns << " " << nr << "\nS";
+            for (int i = 0, N = r.send_bytes.size(); i < N; ++i) {
+                if (r.send_bytes[i] > 0) os << " " << r.send_rank[i] << " " << r.send_bytes[i];
+            }
+            os << "\nR";
+            for (int i = 0, N = r.recv_bytes.size(); i < N; ++i) {
+                if (r.recv_bytes[i] > 0) os << " " << r.recv_rank[i] << " " << r.recv_bytes[i];
+            }
+            os << "\n";
+        }
+        os.flush();
+    }
+
+    Vector<Long> info{seekpos, nrecords};
+    Vector<Long> allinfo(ParallelDescriptor::IOProcessor() ? 2*nprocs : 1);
+    ParallelDescriptor::Gather(info.dataPtr(), 2, allinfo.dataPtr(), 2, ioproc);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const std::string hname = dir + "/Header";
+        std::ofstream hf(hname.c_str(), std::ios::out | std::ios::trunc);
+        if (!hf.good()) {
+            amrex::FileOpenFailed(hname);
+        }
+        Long ntotal = 0;
+        hf << "CommPatternVersion 1\n";
+        hf << "NProcs " << nprocs << "\n";
+        hf << "MaxComp " << MaxComp << "\n";
+        for (int p = 0; p < nprocs; ++p) {
+            hf << "Rank " << p << " " << NFilesIter::FileName(nfiles, prefix, p, false)
+               << " " << allinfo[2*p] << " " << allinfo[2*p+1] << "\n";
+            ntotal += allinfo[2*p+1];
+        }
+        amrex::Print() << "FabArrayBase: wrote " << ntotal << " communication records to "
+                       << dir << "\n";
+    }
+
+    m_comm_records.clear();
+}
+
+
 }
@@ -0,0 +1,204 @@
+#include <AMReX_MFCostSched.H>
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+namespace amrex {
+
+bool MFCostSched::s_enabled = true;
+int  MFCostSched::s_verbose = 0;
+
+Vector<MFCostSched::Loop>  MFCostSched::s_loops;
+std::map<std::string,int>  MFCostSched::s_loop_ids;
+
+int                                 MFCostSched::s_loop     = -1;
+int                                 MFCostSched::s_nthreads = 1;
+Vector<int>                         MFCostSched::s_order;
+Vector<double>                      MFCostSched::s_cost;
+std::unique_ptr<MFCostSched::Deque[]> MFCostSched::s_deques;
+Vector<double>                      MFCostSched::s_tile_time;
+Vector<double>                      MFCostSched::s_done;
+Long                                MFCostSched::s_nsteals  = 0L;
+double                              MFCostSched::s_t0       = 0.0;
+
+void
+MFCostSched::Initialize ()
+{
+    s_enabled = true;
+    s_verbose = 0;
+    s_loops.clear();
+    s_loop_ids.clear();
+
+    ParmParse pp("mfcostsched");
+    pp.query("enable", s_enabled);
+    pp.query("verbose", s_verbose);
+
+    amrex::ExecOnFinalize(MFCostSched::Finalize);
+}
+
+void
+MFCostSched::Finalize ()
+{
+    if (s_verbose > 0 && !s_loops.empty()) Report();
+    s_loops.clear();
+    s_loop_ids.clear();
+    s_deques.reset();
+}
+
+void
+MFCostSched::Begin (const std::string& name, const FabArrayBase& fa,
+                    const Vector<int>& index_map, const Vector<int>& local_index_map,
+                    const Vector<Box>& tile_array, const Vector<Real>* box_costs,
+                    int nthreads)
+{
+    auto it = s_loop_ids.find(name);
+    if (it == s_loop_ids.end()) {
+        it = s_loop_ids.insert(std::make_pair(name, static_cast<int>(s_loops.size()))).first;
+        s_loops.push_back(Loop{name, {}, 0L, 0L, 0.0, 0.0, nthreads});
+    }
+    s_loop = it->second;
+    Loop& loop = s_loops[s_loop];
+    loop.nthreads = nthreads;
+
+    const int ntiles = index_map.size();
+    if (static_cast<int>(loop.costs.size()) != ntiles) loop.costs.clear();
+
+    s_cost.resize(ntiles);
+    for (int t = 0; t < ntiles; ++t)
+    {
+        if (box_costs) {
+            const Box& vbx = fa.box(index_map[t]);
+            s_cost[t] = (*box_costs)[local_index_map[t]]
+                * static_cast<double>(tile_array[t].numPts()) / vbx.numPts();
+        } else if (!loop.costs.empty()) {
+            s_cost[t] = loop.costs[t];
+        } else {
+            s_cost[t] = tile_array[t].numPts();
+        }
+    }
+
+    // Each thread gets its tiles of the static schedule, longest first.
+    s_nthreads = nthreads;
+    s_order.resize(ntiles);
+    std::iota(s_order.begin(), s_order.end(), 0);
+    s_deques.reset(new Deque[nthreads]);
+    const int nr   = ntiles / nthreads;
+    const int nlft = ntiles - nr * nthreads;
+    for (int tid = 0; tid < nthreads; ++tid)
+    {
+        Deque& d = s_deques[tid];
+        d.head = (tid < nlft) ? tid*(nr+1) : tid*nr + nlft;
+        d.tail = d.head + ((tid < nlft) ? nr+1 : nr);
+        std::stable_sort(s_order.begin()+d.head, s_order.begin()+d.tail,
+                         [] (int a, int b) { return s_cost[a] > s_cost[b]; });
+        d.cost = 0.0;
+        for (int i = d.head; i < d.tail; ++i) d.cost += s_cost[s_order[i]];
+    }
+
+    s_tile_time.assign(ntiles, -1.0);
+    s_done.assign(nthreads, 0.0);
+    s_nsteals = 0L;
+    s_t0 = amrex::second();
+}
+
+int
+MFCostSched::Next (int tid)
+{
+    {
+        Deque& d = s_deques[tid];
+        std::lock_guard<std::mutex> lock(d.m);
+        if (d.head < d.tail) {
+            const int t = s_order[d.head++];
+            d.cost -= s_cost[t];
+            return t;
+        }
+    }
+
+    for (;;)
+    {
+        int victim = -1;
+        double most = 0.0;
+        for (int i = 1; i < s_nthreads; ++i)
+        {
+            const int v = (tid + i) % s_nthreads;
+            Deque& d = s_deques[v];
+            std::lock_guard<std::mutex> lock(d.m);
+            if (d.head < d.tail && (victim < 0 || d.cost > most)) {
+                victim = v;
+                most = d.cost;
+            }
+        }
+        if (victim < 0) return -1;
+
+        Deque& d = s_deques[victim];
+        std::lock_guard<std::mutex> lock(d.m);
+        if (d.head < d.tail) {
+            const int t = s_order[--d.tail];
+            d.cost -= s_cost[t];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+            ++s_nsteals;
+            return t;
+        }
+    }
+}
+
+void
+MFCostSched::ThreadDone (int tid) noexcept
+{
+    s_done[tid] = amrex::second();
+}
+
+void
+MFCostSched::End ()
+{
+    const double t1 = amrex::second();
+    double tend = 0.0;
+    for (double& t : s_done) {
+        if (t <= 0.0) t = t1;  // the loop was left early
+        tend = std::max(tend, t);
+    }
+
+    Loop& loop = s_loops[s_loop];
+    ++loop.ncalls;
+    loop.nsteals += s_nsteals;
+    loop.time += tend - s_t0;
+    for (double t : s_done) loop.idle += tend - t;
+
+    // The measured times are the costs of the next call.
+    const int ntiles = s_tile_time.size();
+    loop.costs.resize(ntiles, 0.0);
+    for (int t = 0; t < ntiles; ++t) {
+        if (s_tile_time[t] >= 0.0) loop.costs[t] = s_tile_time[t];
+    }
+}
+
+void
+MFCostSched::Report ()
+{
+    std::ostringstream ss;
+    ss << "\nMFCostSched: the cost-aware loops of process " << ParallelDescriptor::MyProc() << "\n"
+       << std::left << std::setw(24) << "  loop" << std::right << std::setw(8) << "threads"
+       << std::setw(10) << "calls" << std::setw(12) << "time (s)"
+       << std::setw(12) << "idle (%)" << std::setw(12) << "steals" << "\n";
+    for (auto const& loop : s_loops)
+    {
+        const double idle = (loop.time > 0.0) ? 100.0*loop.idle/(loop.time*loop.nthreads) : 0.0;
+        ss << "  " << std::left << std::setw(22) << loop.name << std::right
+           << std::setw(8) << loop.nthreads << std::setw(10) << loop.ncalls
+           << std::scientific << std::setprecision(3) << std::setw(12) << loop.time
+           << std::fixed << std::setprecision(2) << std::setw(12) << idle
+           << std::setw(12) << loop.nsteals << "\n";
+    }
+    amrex::Print() << ss.str() << std::endl;
+}
+
+}
@@ -2,6 +2,9 @@
 #include <AMReX_MFIter.H>
 #include <AMReX_FabArray.H>
 #include <AMReX_FArrayBox.H>
+#include <AMReX_MFTuner.H>
+#include <AMReX_MFCostSched.H>
+#include <AMReX_Utility.H>
 
 namespace amrex {
 
@@ -162,16 +165,25 @@ MFIter::MFIter (const BoxArray& ba, const DistributionMapping& dm, const MFItInf
     {
         m_fa->addThisBD();
     }
+    tune(info);
+
 #ifdef _OPENMP
-    if (dynamic) {
+    if (!info.cost_name.empty() && omp_get_num_threads() > 1) {
+        stealing = MFCostSched::Enabled();
+        dynamic = !stealing;
+        guided = false;
+    }
+    if (dynamic || guided) {
 #pragma omp barrier
 #pragma omp single
-        nextDynamicIndex = omp_get_num_threads();
+        nextDynamicIndex = guided ? 0 : omp_get_num_threads();
         // yes omp single has an implicit barrier and we need it because nextDynamicIndex is static.
     }
 #endif
 
     Initialize();
+
+    if (stealing) beginStealing(info);
 }
 
 MFIter::MFIter (const FabArrayBase& fabarray_, const MFItInfo& info)
@@ -192,16 +204,25 @@ MFIter::MFIter (const FabArrayBase& fabarray_, const MFItInfo& info)
     local_tile_index_map(nullptr),
     num_local_tiles(nullptr)
 {
+    tune(info);
+
 #ifdef _OPENMP
-    if (dynamic) {
+    if (!info.cost_name.empty() && omp_get_num_threads() > 1) {
+        stealing = MFCostSched::Enabled();
+        dynamic = !stealing;
+        guided = false;
+    }
+    if (dynamic || guided) {
 #pragma omp barrier
 #pragma omp single
-        nextDynamicIndex = omp_get_num_threads();
+        nextDynamicIndex = guided ? 0 : omp_get_num_threads();
         // yes omp single has an implicit barrier and we need it because nextDynamicIndex is static.
     }
 #endif
 
     Initialize();
+
+    if (stealing) beginStealing(info);
 }
 
 
@@ -234,6 +255,22 @@ MFIter::~MFIter ()
     Gpu::resetNumCallbacks();
 #endif
 
+    if (tune_trial >= 0) {
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp single
+#endif
+        MFTuner::End(tune_site, tune_trial);
+    }
+
+    if (stealing) {
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp single
+#endif
+        MFCostSched::End();
+    }
+
     if (m_fa) {
 #ifdef _OPENMP
 #pragma omp barrier
@@ -243,6 +280,34 @@ MFIter::~MFIter ()
     }
 }
 
+void
+MFIter::tune (const MFItInfo& info)
+{
+    if (info.tune_name.empty() || !MFTuner::Enabled()) return;
+#ifdef AMREX_USE_GPU
+    if (Gpu::inLaunchRegion()) return;
+#endif
+
+#ifdef _OPENMP
+    const int nthreads = omp_get_num_threads();
+#else
+    const int nthreads = 1;
+#endif
+
+    // One thread chooses and copies the choice to the others.
+    MFTuner::Choice c;
+#ifdef _OPENMP
+#pragma omp single copyprivate(c)
+#endif
+    c = MFTuner::Begin(info.tune_name, tile_size, nthreads);
+
+    tile_size  = c.tile_size;
+    dynamic    = (nthreads > 1) && (c.schedule == MFTuner::Dynamic);
+    guided     = (nthreads > 1) && (c.schedule == MFTuner::Guided);
+    tune_site  = c.site;
+    tune_trial = c.trial;
+}
+
 void 
 MFIter::Initialize ()
 {
@@ -312,6 +377,15 @@ MFIter::Initialize ()
             {
                 beginIndex = omp_get_thread_num();
             }
+            else if (guided)
+            {
+                nextGuidedChunk();
+                beginIndex = currentIndex;
+            }
+            else if (stealing)
+            {
+                // All the tiles, handed out by beginStealing and nextStolenTile.
+            }
             else
             {
                 int tid = omp_get_thread_num();
@@ -495,6 +569,15 @@ MFIter::operator++ () noexcept
 #pragma omp atomic capture
         currentIndex = nextDynamicIndex++;
     }
+    else if (guided)
+    {
+        if (++currentIndex >= chunkEnd) nextGuidedChunk();
+    }
+    else if (stealing)
+    {
+        MFCostSched::TileDone(currentIndex, amrex::second() - tile_t0);
+        nextStolenTile();
+    }
     else
 #endif
     {
@@ -531,6 +614,50 @@ MFIter::operator++ () noexcept
     }
 }
 
+// The chunks shrink with the tiles left, as with schedule(guided).
+void
+MFIter::nextGuidedChunk () noexcept
+{
+#ifdef _OPENMP
+    int next;
+#pragma omp atomic read
+    next = nextDynamicIndex;
+    const int chunk = std::max(1, (endIndex - next) / (2*omp_get_num_threads()));
+    int start;
+#pragma omp atomic capture
+    { start = nextDynamicIndex; nextDynamicIndex += chunk; }
+    currentIndex = start;
+    chunkEnd = std::min(start + chunk, endIndex);
+#endif
+}
+
+void
+MFIter::beginStealing (const MFItInfo& info)
+{
+#ifdef _OPENMP
+#pragma omp single
+    MFCostSched::Begin(info.cost_name, fabArray, *index_map, *local_index_map, *tile_array,
+                       info.box_costs, omp_get_num_threads());
+#endif
+    nextStolenTile();
+}
+
+void
+MFIter::nextStolenTile ()
+{
+#ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int t = MFCostSched::Next(tid);
+    if (t >= 0) {
+        currentIndex = t;
+    } else {
+        currentIndex = endIndex;
+        MFCostSched::ThreadDone(tid);
+    }
+    tile_t0 = amrex::second();
+#endif
+}
+
 #ifdef AMREX_USE_GPU
 Real*
 MFIter::add_reduce_value(Real* val, MFReducer r)
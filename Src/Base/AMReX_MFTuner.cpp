@@ -0,0 +1,242 @@
+#include <AMReX_MFTuner.H>
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace amrex {
+
+bool        MFTuner::s_enabled = false;
+int         MFTuner::s_ntrials = 2;
+int         MFTuner::s_verbose = 0;
+std::string MFTuner::s_file;
+Vector<IntVect> MFTuner::s_tile_sizes;
+
+Vector<MFTuner::Site> MFTuner::s_sites;
+std::map<std::pair<std::string,int>,int> MFTuner::s_site_ids;
+
+void
+MFTuner::Initialize ()
+{
+    s_enabled = false;
+    s_ntrials = 2;
+    s_verbose = 0;
+    s_file.clear();
+    s_tile_sizes.clear();
+    s_sites.clear();
+    s_site_ids.clear();
+
+    ParmParse pp("mftuner");
+    pp.query("enable", s_enabled);
+    pp.query("ntrials", s_ntrials);
+    pp.query("verbose", s_verbose);
+    pp.query("file", s_file);
+    s_ntrials = std::max(s_ntrials, 1);
+
+    Vector<int> ts;
+    pp.queryarr("tile_sizes", ts);
+    if (ts.size() % AMREX_SPACEDIM != 0) {
+        amrex::Abort("MFTuner: mftuner.tile_sizes must have AMREX_SPACEDIM numbers per tile size");
+    }
+    for (int i = 0, N = ts.size(); i < N; i += AMREX_SPACEDIM) {
+        s_tile_sizes.push_back(IntVect(AMREX_D_DECL(ts[i],ts[i+1],ts[i+2])));
+    }
+
+    if (s_enabled && !s_file.empty()) {
+        ReadFile(s_file);
+    }
+
+    amrex::ExecOnFinalize(MFTuner::Finalize);
+}
+
+void
+MFTuner::Finalize ()
+{
+    if (s_enabled)
+    {
+        if (s_verbose > 0) Report();
+        if (!s_file.empty()) WriteFile(s_file);
+    }
+    s_enabled = false;
+    s_sites.clear();
+    s_site_ids.clear();
+}
+
+const char*
+MFTuner::scheduleName (int schedule) noexcept
+{
+    switch (schedule) {
+    case Static:  return "static";
+    case Dynamic: return "dynamic";
+    case Guided:  return "guided";
+    default:      return "unknown";
+    }
+}
+
+int
+MFTuner::siteId (const std::string& name, int nthreads)
+{
+    const auto key = std::make_pair(name, nthreads);
+    auto it = s_site_ids.find(key);
+    if (it != s_site_ids.end()) return it->second;
+    const int id = s_sites.size();
+    s_sites.push_back(Site{name, nthreads, {}, {}, {}, 0, -1, 0.0});
+    s_site_ids[key] = id;
+    return id;
+}
+
+MFTuner::Choice
+MFTuner::Begin (const std::string& name, const IntVect& tilesize, int nthreads)
+{
+    const int id = siteId(name, nthreads);
+    Site& s = s_sites[id];
+
+    if (s.tile_sizes.empty())
+    {
+        if (tilesize == IntVect::TheZeroVector()) {
+            s.tile_sizes.push_back(tilesize);
+        } else if (!s_tile_sizes.empty()) {
+            s.tile_sizes = s_tile_sizes;
+        } else {
+            s.tile_sizes.push_back(tilesize);
+            for (int k : {4, 8, 16, 32}) {
+                IntVect t(k);
+                t[0] = tilesize[0];
+                if (std::find(s.tile_sizes.begin(), s.tile_sizes.end(), t) == s.tile_sizes.end()) {
+                    s.tile_sizes.push_back(t);
+                }
+            }
+        }
+        if (nthreads > 1) {
+            s.schedules = {Static, Dynamic, Guided};
+        } else {
+            s.schedules = {Static};
+        }
+        s.times.assign(s.tile_sizes.size()*s.schedules.size(),
+                       std::numeric_limits<double>::max());
+    }
+
+    const int nsched = s.schedules.size();
+    const int c = (s.chosen >= 0) ? s.chosen : s.ncalls % s.times.size();
+    Choice r;
+    r.tile_size = s.tile_sizes[c/nsched];
+    r.schedule  = s.schedules[c%nsched];
+    r.site      = id;
+    r.trial     = (s.chosen >= 0) ? -1 : c;
+
+    if (s.chosen < 0) s.t0 = amrex::second();
+    return r;
+}
+
+void
+MFTuner::End (int site, int trial)
+{
+    Site& s = s_sites[site];
+    const double dt = amrex::second() - s.t0;
+    s.times[trial] = std::min(s.times[trial], dt);
+    if (++s.ncalls >= static_cast<int>(s.times.size())*s_ntrials) {
+        choose(s);
+    }
+}
+
+void
+MFTuner::choose (Site& s)
+{
+    s.chosen = std::min_element(s.times.begin(), s.times.end()) - s.times.begin();
+    if (s_verbose > 1) {
+        const int nsched = s.schedules.size();
+        amrex::Print() << "MFTuner: " << s.name << " with " << s.nthreads << " threads uses "
+                       << scheduleName(s.schedules[s.chosen%nsched]) << " "
+                       << s.tile_sizes[s.chosen/nsched] << ", " << s.times[s.chosen] << " s\n";
+    }
+}
+
+void
+MFTuner::Report ()
+{
+    std::ostringstream ss;
+    ss << "\nMFTuner: the tuned sites of process " << ParallelDescriptor::MyProc() << "\n"
+       << std::left << std::setw(24) << "  site" << std::right << std::setw(8) << "threads"
+       << std::setw(10) << "schedule" << std::setw(22) << "tile size"
+       << std::setw(12) << "time (s)" << std::setw(12) << "worst (s)" << "\n";
+    for (auto const& s : s_sites)
+    {
+        if (s.chosen < 0) continue;
+        const int nsched = s.schedules.size();
+        double worst = 0.0;
+        for (double t : s.times) {
+            if (t < std::numeric_limits<double>::max()) worst = std::max(worst, t);
+        }
+        std::ostringstream ts;
+        ts << s.tile_sizes[s.chosen/nsched];
+        ss << "  " << std::left << std::setw(22) << s.name << std::right << std::setw(8) << s.nthreads
+           << std::setw(10) << scheduleName(s.schedules[s.chosen%nsched])
+           << std::setw(22) << ts.str() << std::scientific << std::setprecision(3)
+           << std::setw(12) << s.times[s.chosen] << std::setw(12) << worst << "\n";
+    }
+    amrex::Print() << ss.str() << std::endl;
+}
+
+void
+MFTuner::ReadFile (const std::string& file)
+{
+    Vector<char> buf;
+    ParallelDescriptor::ReadAndBcastFile(file, buf, false);
+    if (buf.empty()) return;
+
+    std::istringstream is(std::string(buf.dataPtr()), std::istringstream::in);
+    std::string line;
+    while (std::getline(is, line))
+    {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        int nthreads;
+        std::string sched;
+        IntVect ts;
+        double t;
+        std::string name;
+        ls >> nthreads >> sched >> ts >> t;
+        std::getline(ls >> std::ws, name);
+        if (ls.fail() || name.empty()) {
+            amrex::Abort("MFTuner: bad line in " + file + ": " + line);
+        }
+        int schedule = 0;
+        while (schedule < NSchedules && sched != scheduleName(schedule)) ++schedule;
+        if (schedule == NSchedules) {
+            amrex::Abort("MFTuner: unknown schedule in " + file + ": " + sched);
+        }
+
+        Site& s = s_sites[siteId(name, nthreads)];
+        s.tile_sizes = {ts};
+        s.schedules = {schedule};
+        s.times = {t};
+        s.chosen = 0;
+    }
+}
+
+void
+MFTuner::WriteFile (const std::string& file)
+{
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    std::ofstream ofs(file);
+    if (!ofs.good()) amrex::FileOpenFailed(file);
+    ofs << "# MFTuner: nthreads schedule tile_size time name\n";
+    for (auto const& s : s_sites)
+    {
+        if (s.chosen < 0) continue;
+        const int nsched = s.schedules.size();
+        ofs << s.nthreads << " " << scheduleName(s.schedules[s.chosen%nsched]) << " "
+            << s.tile_sizes[s.chosen/nsched] << " " << std::setprecision(6)
+            << s.times[s.chosen] << " " << s.name << "\n";
+    }
+}
+
+}
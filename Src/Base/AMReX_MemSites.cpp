@@ -0,0 +1,281 @@
+#include <AMReX_MemSites.H>
+#include <AMReX.H>
+#include <AMReX_Arena.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+#include <AMReX_BLProfiler.H>
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+namespace amrex {
+
+bool       MemSites::s_enabled = false;
+int        MemSites::s_ntop    = 10;
+std::mutex MemSites::s_mutex;
+
+Vector<std::string>       MemSites::s_site_names;
+std::map<std::string,int> MemSites::s_site_ids;
+Vector<int>               MemSites::s_stack;
+
+Vector<const Arena*> MemSites::s_arenas;
+Vector<std::string>  MemSites::s_arena_names;
+
+Vector<std::pair<int,int> >      MemSites::s_slots;
+std::map<std::pair<int,int>,int> MemSites::s_slot_ids;
+Vector<Long>                     MemSites::s_bytes;
+Vector<Long>                     MemSites::s_slot_hwm;
+Vector<Long>                     MemSites::s_at_hwm;
+
+std::unordered_map<void*,MemSites::Allocation> MemSites::s_live;
+
+Long MemSites::s_total    = 0L;
+Long MemSites::s_hwm      = 0L;
+Long MemSites::s_step_hwm = 0L;
+
+namespace {
+
+    // The top n of (bytes, name), largest first.
+    void printTop (std::ostream& os, Vector<std::pair<Long,std::string> >& v, int n, Long ref)
+    {
+        std::sort(v.begin(), v.end(),
+                  [] (const std::pair<Long,std::string>& a, const std::pair<Long,std::string>& b)
+                  { return a.first > b.first; });
+        for (int i = 0, N = std::min(n, static_cast<int>(v.size())); i < N; ++i) {
+            if (v[i].first <= 0) break;
+            os << "  " << std::fixed << std::setprecision(2)
+               << std::setw(12) << v[i].first/(1024.*1024.) << " MB  "
+               << std::setw(6) << ((ref > 0) ? 100.0*v[i].first/ref : 0.0) << "%  "
+               << v[i].second << "\n";
+        }
+    }
+}
+
+void
+MemSites::Initialize ()
+{
+    s_enabled = false;
+    s_ntop = 10;
+
+    ParmParse pp("memsites");
+    pp.query("enable", s_enabled);
+    pp.query("ntop", s_ntop);
+
+    s_site_names.clear();
+    s_site_ids.clear();
+    s_stack.clear();
+    s_site_names.push_back("(untagged)");
+    s_site_ids[s_site_names[0]] = 0;
+
+    s_arenas = {The_Arena(), The_Device_Arena(), The_Managed_Arena(),
+                The_Pinned_Arena(), The_Cpu_Arena()};
+    s_arena_names = {"The_Arena", "The_Device_Arena", "The_Managed_Arena",
+                     "The_Pinned_Arena", "The_Cpu_Arena", "other Arena"};
+
+    s_slots.clear();
+    s_slot_ids.clear();
+    s_bytes.clear();
+    s_slot_hwm.clear();
+    s_at_hwm.clear();
+    s_live.clear();
+    s_total = 0L;
+    s_hwm = 0L;
+    s_step_hwm = 0L;
+
+    amrex::ExecOnFinalize(MemSites::Finalize);
+}
+
+void
+MemSites::Finalize ()
+{
+    Report();
+    s_enabled = false;
+    s_live.clear();
+    s_stack.clear();
+}
+
+int
+MemSites::arenaId (const Arena* ar)
+{
+    for (int i = 0, N = s_arenas.size(); i < N; ++i) {
+        if (s_arenas[i] == ar) return i;
+    }
+    return s_arenas.size();
+}
+
+int
+MemSites::slotId (int site, int arena)
+{
+    const auto key = std::make_pair(site, arena);
+    auto it = s_slot_ids.find(key);
+    if (it != s_slot_ids.end()) return it->second;
+    const int id = s_slots.size();
+    s_slots.push_back(key);
+    s_slot_ids[key] = id;
+    s_bytes.push_back(0L);
+    s_slot_hwm.push_back(0L);
+    s_at_hwm.push_back(0L);
+    return id;
+}
+
+std::string
+MemSites::slotName (int slot)
+{
+    return s_site_names[s_slots[slot].first] + " [" + s_arena_names[s_slots[slot].second] + "]";
+}
+
+void
+MemSites::Alloc (const Arena* ar, void* p, std::size_t nbytes)
+{
+    if (p == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    const int site = s_stack.empty() ? 0 : s_stack.back();
+    const int slot = slotId(site, arenaId(ar));
+    s_live[p] = Allocation{slot, nbytes};
+
+    const Long n = static_cast<Long>(nbytes);
+    s_bytes[slot] += n;
+    s_slot_hwm[slot] = std::max(s_slot_hwm[slot], s_bytes[slot]);
+    s_total += n;
+    s_step_hwm = std::max(s_step_hwm, s_total);
+    if (s_total > s_hwm) {
+        s_hwm = s_total;
+        s_at_hwm = s_bytes;
+    }
+}
+
+void
+MemSites::Free (void* p)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    auto it = s_live.find(p);
+    if (it == s_live.end()) return;  // allocated before tracking started
+
+    const Long n = static_cast<Long>(it->second.nbytes);
+    s_bytes[it->second.slot] -= n;
+    s_total -= n;
+    s_live.erase(it);
+}
+
+void
+MemSites::PushSite (const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    const std::string path = s_stack.empty() ? name : s_site_names[s_stack.back()] + "/" + name;
+    auto it = s_site_ids.find(path);
+    int id;
+    if (it != s_site_ids.end()) {
+        id = it->second;
+    } else {
+        id = s_site_names.size();
+        s_site_names.push_back(path);
+        s_site_ids[path] = id;
+    }
+    s_stack.push_back(id);
+}
+
+void
+MemSites::PopSite ()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_stack.empty()) s_stack.pop_back();
+}
+
+void
+MemSites::Report ()
+{
+    if (!s_enabled) return;
+
+    BL_PROFILE("MemSites::Report()");
+
+    // The slots are matched across the processes by name.
+    Vector<std::string> local(s_slots.size());
+    for (int i = 0, N = s_slots.size(); i < N; ++i) {
+        local[i] = slotName(i);
+    }
+    Vector<std::string> names;
+    bool synced;
+    amrex::SyncStrings(local, names, synced);
+    const int nc = names.size();
+
+    Vector<int> col(local.size());
+    for (int i = 0, N = local.size(); i < N; ++i) {
+        col[i] = std::find(names.begin(), names.end(), local[i]) - names.begin();
+    }
+
+    const int myproc = ParallelDescriptor::MyProc();
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+
+    // The process with the highest high-water mark sends its sites at it.
+    Long hwm_max = s_hwm;
+    ParallelDescriptor::ReduceLongMax(hwm_max);
+    int maxproc = (s_hwm == hwm_max) ? myproc : nprocs;
+    ParallelDescriptor::ReduceIntMin(maxproc);
+    Long hwm_min = s_hwm;
+    Long hwm_sum = s_hwm;
+    ParallelDescriptor::ReduceLongMin(hwm_min, ioproc);
+    ParallelDescriptor::ReduceLongSum(hwm_sum, ioproc);
+
+    Vector<Long> at(nc, 0L), own(nc, 0L);
+    for (int i = 0, N = local.size(); i < N; ++i) {
+        if (myproc == maxproc) at[col[i]] = s_at_hwm[i];
+        own[col[i]] = s_slot_hwm[i];
+    }
+    if (nc > 0) {
+        ParallelDescriptor::ReduceLongSum(at.dataPtr(), nc, ioproc);
+        ParallelDescriptor::ReduceLongMax(own.dataPtr(), nc, ioproc);
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const double MB = 1024.*1024.;
+        std::ostream& os = amrex::OutStream();
+        const auto flags = os.flags();
+        const auto prec = os.precision();
+        os << std::fixed << std::setprecision(2)
+           << "\nMemSites: high-water mark of the Arena allocations per process [min...avg...max]: "
+           << hwm_min/MB << " ... " << hwm_sum/MB/nprocs << " ... " << hwm_max/MB
+           << " MB, the max on process " << maxproc << "\n";
+
+        Vector<std::pair<Long,std::string> > v(nc);
+        for (int c = 0; c < nc; ++c) v[c] = std::make_pair(at[c], names[c]);
+        os << "MemSites: top " << s_ntop << " sites at the high-water mark of process "
+           << maxproc << " (% of it)\n";
+        printTop(os, v, s_ntop, hwm_max);
+
+        for (int c = 0; c < nc; ++c) v[c] = std::make_pair(own[c], names[c]);
+        os << "MemSites: top " << s_ntop << " sites by their own high-water mark,"
+           << " max over the processes (% of the max high-water mark)\n";
+        printTop(os, v, s_ntop, hwm_max);
+        os << std::endl;
+        os.flags(flags);
+        os.precision(prec);
+    }
+}
+
+void
+MemSites::ReportLocal (std::ostream& os)
+{
+    if (!s_enabled) return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    Vector<std::pair<Long,std::string> > v(s_slots.size());
+    for (int i = 0, N = s_slots.size(); i < N; ++i) {
+        v[i] = std::make_pair(s_at_hwm[i], slotName(i));
+    }
+    os << "MemSites: process " << ParallelDescriptor::MyProc() << " has "
+       << s_total/(1024.*1024.) << " MB allocated, its high-water mark is "
+       << s_hwm/(1024.*1024.) << " MB with the top sites\n";
+    printTop(os, v, s_ntop, s_hwm);
+}
+
+}
@@ -226,6 +226,7 @@ WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
                                           mf[level]->DistributionMap(),
                                           mf[level]->nComp(), 0, MFInfo(),
                                           mf[level]->Factory()));
+                mf_tmp->setCoveredValue(mf[level]->coveredValue());
                 MultiFab::Copy(*mf_tmp, *mf[level], 0, 0, mf[level]->nComp(), 0);
                 data = mf_tmp.get();
             } else {
@@ -442,7 +443,12 @@ EB_WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
         MultiFab mf_tmp(mf[level]->boxArray(),
                         mf[level]->DistributionMap(),
                         nc+1, 0);
-        MultiFab::Copy(mf_tmp, *mf[level], 0, 0, nc, 0);
+        if (mf[level]->hasSkippedBoxes()) {
+            mf_tmp.setVal(mf[level]->coveredValue(), 0, nc, 0);
+            mf_tmp.ParallelCopy(*mf[level], 0, 0, nc);
+        } else {
+            MultiFab::Copy(mf_tmp, *mf[level], 0, 0, nc, 0);
+        }
         auto const& factory = dynamic_cast<EBFArrayBoxFactory const&>(mf[level]->Factory());
         MultiFab::Copy(mf_tmp, factory.getVolFrac(), 0, nc, 1, 0);
 	VisMF::Write(mf_tmp, MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix));
@@ -0,0 +1,258 @@
+#include <AMReX_Telemetry.H>
+#include <AMReX.H>
+#include <AMReX_FabArrayBase.H>
+#include <AMReX_MemSites.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParallelReduce.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+#include <AMReX_BLProfiler.H>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace amrex {
+
+bool        Telemetry::s_enabled     = false;
+bool        Telemetry::s_in_step     = false;
+int         Telemetry::s_interval    = 10;
+bool        Telemetry::s_append      = false;
+bool        Telemetry::s_first_flush = true;
+std::string Telemetry::s_file;
+
+Vector<std::string>       Telemetry::s_names;
+std::map<std::string,int> Telemetry::s_ids;
+Vector<std::string>       Telemetry::s_columns;
+Vector<Telemetry::Row>    Telemetry::s_rows;
+
+double Telemetry::s_t0        = 0.0;
+double Telemetry::s_comm_time = 0.0;
+Long   Telemetry::s_msgs0     = 0L;
+Long   Telemetry::s_bytes0    = 0L;
+
+namespace {
+    // The metrics of every step, with the ids 0 to 4.
+    const char* const step_metrics[] = {"step_time", "step_compute", "comm_msgs",
+                                        "comm_bytes", "fab_bytes"};
+}
+
+void
+Telemetry::Initialize ()
+{
+    s_enabled = false;
+    s_in_step = false;
+    s_interval = 10;
+    s_append = false;
+    s_first_flush = true;
+    s_file = "telemetry.csv";
+    s_names.clear();
+    s_ids.clear();
+    s_columns.clear();
+    s_rows.clear();
+
+    ParmParse pp("telemetry");
+    pp.query("enable", s_enabled);
+    pp.query("interval", s_interval);
+    pp.query("file", s_file);
+    pp.query("append", s_append);
+    s_interval = std::max(s_interval, 1);
+
+    for (const char* name : step_metrics) {
+        metricId(name);
+    }
+
+    amrex::ExecOnFinalize(Telemetry::Finalize);
+}
+
+void
+Telemetry::Finalize ()
+{
+    if (s_in_step) StopStep();
+    Flush();
+    s_enabled = false;
+    s_rows.clear();
+}
+
+int
+Telemetry::metricId (const std::string& name)
+{
+    auto it = s_ids.find(name);
+    if (it != s_ids.end()) return it->second;
+    const int id = s_names.size();
+    s_names.push_back(name);
+    s_ids[name] = id;
+    return id;
+}
+
+void
+Telemetry::StartStep (int step, Real time)
+{
+    if (!s_enabled) return;
+
+    s_in_step = true;
+    s_comm_time = 0.0;
+    s_msgs0 = FabArrayBase::m_comm_counts.nmsgs;
+    s_bytes0 = FabArrayBase::m_comm_counts.nbytes;
+    s_rows.push_back(Row{step, time, Vector<double>(s_names.size(), 0.0)});
+    if (MemSites::Enabled()) MemSites::ResetStepHWM();
+    s_t0 = amrex::second();
+}
+
+void
+Telemetry::StopStep ()
+{
+    if (!s_enabled || !s_in_step) return;
+
+    const double dt = amrex::second() - s_t0;
+    s_in_step = false;
+
+    Vector<double>& v = s_rows.back().v;
+    v[0] = dt;
+    v[1] = dt - s_comm_time;
+    v[2] = FabArrayBase::m_comm_counts.nmsgs - s_msgs0;
+    v[3] = FabArrayBase::m_comm_counts.nbytes - s_bytes0;
+    v[4] = FabArrayBase::queryMemUsage();
+
+    if (MemSites::Enabled()) {
+        const int ib = metricId("mem_bytes");
+        const int ih = metricId("mem_hwm");
+        if (ih >= static_cast<int>(v.size())) v.resize(ih+1, 0.0);
+        v[ib] = MemSites::CurrentBytes();
+        v[ih] = MemSites::StepHWM();
+    }
+
+    if (static_cast<int>(s_rows.size()) >= s_interval) Flush();
+}
+
+void
+Telemetry::AddTime (const std::string& name, double dt, bool is_comm)
+{
+    if (!s_enabled || !s_in_step) return;
+
+    const int id = metricId(name);
+    Vector<double>& v = s_rows.back().v;
+    if (id >= static_cast<int>(v.size())) v.resize(id+1, 0.0);
+    v[id] += dt;
+    if (is_comm) s_comm_time += dt;
+}
+
+void
+Telemetry::Flush ()
+{
+    if (!s_enabled) return;
+
+    BL_PROFILE("Telemetry::Flush()");
+
+    // The columns are the union of the names of all processes.  They only
+    // need to be synchronized when some process has new names.
+    Vector<std::string> local = s_columns;
+    for (auto const& name : s_names) {
+        if (std::find(s_columns.begin(), s_columns.end(), name) == s_columns.end()) {
+            local.push_back(name);
+        }
+    }
+    bool changed = local.size() > s_columns.size();
+    ParallelDescriptor::ReduceBoolOr(changed);
+    if (changed) {
+        bool synced;
+        amrex::SyncStrings(local, s_columns, synced);
+    }
+
+    const int nc = s_columns.size();
+    const int nr = s_rows.size();
+    const int n = nr*nc;
+    if (n == 0) return;
+
+    Vector<int> col(s_names.size());
+    for (int i = 0, N = s_names.size(); i < N; ++i) {
+        col[i] = std::find(s_columns.begin(), s_columns.end(), s_names[i]) - s_columns.begin();
+    }
+
+    // The max and -min of all the values are reduced together, then the sum
+    // and the process with the max.
+    Vector<double> lv(n, 0.0);
+    for (int r = 0; r < nr; ++r) {
+        const Vector<double>& v = s_rows[r].v;
+        for (int i = 0, N = v.size(); i < N; ++i) {
+            lv[r*nc+col[i]] = v[i];
+        }
+    }
+    Vector<double> mx(2*n);
+    for (int k = 0; k < n; ++k) {
+        mx[k]   =  lv[k];
+        mx[n+k] = -lv[k];
+    }
+
+    const int myproc = ParallelDescriptor::MyProc();
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+
+    ParallelAllReduce::Max(mx.data(), 2*n, comm);
+    Vector<int> rank(n);
+    for (int k = 0; k < n; ++k) {
+        rank[k] = (lv[k] == mx[k]) ? myproc : nprocs;
+    }
+    ParallelReduce::Sum(lv.data(), n, ioproc, comm);
+    ParallelReduce::Min(rank.data(), n, ioproc, comm);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const bool truncate = s_first_flush && !s_append;
+        bool header = truncate;
+        if (!header) {
+            std::ifstream ifs(s_file);
+            header = !ifs.good() || ifs.peek() == std::ifstream::traits_type::eof();
+        }
+        std::ofstream ofs(s_file, truncate ? std::ios::trunc : std::ios::app);
+        if (!ofs.good()) {
+            amrex::FileOpenFailed(s_file);
+        }
+        if (header) {
+            ofs << "step,time,metric,min,avg,max,imbalance,max_rank\n";
+        }
+        ofs << std::setprecision(6);
+        for (int r = 0; r < nr; ++r) {
+            for (int c = 0; c < nc; ++c) {
+                const int k = r*nc+c;
+                const double vmax = mx[k];
+                const double vmin = -mx[n+k];
+                // Regions that did not run in this step are skipped.
+                if (c >= 5 && vmax == 0.0 && vmin == 0.0) continue;
+                const double vavg = lv[k]/nprocs;
+                ofs << s_rows[r].step << "," << s_rows[r].time << "," << s_columns[c] << ","
+                    << vmin << "," << vavg << "," << vmax << ","
+                    << ((vavg > 0.0) ? vmax/vavg : 1.0) << "," << rank[k] << "\n";
+            }
+        }
+    }
+
+    s_first_flush = false;
+    s_rows.clear();
+}
+
+Telemetry::Region::Region (const char* name, bool is_comm) noexcept
+    : m_name(nullptr), m_t0(0.0), m_is_comm(is_comm)
+{
+    if (Telemetry::s_enabled && Telemetry::s_in_step) {
+#ifdef _OPENMP
+        if (omp_in_parallel()) return;
+#endif
+        m_name = name;
+        m_t0 = amrex::second();
+    }
+}
+
+Telemetry::Region::~Region ()
+{
+    if (m_name) {
+        Telemetry::AddTime(m_name, amrex::second() - m_t0, m_is_comm);
+    }
+}
+
+}
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <cstring>
+#include <cstdint>
 #include <set>
 
 #include <AMReX_TinyProfiler.H>
@@ -12,6 +14,7 @@
 #include <AMReX_ParallelReduce.H>
 #include <AMReX_Utility.H>
 #include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
 
 #ifdef AMREX_USE_CUPTI
 #include <AMReX_CuptiTrace.H>
@@ -22,13 +25,234 @@
 #include <omp.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
 
 namespace amrex {
 
+struct TinyProfiler::ThreadData
+{
+    //! A read of the perf_event group, unscaled.
+    struct Counts
+    {
+        std::uint64_t enabled;  //!< time the group was enabled
+        std::uint64_t running;  //!< time the group was counting
+        std::uint64_t v[MaxCounters];
+    };
+
+    //! Value-initialized (Frame{}) and then filled, so new members start at zero.
+    struct Frame
+    {
+        int id;
+        int rbegin;     //!< start of the regions of this frame in regs
+        double t0;      //!< wall time when the frame is pushed
+        double tchild;  //!< accumulated dt of children
+        Counts c0;                          //!< counters when the frame is pushed
+        std::uint64_t cchild[MaxCounters];  //!< accumulated counts of children
+        Long cells;
+    };
+
+    struct TStats
+    {
+        int  depth = 0;
+        Long n = 0L;
+        double dtin = 0.0;
+        double dtex = 0.0;
+        std::uint64_t cnt[MaxCounters] = {};
+        Long cells = 0L;
+    };
+
+    std::vector<Frame> stack;
+    std::vector<int> regs;
+
+    //! The perf_event group of this thread, leader first.  Empty if not open.
+    std::vector<int> perf_fds;
+    bool perf_opened = false;
+    bool perf_multiplexed = false;  //!< some counts were scaled
+
+    ~ThreadData () { closeCounters(); }
+
+    void openCounters ();
+    void readCounters (Counts& c);
+    //! The counts from c0 to c1, scaled if the kernel multiplexed the group.
+    void countsBetween (const Counts& c0, const Counts& c1, std::uint64_t* d);
+    void closeCounters ();
+    std::vector<std::vector<TStats> > stats;  //!< [region id][name id]
+
+    // Interned ids of the names seen by this thread.  Literals are found by
+    // address in a direct-mapped cache, and the name is compared in case
+    // the address was reused.
+    struct CEntry
+    {
+        const char* key = nullptr;
+        const std::string* name = nullptr;
+        int id = -1;
+    };
+    static constexpr int ncache = 512;
+    CEntry ccache[ncache];
+    std::unordered_map<std::string,int> scache;
+
+    static int slot (const char* p) noexcept {
+        return static_cast<int>((reinterpret_cast<std::uintptr_t>(p) >> 3) % ncache);
+    }
+
+    TStats& get (int region, int id) {
+        if (region >= static_cast<int>(stats.size())) stats.resize(region+1);
+        auto& v = stats[region];
+        if (id >= static_cast<int>(v.size())) v.resize(id+1);
+        return v[id];
+    }
+};
+
+constexpr int TinyProfiler::MaxCounters;
+
+namespace {
+    struct PerfEvent
+    {
+        std::string   name;
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+    std::vector<PerfEvent> perf_events;
+    int  cache_line_bytes = 64;
+    int  perf_errno = 0;  //!< set if some thread could not open the counters
+
+    bool parsePerfEvent (const std::string& name, PerfEvent& ev)
+    {
+#if defined(__linux__)
+        ev.name = name;
+        if (name == "cycles") {
+            ev.type = PERF_TYPE_HARDWARE;
+            ev.config = PERF_COUNT_HW_CPU_CYCLES;
+        } else if (name == "instructions") {
+            ev.type = PERF_TYPE_HARDWARE;
+            ev.config = PERF_COUNT_HW_INSTRUCTIONS;
+        } else if (name == "llc_misses") {
+            ev.type = PERF_TYPE_HARDWARE;
+            ev.config = PERF_COUNT_HW_CACHE_MISSES;
+        } else if (name == "llc_refs") {
+            ev.type = PERF_TYPE_HARDWARE;
+            ev.config = PERF_COUNT_HW_CACHE_REFERENCES;
+        } else if (name == "branch_misses") {
+            ev.type = PERF_TYPE_HARDWARE;
+            ev.config = PERF_COUNT_HW_BRANCH_MISSES;
+        } else if (name.compare(0, 4, "raw:") == 0) {
+            ev.type = PERF_TYPE_RAW;
+            ev.config = std::stoull(name.substr(4), nullptr, 0);
+        } else {
+            return false;
+        }
+        return true;
+#else
+        amrex::ignore_unused(name, ev);
+        return false;
+#endif
+    }
+}
+
+void
+TinyProfiler::ThreadData::openCounters ()
+{
+    perf_opened = true;
+#if defined(__linux__)
+    std::vector<int> fds;
+    for (auto const& ev : perf_events)
+    {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = ev.type;
+        attr.config = ev.config;
+        attr.disabled = fds.empty() ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+            | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // This thread, any cpu, in the group of the first counter.
+        const int fd = syscall(__NR_perf_event_open, &attr, 0, -1,
+                               fds.empty() ? -1 : fds[0], 0);
+        if (fd < 0) {
+            perf_errno = errno;
+            for (int f : fds) close(f);
+            return;
+        }
+        fds.push_back(fd);
+    }
+    perf_fds = std::move(fds);
+    ioctl(perf_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(perf_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void
+TinyProfiler::ThreadData::closeCounters ()
+{
+#if defined(__linux__)
+    for (int f : perf_fds) close(f);
+#endif
+    perf_fds.clear();
+    perf_opened = false;
+}
+
+void
+TinyProfiler::ThreadData::readCounters (Counts& c)
+{
+    if (!perf_opened) openCounters();
+    const int n = perf_events.size();
+#if defined(__linux__)
+    if (!perf_fds.empty()) {
+        // The number of counters, the times the group was enabled and
+        // running, then the values.
+        std::uint64_t buf[3+MaxCounters];
+        if (read(perf_fds[0], buf, sizeof(std::uint64_t)*(3+n)) > 0) {
+            c.enabled = buf[1];
+            c.running = buf[2];
+            for (int k = 0; k < n; ++k) c.v[k] = buf[3+k];
+            return;
+        }
+    }
+#endif
+    c.enabled = c.running = 0;
+    for (int k = 0; k < n; ++k) c.v[k] = 0;
+}
+
+void
+TinyProfiler::ThreadData::countsBetween (const Counts& c0, const Counts& c1, std::uint64_t* d)
+{
+    // The raw values only grow.  If the kernel multiplexed the group with
+    // other events in between, the differences are scaled by the enabled
+    // over the running time in between.  Scaling each read by its own
+    // ratio instead could make the second smaller than the first.
+    const int n = perf_events.size();
+    const std::uint64_t enabled = c1.enabled - c0.enabled;
+    const std::uint64_t running = c1.running - c0.running;
+    double scale = 1.0;
+    if (running > 0 && running < enabled) {
+        perf_multiplexed = true;
+        scale = static_cast<double>(enabled) / running;
+    }
+    for (int k = 0; k < n; ++k) {
+        const std::uint64_t dv = (c1.v[k] > c0.v[k]) ? c1.v[k] - c0.v[k] : 0;
+        d[k] = (scale == 1.0) ? dv : static_cast<std::uint64_t>(dv*scale);
+    }
+}
+
 std::vector<std::string>          TinyProfiler::regionstack;
 std::deque<std::tuple<double,double,std::string*> > TinyProfiler::ttstack;
 std::map<std::string,std::map<std::string, TinyProfiler::Stats> > TinyProfiler::statsmap;
 double TinyProfiler::t_init = std::numeric_limits<double>::max();
+bool TinyProfiler::per_thread = false;
+std::vector<int> TinyProfiler::regionidstack;
+std::deque<std::string> TinyProfiler::names;
+std::unordered_map<std::string,int> TinyProfiler::nameids;
+std::vector<std::unique_ptr<TinyProfiler::ThreadData> > TinyProfiler::threaddata;
+
 
 namespace {
     std::set<std::string> improperly_nested_timers;
@@ -48,14 +272,16 @@ TinyProfiler::TinyProfiler (std::string funcname, bool start_, bool useCUPTI) no
 }
 
 TinyProfiler::TinyProfiler (const char* funcname) noexcept
-    : fname(funcname), uCUPTI(false)
+    : cname(funcname), uCUPTI(false)
 {
+    if (!per_thread) fname = funcname;
     start();
 }
 
 TinyProfiler::TinyProfiler (const char* funcname, bool start_, bool useCUPTI) noexcept
-    : fname(funcname), uCUPTI(useCUPTI)
+    : cname(funcname), uCUPTI(useCUPTI)
 {
+    if (!per_thread || useCUPTI) fname = funcname;
     if (start_) start();
 }
 
@@ -67,11 +293,17 @@ TinyProfiler::~TinyProfiler ()
 void
 TinyProfiler::start () noexcept
 {
+    if (per_thread && !uCUPTI) {
+        startThread();
+        return;
+    }
+
 #ifdef _OPENMP
 #pragma omp master
 #endif
     if (stats.empty() && !regionstack.empty())
     {
+        if (fname.empty() && cname != nullptr) fname = cname;
         double t;
 	if (!uCUPTI) {
 	    t = amrex::second();
@@ -103,6 +335,11 @@ TinyProfiler::start () noexcept
 void
 TinyProfiler::stop () noexcept
 {
+    if (tdata != nullptr) {
+        stopThread();
+        return;
+    }
+
 #ifdef _OPENMP
 #pragma omp master
 #endif
@@ -242,10 +479,236 @@ TinyProfiler::stop (unsigned boxUintID) noexcept
 }
 #endif
 
+TinyProfiler::ThreadData&
+TinyProfiler::threadData ()
+{
+    // The records are never freed, so that this pointer stays valid.
+    static thread_local ThreadData* p = nullptr;
+    if (p == nullptr) {
+#ifdef _OPENMP
+#pragma omp critical(tinyprofiler_threads)
+#endif
+        {
+            threaddata.emplace_back(new ThreadData());
+            p = threaddata.back().get();
+        }
+    }
+    return *p;
+}
+
+int
+TinyProfiler::internName (const std::string& name)
+{
+    int id;
+#ifdef _OPENMP
+#pragma omp critical(tinyprofiler_intern)
+#endif
+    {
+        auto it = nameids.find(name);
+        if (it == nameids.end()) {
+            id = names.size();
+            names.push_back(name);
+            nameids.emplace(name, id);
+        } else {
+            id = it->second;
+        }
+    }
+    return id;
+}
+
+int
+TinyProfiler::internName (ThreadData& td, const char* name)
+{
+    ThreadData::CEntry& e = td.ccache[ThreadData::slot(name)];
+    if (e.key == name && std::strcmp(e.name->c_str(), name) == 0) {
+        return e.id;
+    }
+    const int id = internName(std::string(name));
+    const std::string* p;
+#ifdef _OPENMP
+#pragma omp critical(tinyprofiler_intern)
+#endif
+    p = &names[id];
+    e.key = name;
+    e.name = p;
+    e.id = id;
+    return id;
+}
+
+int
+TinyProfiler::internName (ThreadData& td, const std::string& name)
+{
+    auto it = td.scache.find(name);
+    if (it != td.scache.end()) return it->second;
+    const int id = internName(name);
+    td.scache.emplace(name, id);
+    return id;
+}
+
+void
+TinyProfiler::startThread () noexcept
+{
+    if (tdata != nullptr || regionidstack.empty()) return;
+
+    ThreadData& td = threadData();
+    const int id = (cname != nullptr) ? internName(td, cname) : internName(td, fname);
+
+    ThreadData::Frame frame{};
+    frame.id = id;
+    frame.rbegin = td.regs.size();
+    td.stack.push_back(frame);
+    for (int r : regionidstack) {
+        td.regs.push_back(r);
+        ++td.get(r,id).depth;
+    }
+    global_depth = td.stack.size();
+    tdata = &td;
+
+#ifdef AMREX_USE_CUDA
+    nvtx_id = nvtxRangeStartA((cname != nullptr) ? cname : fname.c_str());
+#endif
+
+    if (!perf_events.empty()) td.readCounters(td.stack.back().c0);
+    td.stack.back().t0 = amrex::second();
+}
+
+void
+TinyProfiler::stopThread () noexcept
+{
+    const double t = amrex::second();
+
+    ThreadData& td = *tdata;
+    tdata = nullptr;
+
+    const int ncnt = perf_events.size();
+    ThreadData::Counts c;
+    if (ncnt > 0) td.readCounters(c);
+
+    while (static_cast<int>(td.stack.size()) > global_depth) {
+        td.regs.resize(td.stack.back().rbegin);
+        td.stack.pop_back();
+    }
+
+    if (static_cast<int>(td.stack.size()) == global_depth)
+    {
+        const ThreadData::Frame f = td.stack.back();
+        const double dtin = t - f.t0;
+        const double dtex = dtin - f.tchild;
+        std::uint64_t cin[MaxCounters], cex[MaxCounters];
+        if (ncnt > 0) td.countsBetween(f.c0, c, cin);
+        for (int k = 0; k < ncnt; ++k) {
+            cex[k] = cin[k] - std::min(cin[k], f.cchild[k]);
+        }
+
+        for (int k = f.rbegin, nk = td.regs.size(); k < nk; ++k)
+        {
+            ThreadData::TStats& st = td.get(td.regs[k], f.id);
+            --(st.depth);
+            ++(st.n);
+            if (st.depth == 0) {
+                st.dtin += dtin;
+            }
+            st.dtex += dtex;
+            for (int kc = 0; kc < ncnt; ++kc) {
+                st.cnt[kc] += cex[kc];
+            }
+            st.cells += f.cells;
+        }
+
+        td.regs.resize(f.rbegin);
+        td.stack.pop_back();
+        if (!td.stack.empty()) {
+            td.stack.back().tchild += dtin;
+            for (int k = 0; k < ncnt; ++k) {
+                td.stack.back().cchild[k] += cin[k];
+            }
+        }
+
+#ifdef AMREX_USE_CUDA
+        nvtxRangeEnd(nvtx_id);
+#endif
+    }
+    else
+    {
+#ifdef _OPENMP
+#pragma omp critical(tinyprofiler_nesting)
+#endif
+        improperly_nested_timers.insert((cname != nullptr) ? std::string(cname) : fname);
+    }
+}
+
+std::map<std::string,std::map<std::string, TinyProfiler::Stats> >
+TinyProfiler::mergeThreads ()
+{
+    // The time of a process is that of its slowest thread.
+    std::map<std::string,std::map<std::string, Stats> > r;
+    for (auto const& p : threaddata)
+    {
+        const ThreadData& td = *p;
+        for (int reg = 0, nreg = td.stats.size(); reg < nreg; ++reg)
+        {
+            for (int id = 0, nid = td.stats[reg].size(); id < nid; ++id)
+            {
+                const ThreadData::TStats& ts = td.stats[reg][id];
+                if (ts.n == 0) continue;
+                Stats& st = r[names[reg]][names[id]];
+                st.n += ts.n;
+                st.dtin = std::max(st.dtin, ts.dtin);
+                st.dtex = std::max(st.dtex, ts.dtex);
+                ++st.nthreads;
+                st.dtexthrmin = std::min(st.dtexthrmin, ts.dtex);
+                st.dtexthrsum += ts.dtex;
+                for (int k = 0; k < MaxCounters; ++k) {
+                    st.cnt[k] += ts.cnt[k];
+                }
+                st.cells += ts.cells;
+            }
+        }
+    }
+    return r;
+}
+
+int
+TinyProfiler::NumCounters () noexcept
+{
+    return perf_events.size();
+}
+
+void
+TinyProfiler::AddCells (Long n) noexcept
+{
+    if (per_thread) {
+        ThreadData& td = threadData();
+        if (!td.stack.empty()) td.stack.back().cells += n;
+    }
+}
+
 void
 TinyProfiler::Initialize () noexcept
 {
+    {
+        ParmParse pp("tiny_profiler");
+        pp.query("per_thread", per_thread);
+
+        std::vector<std::string> counters;
+        pp.queryarr("perf_counters", counters);
+        pp.query("cache_line_bytes", cache_line_bytes);
+        perf_events.clear();
+        for (auto const& name : counters) {
+            PerfEvent ev;
+            if (static_cast<int>(perf_events.size()) == MaxCounters) {
+                amrex::Print() << "TinyProfiler: too many perf_counters, ignoring " << name << "\n";
+            } else if (parsePerfEvent(name, ev)) {
+                perf_events.push_back(ev);
+            } else {
+                amrex::Print() << "TinyProfiler: unknown or unsupported perf counter " << name << "\n";
+            }
+        }
+        // The counters are per thread.
+        if (!perf_events.empty()) per_thread = true;
+    }
     regionstack.push_back(mainregion);
+    regionidstack.push_back(internName(mainregion));
     t_init = amrex::second();
 }
 
@@ -265,6 +728,31 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
 
     // make a local copy so that any functions call after this will not be recorded in the local copy.
     auto lstatsmap = statsmap;
+    if (per_thread) {
+        for (auto const& kv : mergeThreads()) {
+            for (auto const& st : kv.second) {
+                lstatsmap[kv.first][st.first] = st.second;
+            }
+        }
+    }
+
+    if (!perf_events.empty()) {
+        int err = perf_errno;
+        ParallelDescriptor::ReduceIntMax(err);
+        if (err != 0) {
+            amrex::Print() << "\nWARNING: TinyProfiler could not open the perf counters on some threads: "
+                           << std::strerror(err) << "\n";
+        }
+        bool multiplexed = false;
+        for (auto const& p : threaddata) {
+            multiplexed = multiplexed || p->perf_multiplexed;
+        }
+        ParallelDescriptor::ReduceBoolOr(multiplexed);
+        if (multiplexed) {
+            amrex::Print() << "\nNOTE: the perf counters were multiplexed with other events; "
+                           << "their counts are scaled estimates\n";
+        }
+    }
 
     bool properly_nested = improperly_nested_timers.size() == 0;
     ParallelDescriptor::ReduceBoolAnd(properly_nested);
@@ -335,6 +823,14 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
             amrex::Print() << "END REGION " << kv.first << "\n";
         }
     }
+
+    if (!bFlushing && !perf_events.empty()) {
+        // No more counts are recorded.
+        perf_events.clear();
+        for (auto const& p : threaddata) {
+            p->closeCounters();
+        }
+    }
 }
 
 void
@@ -369,38 +865,75 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
     int maxfnamelen = 0;
     Long maxncalls = 0;
 
+    // In the per-thread mode, the min and avg exclusive dt over the threads
+    // and the number of threads are collected too, followed by the hardware
+    // counters and the cells.
+    const int ncnt = perf_events.size();
+    const int nd = per_thread ? 5 + ncnt + 1 : 2;
+    bool has_threads = false;
+    bool has_counters = false;
+
     // now collect global data onto the ioproc
     for (auto it = regstats.cbegin(); it != regstats.cend(); ++it)
     {
         Long n = it->second.n;
-        double dts[2] = {it->second.dtin, it->second.dtex};
+        const int nthreads = it->second.nthreads;
+        double dts[5+MaxCounters+1] = {it->second.dtin, it->second.dtex,
+                                       (nthreads > 0) ? it->second.dtexthrmin : 0.0,
+                                       (nthreads > 0) ? it->second.dtexthrsum/nthreads : 0.0,
+                                       double(nthreads)};
+        for (int k = 0; k < ncnt; ++k) {
+            dts[5+k] = it->second.cnt[k];
+        }
+        dts[5+ncnt] = it->second.cells;
 
         std::vector<Long> ncalls(nprocs);
-        std::vector<double> dtdt(2*nprocs);
+        std::vector<double> dtdt(nd*nprocs);
 
         if (ParallelDescriptor::NProcs() == 1)
         {
             ncalls[0] = n;
-            dtdt[0] = dts[0];
-            dtdt[1] = dts[1];
+            std::copy(dts, dts+nd, dtdt.begin());
         } else
         {
             ParallelDescriptor::Gather(&n, 1, &ncalls[0], 1, ioproc);
-            ParallelDescriptor::Gather(dts, 2, &dtdt[0], 2, ioproc);
+            ParallelDescriptor::Gather(dts, nd, &dtdt[0], nd, ioproc);
         }
 
         if (ParallelDescriptor::IOProcessor()) {
             ProcStats pst;
+            int nthrprocs = 0;
             for (int i = 0; i < nprocs; ++i) {
                 pst.nmin  = std::min(pst.nmin, ncalls[i]);
                 pst.navg +=                    ncalls[i];
                 pst.nmax  = std::max(pst.nmax, ncalls[i]);
-                pst.dtinmin  = std::min(pst.dtinmin, dtdt[2*i]);
-                pst.dtinavg +=                       dtdt[2*i];
-                pst.dtinmax  = std::max(pst.dtinmax, dtdt[2*i]);
-                pst.dtexmin  = std::min(pst.dtexmin, dtdt[2*i+1]);
-                pst.dtexavg +=                       dtdt[2*i+1];
-                pst.dtexmax  = std::max(pst.dtexmax, dtdt[2*i+1]);
+                pst.dtinmin  = std::min(pst.dtinmin, dtdt[nd*i]);
+                pst.dtinavg +=                       dtdt[nd*i];
+                pst.dtinmax  = std::max(pst.dtinmax, dtdt[nd*i]);
+                pst.dtexmin  = std::min(pst.dtexmin, dtdt[nd*i+1]);
+                pst.dtexavg +=                       dtdt[nd*i+1];
+                pst.dtexmax  = std::max(pst.dtexmax, dtdt[nd*i+1]);
+                if (per_thread && dtdt[nd*i+4] > 0.0) {
+                    ++nthrprocs;
+                    pst.nthrmax = std::max(pst.nthrmax, int(dtdt[nd*i+4]));
+                    pst.thrmin  = std::min(pst.thrmin, dtdt[nd*i+2]);
+                    pst.thravg += dtdt[nd*i+3];
+                    if (dtdt[nd*i+3] > 0.0) {
+                        pst.imbalance = std::max(pst.imbalance, dtdt[nd*i+1]/dtdt[nd*i+3]);
+                    }
+                }
+                if (ncnt > 0) {
+                    for (int k = 0; k < ncnt; ++k) {
+                        pst.cnt[k] += dtdt[nd*i+5+k];
+                    }
+                    pst.cells   += dtdt[nd*i+5+ncnt];
+                    pst.dtexsum += dtdt[nd*i+1];
+                }
+            }
+            if (nthrprocs > 0) pst.thravg /= nthrprocs;
+            has_threads = has_threads || pst.nthrmax > 1;
+            for (int k = 0; k < ncnt; ++k) {
+                has_counters = has_counters || pst.cnt[k] > 0.0;
             }
             pst.navg /= nprocs;
             pst.dtinavg /= nprocs;
@@ -530,6 +1063,105 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
 #endif
         }
         amrex::OutStream() << hline << "\n";
+
+        // Exclusive time of the timers run by several threads
+        if (has_threads)
+        {
+            const int wnt = std::string("NThreads").size();
+            const std::string thline(maxfnamelen+wnt+2+(wt+2)*4,'-');
+            std::sort(allprocstats.begin(), allprocstats.end(), ProcStats::compex);
+            amrex::OutStream() << "\n" << thline << "\n";
+            amrex::OutStream() << std::left
+                               << std::setw(maxfnamelen) << "Name"
+                               << std::right
+                               << std::setw(wnt+2) << "NThreads"
+                               << std::setw(wt+2) << "Thr. Min"
+                               << std::setw(wt+2) << "Thr. Avg"
+                               << std::setw(wt+2) << "Thr. Max"
+                               << std::setw(wt+2) << "Imbal."
+                               << "\n" << thline << "\n";
+            for (auto it = allprocstats.cbegin(); it != allprocstats.cend(); ++it)
+            {
+                if (it->nthrmax < 2) continue;
+                amrex::OutStream() << std::setprecision(4) << std::left
+                                   << std::setw(maxfnamelen) << it->fname
+                                   << std::right
+                                   << std::setw(wnt+2) << it->nthrmax
+                                   << std::setw(wt+2) << it->thrmin
+                                   << std::setw(wt+2) << it->thravg
+                                   << std::setw(wt+2) << it->dtexmax
+                                   << std::setprecision(2) << std::setw(wt+2) << std::fixed
+                                   << it->imbalance;
+                amrex::OutStream().unsetf(std::ios_base::fixed);
+                amrex::OutStream() << "\n";
+            }
+            amrex::OutStream() << thline << "\n";
+        }
+
+        // Exclusive hardware counters, summed over the threads and processes
+        if (has_counters)
+        {
+            int icycles = -1, iinstrs = -1, imisses = -1;
+            for (int k = 0; k < ncnt; ++k) {
+                if (perf_events[k].name == "cycles") icycles = k;
+                if (perf_events[k].name == "instructions") iinstrs = k;
+                if (perf_events[k].name == "llc_misses") imisses = k;
+            }
+            bool has_cells = false;
+            for (auto const& pst : allprocstats) {
+                has_cells = has_cells || pst.cells > 0.0;
+            }
+            int wc = 10;
+            for (int k = 0; k < ncnt; ++k) {
+                wc = std::max(wc, int(perf_events[k].name.size()));
+            }
+            const bool has_ipc = icycles >= 0 && iinstrs >= 0;
+            has_cells = has_cells && imisses >= 0;
+            const std::string chline(maxfnamelen + (wc+2)*(ncnt + has_ipc + (imisses >= 0)
+                                                            + has_cells), '-');
+            std::sort(allprocstats.begin(), allprocstats.end(), ProcStats::compex);
+            amrex::OutStream() << "\n" << chline << "\n";
+            amrex::OutStream() << std::left << std::setw(maxfnamelen) << "Name" << std::right;
+            for (int k = 0; k < ncnt; ++k) {
+                amrex::OutStream() << std::setw(wc+2) << perf_events[k].name;
+            }
+            if (has_ipc) amrex::OutStream() << std::setw(wc+2) << "IPC";
+            if (imisses >= 0) amrex::OutStream() << std::setw(wc+2) << "LLC GB/s";
+            if (has_cells) amrex::OutStream() << std::setw(wc+2) << "LLC B/cell";
+            amrex::OutStream() << "\n" << chline << "\n";
+            for (auto it = allprocstats.cbegin(); it != allprocstats.cend(); ++it)
+            {
+                amrex::OutStream() << std::setprecision(4) << std::left
+                                   << std::setw(maxfnamelen) << it->fname << std::right;
+                for (int k = 0; k < ncnt; ++k) {
+                    amrex::OutStream() << std::setw(wc+2) << it->cnt[k];
+                }
+                if (has_ipc) {
+                    amrex::OutStream() << std::setw(wc+2)
+                                       << ((it->cnt[icycles] > 0.0)
+                                           ? it->cnt[iinstrs]/it->cnt[icycles] : 0.0);
+                }
+                // The traffic from memory is estimated by the last level cache
+                // misses times the line size.
+                if (imisses >= 0) {
+                    amrex::OutStream() << std::setw(wc+2)
+                                       << ((it->dtexsum > 0.0)
+                                           ? it->cnt[imisses]*cache_line_bytes/it->dtexsum*1.e-9
+                                           : 0.0);
+                }
+                if (has_cells) {
+                    if (it->cells > 0.0) {
+                        amrex::OutStream() << std::setw(wc+2)
+                                           << it->cnt[imisses]*cache_line_bytes/it->cells;
+                    } else {
+                        amrex::OutStream() << std::setw(wc+2) << "-";
+                    }
+                }
+                amrex::OutStream() << "\n";
+            }
+            amrex::OutStream() << chline << "\n";
+        }
+
         amrex::OutStream() << std::endl;
     }
 }
@@ -538,6 +1170,7 @@ void
 TinyProfiler::StartRegion (std::string regname) noexcept
 {
     if (std::find(regionstack.begin(), regionstack.end(), regname) == regionstack.end()) {
+        regionidstack.push_back(internName(regname));
         regionstack.emplace_back(std::move(regname));
     }
 }
@@ -547,6 +1180,7 @@ TinyProfiler::StopRegion (const std::string& regname) noexcept
 {
     if (regname == regionstack.back()) {
         regionstack.pop_back();
+        regionidstack.pop_back();
     }
 }
 
@@ -576,6 +1210,12 @@ void
 TinyProfiler::PrintCallStack (std::ostream& os)
 {
     os << "===== TinyProfilers ======\n";
+    if (per_thread) {
+        for (auto const& f : threadData().stack) {
+            os << names[f.id] << "\n";
+        }
+        return;
+    }
     for (auto const& x : ttstack) {
         os << *(std::get<2>(x)) << "\n";
     }
@@ -51,6 +51,36 @@ int VisMF::nMFFileInStreams(4);
 namespace
 {
     bool initialized = false;
+
+    // Copy the FABs, ghost cells included, of the boxes that are not
+    // skipped in src or dst.
+    void copyNotSkipped (FabArray<FArrayBox>& dst, const FabArray<FArrayBox>& src)
+    {
+        const FabArrayBase& fa = src.hasSkippedBoxes() ? static_cast<const FabArrayBase&>(src) : dst;
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(fa); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.fabbox();
+            auto const& s = src.const_array(mfi);
+            auto const& d = dst.array(mfi);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D (bx, src.nComp(), i, j, k, n,
+            {
+                d(i,j,k,n) = s(i,j,k,n);
+            });
+        }
+    }
+
+    // A copy of mf whose skipped boxes are filled with its covered value.
+    FabArray<FArrayBox> fillSkippedBoxes (const FabArray<FArrayBox>& mf)
+    {
+        FabArray<FArrayBox> r(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrowVect(),
+                              MFInfo().SetArena(mf.arena()));
+        r.setVal(mf.coveredValue());
+        copyNotSkipped(r, mf);
+        return r;
+    }
 }
 
 void
@@ -946,6 +976,10 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
     BL_ASSERT(currentVersion != VisMF::Header::Undefined_v1);
 
+    if (mf.hasSkippedBoxes()) {
+        return Write(fillSkippedBoxes(mf), mf_name, how, set_ghost);
+    }
+
     // ---- add stream retry
     // ---- add stream buffer (to nfiles)
     RealDescriptor *whichRD = nullptr;
@@ -1490,6 +1524,14 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 {
     BL_PROFILE("VisMF::Read()");
 
+    if (mf.hasSkippedBoxes()) {
+        FabArray<FArrayBox> tmp(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrowVect(),
+                                MFInfo().SetArena(mf.arena()));
+        Read(tmp, mf_name, faHeader, coordinatorProc, allow_empty_mf);
+        copyNotSkipped(mf, tmp);
+        return;
+    }
+
     VisMF::Header hdr;
     Real hEndTime, hStartTime, faCopyTime(0.0);
     Real startTime(amrex::second());
@@ -2178,6 +2220,10 @@ void VisMF::CloseAllStreams() {
 void
 VisMF::AsyncWrite (const FabArray<FArrayBox>& mf, const std::string& mf_name, bool valid_cells_only)
 {
+    if (mf.hasSkippedBoxes()) {
+        AsyncWrite(fillSkippedBoxes(mf), mf_name, valid_cells_only);
+        return;
+    }
     if (AsyncOut::UseAsyncOut()) {
         AsyncWriteDoit(mf, mf_name, false, valid_cells_only);
     } else {
@@ -2194,6 +2240,10 @@ VisMF::AsyncWrite (const FabArray<FArrayBox>& mf, const std::string& mf_name, bo
 void
 VisMF::AsyncWrite (FabArray<FArrayBox>&& mf, const std::string& mf_name, bool valid_cells_only)
 {
+    if (mf.hasSkippedBoxes()) {
+        AsyncWrite(fillSkippedBoxes(mf), mf_name, valid_cells_only);
+        return;
+    }
     if (AsyncOut::UseAsyncOut()) {
         AsyncWriteDoit(mf, mf_name, true, valid_cells_only);
     } else {
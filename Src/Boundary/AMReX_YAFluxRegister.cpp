@@ -11,26 +11,23 @@ namespace amrex {
 YAFluxRegister::YAFluxRegister (const BoxArray& fba, const BoxArray& cba,
                                 const DistributionMapping& fdm, const DistributionMapping& cdm,
                                 const Geometry& fgeom, const Geometry& cgeom,
-                                const IntVect& ref_ratio, int fine_lev, int nvar)
+                                const IntVect& ref_ratio, int fine_lev, int nvar, bool sparse)
 {
-    define(fba, cba, fdm, cdm, fgeom, cgeom, ref_ratio, fine_lev, nvar);
+    define(fba, cba, fdm, cdm, fgeom, cgeom, ref_ratio, fine_lev, nvar, sparse);
 }
 
 void
 YAFluxRegister::define (const BoxArray& fba, const BoxArray& cba,
                         const DistributionMapping& fdm, const DistributionMapping& cdm,
                         const Geometry& fgeom, const Geometry& cgeom,
-                        const IntVect& ref_ratio, int fine_lev, int nvar)
+                        const IntVect& ref_ratio, int fine_lev, int nvar, bool sparse)
 {
     m_fine_geom = fgeom;
     m_crse_geom = cgeom;
     m_ratio = ref_ratio;
     m_fine_level = fine_lev;
     m_ncomp = nvar;
-
-    m_crse_data.define(cba, cdm, nvar, 0, MFInfo(), FArrayBoxFactory());
-
-    m_crse_flag.define(cba, cdm, 1, 1, MFInfo(), DefaultFabFactory<IArrayBox>());
+    m_sparse = sparse;
 
     const auto& cperiod = m_crse_geom.periodicity();
     const std::vector<IntVect>& pshifts = cperiod.shiftIntVect();
@@ -45,10 +42,22 @@ YAFluxRegister::define (const BoxArray& fba, const BoxArray& cba,
         }
     }
 
-    m_crse_fab_flag.resize(m_crse_flag.local_size(), crse_cell);
-
-    m_crse_flag.setVal(crse_cell);
+    if (m_sparse)
     {
+        m_crse_data.clear();
+        m_crse_flag.clear();
+        defineCrseShell(cba, cdm, cfba);
+    }
+    else
+    {
+        m_crse_data.define(cba, cdm, nvar, 0, MFInfo(), FArrayBoxFactory());
+
+        m_crse_flag.define(cba, cdm, 1, 1, MFInfo(), DefaultFabFactory<IArrayBox>());
+
+        m_crse_fab_flag.resize(m_crse_flag.local_size(), crse_cell);
+
+        m_crse_flag.setVal(crse_cell);
+
         iMultiFab foo(cfba, fdm, 1, 1, MFInfo().SetAlloc(false));
         const FabArrayBase::CPC& cpc1 = m_crse_flag.getCPC(IntVect(1), foo, IntVect(1), cperiod);
         m_crse_flag.setVal(crse_fine_boundary_cell, cpc1, 0, 1);
@@ -220,10 +229,135 @@ YAFluxRegister::define (const BoxArray& fba, const BoxArray& cba,
 }
 
 
+void
+YAFluxRegister::defineCrseShell (const BoxArray& cba, const DistributionMapping& cdm,
+                                 const BoxArray& cfba)
+{
+    BL_PROFILE("YAFluxRegister::defineCrseShell()");
+
+    const std::vector<IntVect>& pshifts = m_crse_geom.periodicity().shiftIntVect();
+    const int myproc = ParallelDescriptor::MyProc();
+
+    BoxArray gcfba = cfba;
+    gcfba.grow(1);
+
+    // The coarse cells within one cell of the fine level, but not covered by it,
+    // split by the coarse boxes.
+    BoxList shell_bl;
+    Vector<int> shell_procmap;
+    m_crse_shell_cidx.clear();
+    Vector<int> crse_localindex(cba.size(), -1);
+    int ncrse_local = 0;
+    {
+        std::vector< std::pair<int,Box> > isects;
+        BoxList bl_tmp;
+        for (int i = 0, N = cba.size(); i < N; ++i)
+        {
+            if (cdm[i] == myproc) crse_localindex[i] = ncrse_local++;
+
+            const Box& cbx = cba[i];
+            BoxList bl;
+            for (const auto& iv : pshifts)
+            {
+                gcfba.intersections(cbx+iv, isects);
+                for (const auto& is : isects) {
+                    bl.push_back(is.second-iv);
+                }
+            }
+            if (bl.isEmpty()) continue;
+
+            BoxArray ba(std::move(bl));
+            ba.removeOverlap();
+            for (int j = 0, M = ba.size(); j < M; ++j)
+            {
+                cfba.complementIn(bl_tmp, ba[j]);
+                for (const Box& b : bl_tmp) {
+                    shell_bl.push_back(b);
+                    shell_procmap.push_back(cdm[i]);
+                    m_crse_shell_cidx.push_back(i);
+                }
+            }
+        }
+    }
+
+    BoxArray shell_ba(std::move(shell_bl));
+    DistributionMapping shell_dm(std::move(shell_procmap));
+    m_crse_shell.define(shell_ba, shell_dm, m_ncomp, 0, MFInfo(), FArrayBoxFactory());
+
+    m_crse_fab_flag.assign(ncrse_local, crse_cell);
+    m_crse_shell_lid.clear();
+    m_crse_shell_lid.resize(ncrse_local);
+    for (MFIter mfi(m_crse_shell); mfi.isValid(); ++mfi)
+    {
+        const int cli = crse_localindex[m_crse_shell_cidx[mfi.index()]];
+        m_crse_shell_lid[cli].push_back(mfi.LocalIndex());
+    }
+
+    // Faces shared with fine cells
+    m_crse_shell_cells.clear();
+    m_crse_shell_cells.resize(m_crse_shell.local_size());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        std::vector< std::pair<int,Box> > isects;
+        IArrayBox fine;
+        Vector<CrseCell> cells;
+        for (MFIter mfi(m_crse_shell); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            fine.resize(amrex::grow(bx,1));
+            fine.setVal<RunOn::Host>(0);
+            for (const auto& iv : pshifts)
+            {
+                cfba.intersections(fine.box()+iv, isects);
+                for (const auto& is : isects) {
+                    fine.setVal<RunOn::Host>(1, is.second-iv);
+                }
+            }
+
+            Array4<int const> const& f = fine.const_array();
+            cells.clear();
+            amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+            {
+                const IntVect c(AMREX_D_DECL(i,j,k));
+                int faces = 0;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+                {
+                    const IntVect e = IntVect::TheDimensionVector(idim);
+                    if (f(c-e)) {
+                        faces |= 1 << (2*idim);
+                    } else if (f(c+e)) {
+                        faces |= 1 << (2*idim+1);
+                    }
+                }
+                if (faces) cells.push_back(CrseCell{Dim3{i,j,k},faces});
+            });
+
+            auto& dv = m_crse_shell_cells[mfi.LocalIndex()];
+            dv.resize(cells.size());
+            Gpu::copy(Gpu::hostToDevice, cells.begin(), cells.end(), dv.begin());
+        }
+    }
+
+    for (int cli = 0; cli < ncrse_local; ++cli) {
+        for (int sli : m_crse_shell_lid[cli]) {
+            if (!m_crse_shell_cells[sli].empty()) {
+                m_crse_fab_flag[cli] = crse_fine_boundary_cell;
+            }
+        }
+    }
+}
+
+
 void
 YAFluxRegister::reset ()
 {
-    m_crse_data.setVal(0.0);
+    if (m_sparse) {
+        m_crse_shell.setVal(0.0);
+    } else {
+        m_crse_data.setVal(0.0);
+    }
     m_cfpatch.setVal(0.0);
 }
 
@@ -233,14 +367,14 @@ YAFluxRegister::CrseAdd (const MFIter& mfi,
                          const std::array<FArrayBox const*, AMREX_SPACEDIM>& flux,
                          const Real* dx, Real dt, RunOn runon) noexcept
 {
-    BL_ASSERT(m_crse_data.nComp() == flux[0]->nComp());
+    BL_ASSERT(m_ncomp == flux[0]->nComp());
 
     if (m_crse_fab_flag[mfi.LocalIndex()] == crse_cell) {
         return;  // this coarse fab is not close to fine fabs.
     }
 
     const Box& bx = mfi.tilebox();
-    const int nc = m_crse_data.nComp();
+    const int nc = m_ncomp;
     AMREX_D_TERM(const Real dtdx = dt/dx[0];,
                  const Real dtdy = dt/dx[1];,
                  const Real dtdz = dt/dx[2];);
@@ -248,13 +382,40 @@ YAFluxRegister::CrseAdd (const MFIter& mfi,
                  FArrayBox const* fy = flux[1];,
                  FArrayBox const* fz = flux[2];);
 
-    auto fab = m_crse_data.array(mfi);
-    auto const flag = m_crse_flag.array(mfi);
-
     AMREX_D_TERM(Array4<Real const> fxarr = fx->const_array();,
                  Array4<Real const> fyarr = fy->const_array();,
                  Array4<Real const> fzarr = fz->const_array(););
 
+    if (m_sparse)
+    {
+        const Dim3 lo = amrex::lbound(bx);
+        const Dim3 hi = amrex::ubound(bx);
+        for (int sli : m_crse_shell_lid[mfi.LocalIndex()])
+        {
+            FArrayBox& sfab = m_crse_shell.atLocalIdx(sli);
+            if (!bx.intersects(sfab.box())) continue;
+            auto fab = sfab.array();
+            CrseCell const* cells = m_crse_shell_cells[sli].data();
+            const int ncells = m_crse_shell_cells[sli].size();
+            AMREX_HOST_DEVICE_FOR_1D_FLAG ( runon, ncells, icell,
+            {
+                const Dim3 iv = cells[icell].iv;
+                if (iv.x >= lo.x && iv.x <= hi.x &&
+                    iv.y >= lo.y && iv.y <= hi.y &&
+                    iv.z >= lo.z && iv.z <= hi.z)
+                {
+                    yafluxreg_crseadd_cell(AMREX_D_DECL(iv.x,iv.y,iv.z), cells[icell].faces, fab,
+                                           AMREX_D_DECL(fxarr,fyarr,fzarr),
+                                           AMREX_D_DECL(dtdx,dtdy,dtdz),nc);
+                }
+            });
+        }
+        return;
+    }
+
+    auto fab = m_crse_data.array(mfi);
+    auto const flag = m_crse_flag.array(mfi);
+
     AMREX_LAUNCH_HOST_DEVICE_LAMBDA_FLAG ( runon, bx, tbx,
     {
         yafluxreg_crseadd(tbx, fab, flag, AMREX_D_DECL(fxarr,fyarr,fzarr),
@@ -365,9 +526,31 @@ YAFluxRegister::Reflux (MultiFab& state, int dc)
         }
     }
 
+    BL_ASSERT(state.nComp() >= dc + m_ncomp);
+
+    if (m_sparse)
+    {
+        m_crse_shell.ParallelCopy(m_cfpatch, m_crse_geom.periodicity(), FabArrayBase::ADD);
+
+        const int ncomp = m_ncomp;
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(m_crse_shell); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            auto const sfab = m_crse_shell.const_array(mfi);
+            auto       dfab = state[m_crse_shell_cidx[mfi.index()]].array();
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+            {
+                dfab(i,j,k,n+dc) += sfab(i,j,k,n);
+            });
+        }
+        return;
+    }
+
     m_crse_data.ParallelCopy(m_cfpatch, m_crse_geom.periodicity(), FabArrayBase::ADD);
 
-    BL_ASSERT(state.nComp() >= dc + m_ncomp);
     MultiFab::Add(state, m_crse_data, 0, dc, m_ncomp, 0);
 }
 
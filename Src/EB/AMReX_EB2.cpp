@@ -10,8 +10,17 @@
 #include <AMReX_EB2_GeometryShop.H>
 #include <AMReX_EB2.H>
 #include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
 #include <AMReX.H>
 #include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace amrex { namespace EB2 {
 
@@ -63,11 +72,216 @@ const IndexSpace* TopIndexSpaceIfPresent() noexcept {
     return nullptr;
 }
 
+void
+writeIndexSpace (const std::string& dirname, const Vector<Geometry>& geom,
+                 const Vector<Level const*>& level)
+{
+    BL_PROFILE("EB2::writeIndexSpace()");
+
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(dirname, 0755)) {
+            amrex::CreateDirectoryFailed(dirname);
+        }
+    }
+    ParallelDescriptor::Barrier();
+
+    for (int ilev = 0; ilev < level.size(); ++ilev) {
+        level[ilev]->write(dirname + "/Level_" + std::to_string(ilev));
+    }
+
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ofstream ofs(dirname+"/Header");
+        if (!ofs.good()) amrex::FileOpenFailed(dirname+"/Header");
+        ofs.precision(17);
+        ofs << "EB2::IndexSpace-V1\n"
+            << level.size() << '\n';
+        for (int ilev = 0; ilev < level.size(); ++ilev) {
+            ofs << geom[ilev] << '\n';
+        }
+    }
+    ParallelDescriptor::Barrier();
+}
+
+IndexSpaceFile::IndexSpaceFile (const std::string& dirname)
+{
+    BL_PROFILE("EB2::IndexSpaceFile()");
+
+    Vector<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(dirname+"/Header", fileCharPtr);
+    std::istringstream is(fileCharPtr.dataPtr(), std::istringstream::in);
+
+    std::string version;
+    int nlevels;
+    is >> version >> nlevels;
+    if (version != "EB2::IndexSpace-V1") {
+        amrex::Abort("IndexSpaceFile: unknown version "+version+" in "+dirname);
+    }
+
+    m_level.reserve(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        Geometry geom;
+        is >> geom;
+        m_geom.push_back(geom);
+        m_domain.push_back(geom.Domain());
+        m_level.emplace_back(this, geom, dirname + "/Level_" + std::to_string(ilev));
+    }
+}
+
+const Level&
+IndexSpaceFile::getLevel (const Geometry& geom) const
+{
+    auto it = std::find(std::begin(m_domain), std::end(m_domain), geom.Domain());
+    int i = std::distance(m_domain.begin(), it);
+    return m_level[i];
+}
+
+const Geometry&
+IndexSpaceFile::getGeometry (const Box& dom) const
+{
+    auto it = std::find(std::begin(m_domain), std::end(m_domain), dom);
+    int i = std::distance(m_domain.begin(), it);
+    return m_geom[i];
+}
+
+void
+IndexSpaceFile::write (const std::string& dirname) const
+{
+    Vector<Level const*> level;
+    for (auto const& lev : m_level) {
+        level.push_back(&lev);
+    }
+    writeIndexSpace(dirname, m_geom, level);
+}
+
+namespace {
+    std::string cacheName (const std::string& cache_dir, const std::string& cache_key)
+    {
+        // 64-bit FNV-1a.  std::hash is not used because its value may
+        // differ between compilers.
+        std::uint64_t h = 14695981039346656037ULL;
+        for (char c : cache_key) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ULL;
+        }
+        std::ostringstream os;
+        os << cache_dir << "/eb2_" << std::hex << std::setw(16) << std::setfill('0') << h;
+        return os.str();
+    }
+}
+
+std::string
+cacheKey (const std::string& key, const Geometry& geom,
+          int required_coarsening_level, int max_coarsening_level,
+          int ngrow, bool build_coarse_level_by_coarsening)
+{
+    Real small_volfrac = 1.e-14;
+    {
+        ParmParse pp("eb2");
+        pp.query("small_volfrac", small_volfrac);
+    }
+
+    std::ostringstream os;
+    os.precision(17);
+    os << key << '\n'
+       << geom << '\n'
+       << required_coarsening_level << ' ' << max_coarsening_level << ' '
+       << ngrow << ' ' << build_coarse_level_by_coarsening << ' '
+       << EB2::max_grid_size << ' ' << small_volfrac << ' '
+       << AMREX_SPACEDIM << ' ' << sizeof(Real) << '\n';
+    return os.str();
+}
+
+bool
+readFromCache (const std::string& cache_dir, const std::string& cache_key)
+{
+    BL_PROFILE("EB2::readFromCache()");
+
+    const std::string& name = cacheName(cache_dir, cache_key);
+
+    // The Key file is written last.  Its absence means there is no
+    // complete index space in the directory.
+    int found = 0;
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ifstream ifs(name+"/Key");
+        if (ifs.good()) {
+            std::stringstream ss;
+            ss << ifs.rdbuf();
+            found = (ss.str() == cache_key);
+        }
+    }
+    ParallelDescriptor::Bcast(&found, 1, ParallelDescriptor::IOProcessorNumber());
+
+    if (found) {
+        IndexSpace::push(new IndexSpaceFile(name));
+    }
+    return found;
+}
+
+void
+writeToCache (const std::string& cache_dir, const std::string& cache_key)
+{
+    BL_PROFILE("EB2::writeToCache()");
+
+    const std::string& name = cacheName(cache_dir, cache_key);
+
+    if (ParallelDescriptor::IOProcessor()) {
+        std::remove((name+"/Key").c_str());
+    }
+
+    IndexSpace::top().write(name);
+
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ofstream ofs(name+"/Key");
+        if (!ofs.good()) amrex::FileOpenFailed(name+"/Key");
+        ofs << cache_key;
+    }
+    ParallelDescriptor::Barrier();
+}
+
 void
 Build (const Geometry& geom, int required_coarsening_level,
        int max_coarsening_level, int ngrow, bool build_coarse_level_by_coarsening)
 {
     ParmParse pp("eb2");
+
+    // If eb2.cache_dir is given, the index space is read from there if
+    // it has been built with the same geometry before.  The key is made of
+    // geom_type and the parameters of its shape below.  cacheKey adds
+    // eb2.small_volfrac and eb2.max_grid_size.
+    std::string cache_dir;
+    pp.query("cache_dir", cache_dir);
+    std::string cache_key;
+    if (!cache_dir.empty())
+    {
+        static const std::map<std::string,std::vector<std::string> > shape_params {
+            {"all_regular", {}},
+            {"box",         {"box_lo", "box_hi", "box_has_fluid_inside"}},
+            {"cylinder",    {"cylinder_center", "cylinder_radius", "cylinder_height",
+                             "cylinder_direction", "cylinder_has_fluid_inside"}},
+            {"plane",       {"plane_point", "plane_normal"}},
+            {"sphere",      {"sphere_center", "sphere_radius", "sphere_has_fluid_inside"}},
+            {"torus",       {"torus_center", "torus_small_radius", "torus_large_radius"}}
+        };
+
+        std::string geom_type;
+        pp.get("geom_type", geom_type);
+        std::string key = "eb2.geom_type = " + geom_type + '\n';
+        auto it = shape_params.find(geom_type);
+        if (it != shape_params.end()) {
+            for (auto const& name : it->second) {
+                Vector<std::string> v;
+                if (pp.queryarr(name.c_str(), v)) {
+                    key += "eb2." + name + " =";
+                    for (auto const& x : v) key += ' ' + x;
+                    key += '\n';
+                }
+            }
+        }
+        cache_key = cacheKey(key, geom, required_coarsening_level, max_coarsening_level,
+                             ngrow, build_coarse_level_by_coarsening);
+        if (readFromCache(cache_dir, cache_key)) return;
+    }
+
     std::string geom_type;
     pp.get("geom_type", geom_type);
 
@@ -174,6 +388,10 @@ Build (const Geometry& geom, int required_coarsening_level,
     {
         amrex::Abort("geom_type "+geom_type+ " not supported");
     }
+
+    if (!cache_dir.empty()) {
+        writeToCache(cache_dir, cache_key);
+    }
 }
 
 namespace {
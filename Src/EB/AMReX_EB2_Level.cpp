@@ -1,7 +1,10 @@
 
 #include <AMReX_EB2_Level.H>
 #include <AMReX_IArrayBox.H>
+#include <AMReX_Utility.H>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
@@ -869,4 +872,136 @@ Level::fillLevelSet (MultiFab& levelset, const Geometry& geom) const
     }
 }
         
+void
+Level::write (const std::string& dirname) const
+{
+    BL_PROFILE("EB2::Level::write()");
+
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(dirname, 0755)) {
+            amrex::CreateDirectoryFailed(dirname);
+        }
+
+        std::ofstream ofs(dirname+"/Header");
+        if (!ofs.good()) amrex::FileOpenFailed(dirname+"/Header");
+        ofs << m_allregular << '\n'
+            << m_ngrow << '\n'
+            << m_cellflag.nGrow() << ' ' << m_levelset.nGrow() << '\n';
+        // BoxArray::readFrom cannot read an empty BoxArray.
+        for (auto const* ba : {&m_grids, &m_covered_grids}) {
+            ofs << ba->size() << '\n';
+            if (!ba->empty()) {
+                ba->writeOn(ofs);
+                ofs << '\n';
+            }
+        }
+    }
+    ParallelDescriptor::Barrier();
+
+    if (m_allregular) return;
+
+    // The flags are stored in two components of 16 bits each so that
+    // they are represented exactly even if Real is float.
+    MultiFab cellflag(m_grids, m_dmap, 2, m_cellflag.nGrow());
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(cellflag); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        auto const& flag = m_cellflag.const_array(mfi);
+        auto const& fab = cellflag.array(mfi);
+        AMREX_HOST_DEVICE_FOR_3D ( bx, i, j, k,
+        {
+            const uint32_t v = flag(i,j,k).getValue();
+            fab(i,j,k,0) = static_cast<Real>(v & 0xFFFFu);
+            fab(i,j,k,1) = static_cast<Real>(v >> 16);
+        });
+    }
+
+    VisMF::Write(cellflag, dirname+"/CellFlag");
+    VisMF::Write(m_volfrac, dirname+"/VolFrac");
+    VisMF::Write(m_centroid, dirname+"/Centroid");
+    VisMF::Write(m_bndryarea, dirname+"/BndryArea");
+    VisMF::Write(m_bndrycent, dirname+"/BndryCent");
+    VisMF::Write(m_bndrynorm, dirname+"/BndryNorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        VisMF::Write(m_areafrac[idim], dirname+"/AreaFrac_"+std::to_string(idim));
+        VisMF::Write(m_facecent[idim], dirname+"/FaceCent_"+std::to_string(idim));
+    }
+    VisMF::Write(m_levelset, dirname+"/LevelSet");
+}
+
+FileLevel::FileLevel (IndexSpace const* is, const Geometry& geom, const std::string& dirname)
+    : Level(is, geom)
+{
+    BL_PROFILE("EB2::FileLevel()");
+
+    int ng, ng_levelset;
+    {
+        Vector<char> fileCharPtr;
+        ParallelDescriptor::ReadAndBcastFile(dirname+"/Header", fileCharPtr);
+        std::istringstream iss(fileCharPtr.dataPtr(), std::istringstream::in);
+        iss >> m_allregular >> m_ngrow >> ng >> ng_levelset;
+        for (auto* ba : {&m_grids, &m_covered_grids}) {
+            Long nboxes;
+            iss >> nboxes;
+            if (nboxes > 0) ba->readFrom(iss);
+        }
+    }
+
+    m_ok = true;
+
+    if (m_allregular) return;
+
+    m_dmap.define(m_grids);
+
+    MultiFab cellflag(m_grids, m_dmap, 2, ng);
+    VisMF::Read(cellflag, dirname+"/CellFlag");
+
+    MFInfo mf_info;
+    mf_info.SetTag("EB2::Level");
+    m_cellflag.define(m_grids, m_dmap, 1, ng, mf_info);
+    m_volfrac.define(m_grids, m_dmap, 1, ng, mf_info);
+    m_centroid.define(m_grids, m_dmap, AMREX_SPACEDIM, ng, mf_info);
+    m_bndryarea.define(m_grids, m_dmap, 1, ng, mf_info);
+    m_bndrycent.define(m_grids, m_dmap, AMREX_SPACEDIM, ng, mf_info);
+    m_bndrynorm.define(m_grids, m_dmap, AMREX_SPACEDIM, ng, mf_info);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        m_areafrac[idim].define(amrex::convert(m_grids, IntVect::TheDimensionVector(idim)),
+                                m_dmap, 1, ng, mf_info);
+        m_facecent[idim].define(amrex::convert(m_grids, IntVect::TheDimensionVector(idim)),
+                                m_dmap, AMREX_SPACEDIM-1, ng, mf_info);
+    }
+    m_levelset.define(amrex::convert(m_grids,IntVect::TheNodeVector()), m_dmap, 1, ng_levelset, mf_info);
+
+    VisMF::Read(m_volfrac, dirname+"/VolFrac");
+    VisMF::Read(m_centroid, dirname+"/Centroid");
+    VisMF::Read(m_bndryarea, dirname+"/BndryArea");
+    VisMF::Read(m_bndrycent, dirname+"/BndryCent");
+    VisMF::Read(m_bndrynorm, dirname+"/BndryNorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        VisMF::Read(m_areafrac[idim], dirname+"/AreaFrac_"+std::to_string(idim));
+        VisMF::Read(m_facecent[idim], dirname+"/FaceCent_"+std::to_string(idim));
+    }
+    VisMF::Read(m_levelset, dirname+"/LevelSet");
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(cellflag); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        auto const& flag = m_cellflag.array(mfi);
+        auto const& fab = cellflag.const_array(mfi);
+        AMREX_HOST_DEVICE_FOR_3D ( bx, i, j, k,
+        {
+            const uint32_t lo = static_cast<uint32_t>(fab(i,j,k,0));
+            const uint32_t hi = static_cast<uint32_t>(fab(i,j,k,1));
+            flag(i,j,k) = EBCellFlag(lo | (hi << 16));
+        });
+    }
+}
+
+
 }}
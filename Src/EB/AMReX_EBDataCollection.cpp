@@ -2,9 +2,13 @@
 #include <AMReX_EBDataCollection.H>
 #include <AMReX_MultiFab.H>
 #include <AMReX_MultiCutFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_EBFabFactory.H>
 
 #include <AMReX_EB2_Level.H>
 
+#include <algorithm>
+
 namespace amrex {
 
 EBDataCollection::EBDataCollection (const EB2::Level& a_level,
@@ -24,6 +28,23 @@ EBDataCollection::EBDataCollection (const EB2::Level& a_level,
         m_cellflags = new FabArray<EBCellFlagFab>(a_ba, a_dm, 1, m_ngrow[0], MFInfo(),
                                                   DefaultFabFactory<EBCellFlagFab>());
         a_level.fillEBCellFlag(*m_cellflags, m_geom);
+
+        bool skip_covered = false;
+        ParmParse pp("eb2");
+        pp.query("skip_covered_boxes", skip_covered);
+        if (skip_covered)
+        {
+            Vector<int> covered(a_ba.size(), 0);
+            for (MFIter mfi(*m_cellflags); mfi.isValid(); ++mfi) {
+                if ((*m_cellflags)[mfi].getType(mfi.validbox()) == FabType::covered) {
+                    covered[mfi.index()] = 1;
+                }
+            }
+            ParallelDescriptor::ReduceIntMax(covered.data(), static_cast<int>(covered.size()));
+            if (std::find(covered.begin(), covered.end(), 1) != covered.end()) {
+                m_skipped = std::make_shared<SkippedBoxes>(Vector<char>(covered.begin(), covered.end()));
+            }
+        }
     }
 
     if (m_support >= EBSupport::volume)
@@ -59,6 +80,15 @@ EBDataCollection::EBDataCollection (const EB2::Level& a_level,
     }
 }
 
+void
+EBDataCollection::getBoxCosts (LayoutData<Real>& cost, const EBCostCoefficients& coef) const
+{
+    AMREX_ASSERT(m_cellflags != nullptr);
+    for (MFIter mfi(cost); mfi.isValid(); ++mfi) {
+        cost[mfi] = EBBoxCost((*m_cellflags)[mfi], mfi.validbox(), coef);
+    }
+}
+
 EBDataCollection::~EBDataCollection ()
 {
     delete m_cellflags;
@@ -4,6 +4,9 @@
 #include <AMReX_EBFArrayBox.H>
 #include <AMReX_EBCellFlag.H>
 #include <AMReX_FabArray.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Loop.H>
+#include <AMReX_Reduce.H>
 
 #include <AMReX_EB2_Level.H>
 #include <AMReX_EB2.H>
@@ -32,11 +35,23 @@ EBFArrayBoxFactory::create (const Box& box, int ncomps,
     }
     else
     {
+        const auto& skipped = m_ebdc->skippedBoxes();
+        if (skipped && skipped->skip[box_index]) {
+            return new EBFArrayBox(info.arena);
+        }
         const EBCellFlagFab& ebcellflag = m_ebdc->getMultiEBCellFlagFab()[box_index];
         return new EBFArrayBox(ebcellflag, box, ncomps, info.arena);
     }
 }
 
+FArrayBox*
+EBFArrayBoxFactory::create_skipped (const Box& box, int ncomps,
+                                    const FabInfo& info, int box_index) const
+{
+    const EBCellFlagFab& ebcellflag = m_ebdc->getMultiEBCellFlagFab()[box_index];
+    return new EBFArrayBox(ebcellflag, box, ncomps, info.arena);
+}
+
 FArrayBox*
 EBFArrayBoxFactory::create_alias (FArrayBox const& rhs, int scomp, int ncomp) const
 {
@@ -77,6 +92,14 @@ EBFArrayBoxFactory::isAllRegular () const noexcept
     return m_parent->isAllRegular();
 }
 
+LayoutData<Real>
+EBFArrayBoxFactory::getBoxCosts (const EBCostCoefficients& coef) const
+{
+    LayoutData<Real> cost(boxArray(), DistributionMap());
+    m_ebdc->getBoxCosts(cost, coef);
+    return cost;
+}
+
 EB2::IndexSpace const*
 EBFArrayBoxFactory::getEBIndexSpace () const noexcept
 {
@@ -106,6 +129,113 @@ EBFArrayBoxFactory::boxArray () const noexcept
     return m_ebdc->getMultiEBCellFlagFab().boxArray();
 }
 
+EBCostCoefficients
+EBCostCoefficients::fromParmParse ()
+{
+    EBCostCoefficients coef;
+    ParmParse pp("eb2");
+    pp.query("cost_regular", coef.regular);
+    pp.query("cost_cut", coef.cut);
+    pp.query("cost_covered", coef.covered);
+    return coef;
+}
+
+namespace {
+// Weighted count of the cells in bx, with a device reduction if in a launch region.
+Real EBCellCost (Array4<EBCellFlag const> const& flag, const Box& bx, const EBCostCoefficients& coef)
+{
+    Long nregular = 0, ncovered = 0;
+    if (Gpu::inLaunchRegion())
+    {
+        ReduceOps<ReduceOpSum,ReduceOpSum> reduce_op;
+        ReduceData<Long,Long> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(bx, reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+        {
+            auto f = flag(i,j,k);
+            return {static_cast<Long>(f.isRegular()), static_cast<Long>(f.isCovered())};
+        });
+        ReduceTuple hv = reduce_data.value();
+        nregular = amrex::get<0>(hv);
+        ncovered = amrex::get<1>(hv);
+    }
+    else
+    {
+        amrex::LoopOnCpu(bx, [=,&nregular,&ncovered] (int i, int j, int k) noexcept
+        {
+            auto f = flag(i,j,k);
+            if (f.isRegular()) {
+                ++nregular;
+            } else if (f.isCovered()) {
+                ++ncovered;
+            }
+        });
+    }
+    const Long ncut = bx.numPts() - nregular - ncovered;
+    return coef.regular*nregular + coef.cut*ncut + coef.covered*ncovered;
+}
+}
+
+Real
+EBBoxCost (const EBCellFlagFab& flag, const Box& bx, const EBCostCoefficients& coef)
+{
+    const FabType typ = flag.getType(bx);
+    if (typ == FabType::regular) {
+        return coef.regular * bx.d_numPts();
+    } else if (typ == FabType::covered) {
+        return coef.covered * bx.d_numPts();
+    } else {
+        return EBCellCost(flag.const_array(), bx, coef);
+    }
+}
+
+Vector<Real>
+EBBoxCosts (const EB2::Level& eblev, const BoxArray& ba,
+            const EBCostCoefficients& coef)
+{
+    BL_PROFILE("EBBoxCosts()");
+
+    // The cells of eblev are covered in its covered boxes, and regular
+    // outside of its boxes.  The flags of its boxes are only looked at
+    // where they intersect ba, by the processes that own them.
+    const int N = ba.size();
+    Vector<Real> cost(N, 0.0);
+    for (int i = 0; i < N; ++i) {
+        cost[i] = coef.regular * ba[i].d_numPts();
+    }
+    if (eblev.isAllRegular()) return cost;
+
+    const BoxArray& covered_grids = eblev.coveredBoxArray();
+    if (!covered_grids.empty()) {
+        for (int i = 0; i < N; ++i) {
+            for (const auto& is : covered_grids.intersections(ba[i])) {
+                cost[i] += (coef.covered - coef.regular) * is.second.d_numPts();
+            }
+        }
+    }
+
+    Vector<Real> cut_cost(N, 0.0);
+    const FabArray<EBCellFlagFab>& flags = eblev.cellFlag();
+    std::vector<std::pair<int,Box> > isects;
+    for (MFIter mfi(flags); mfi.isValid(); ++mfi)
+    {
+        const auto& flagfab = flags[mfi];
+        const auto& a = flagfab.const_array();
+        ba.intersections(mfi.validbox(), isects);
+        for (const auto& is : isects) {
+            cut_cost[is.first] += EBCellCost(a, is.second, coef)
+                - coef.regular * is.second.d_numPts();
+        }
+    }
+    ParallelDescriptor::ReduceRealSum(cut_cost.data(), cut_cost.size());
+
+    for (int i = 0; i < N; ++i) {
+        cost[i] += cut_cost[i];
+    }
+    return cost;
+}
+
 std::unique_ptr<EBFArrayBoxFactory>
 makeEBFabFactory (const Geometry& a_geom,
                   const BoxArray& a_ba,
@@ -445,6 +445,7 @@ void LSCoreBase::ReadParameters () {
     ParmParse pp("eb_amr");
     pp.query("eb_pad", eb_pad);
     pp.query("max_eb_pad", max_eb_pad);
+    pp.query("fast_sweeping", use_fast_sweeping);
 
 }
 
@@ -16,6 +16,11 @@
 
 #include <AMReX_EB2.H>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
 namespace amrex {
 
 LSFactory::LSFactory(int lev, int ls_ref, int eb_ref, int ls_pad, int eb_pad,
@@ -730,6 +735,282 @@ void LSFactory::fill_data (MultiFab & data, iMultiFab & valid,
 
 
 
+namespace {
+
+    // Solves the Eikonal equation |grad(d)| = 1 at node (i,j,k) using the
+    // upwind (Godunov) discretization from the smallest neighbour in each
+    // direction.  Returns d(i,j,k) if it cannot be decreased.
+    AMREX_FORCE_INLINE
+    Real eikonal_update (Array4<Real const> const& d, Box const& bx,
+                         int i, int j, int k, const Real* dx) noexcept
+    {
+        constexpr Real inf = std::numeric_limits<Real>::max();
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        Array<Real,AMREX_SPACEDIM> a;
+        Array<Real,AMREX_SPACEDIM> h;
+        a[0] = std::min((i > lo.x) ? d(i-1,j,k) : inf, (i < hi.x) ? d(i+1,j,k) : inf);
+        h[0] = dx[0];
+#if (AMREX_SPACEDIM >= 2)
+        a[1] = std::min((j > lo.y) ? d(i,j-1,k) : inf, (j < hi.y) ? d(i,j+1,k) : inf);
+        h[1] = dx[1];
+#endif
+#if (AMREX_SPACEDIM == 3)
+        a[2] = std::min((k > lo.z) ? d(i,j,k-1) : inf, (k < hi.z) ? d(i,j,k+1) : inf);
+        h[2] = dx[2];
+#endif
+
+        // The solution is larger than the smallest neighbour
+        if (std::min({AMREX_D_DECL(a[0],a[1],a[2])}) >= d(i,j,k)) return d(i,j,k);
+
+        // Sort by the neighbour values
+        for (int m = 1; m < AMREX_SPACEDIM; ++m) {
+            for (int n = m; n > 0 && a[n] < a[n-1]; --n) {
+                std::swap(a[n], a[n-1]);
+                std::swap(h[n], h[n-1]);
+            }
+        }
+
+        if (a[0] == inf) return inf;
+
+        // Use the m smallest neighbours as long as the solution is larger
+        // than all of them.
+        Real u = a[0] + h[0];
+        Real A = 0.0, B = 0.0, C = -1.0;
+        for (int m = 0; m < AMREX_SPACEDIM; ++m) {
+            if (u <= a[m]) break;
+            const Real w = 1.0/(h[m]*h[m]);
+            A += w;
+            B -= 2.0*a[m]*w;
+            C += a[m]*a[m]*w;
+            const Real disc = B*B - 4.0*A*C;
+            if (disc < 0.0) break;
+            u = (-B + std::sqrt(disc)) / (2.0*A);
+        }
+        return u;
+    }
+
+    // One pass of 2^SPACEDIM Gauss-Seidel sweeps with alternating
+    // orderings.  Returns the largest decrease of d.
+    Real fast_sweep (Array4<Real> const& d, Array4<int const> const& fixed,
+                     Box const& bx, const Real* dx) noexcept
+    {
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        Real change = 0.0;
+        for (int sweep = 0; sweep < (1 << AMREX_SPACEDIM); ++sweep) {
+            const int si = (sweep & 1) ? -1 : 1;
+            const int sj = (sweep & 2) ? -1 : 1;
+            const int sk = (sweep & 4) ? -1 : 1;
+            for         (int kk = 0; kk <= hi.z-lo.z; ++kk) {
+                const int k = (sk > 0) ? lo.z+kk : hi.z-kk;
+                for     (int jj = 0; jj <= hi.y-lo.y; ++jj) {
+                    const int j = (sj > 0) ? lo.y+jj : hi.y-jj;
+                    for (int ii = 0; ii <= hi.x-lo.x; ++ii) {
+                        const int i = (si > 0) ? lo.x+ii : hi.x-ii;
+                        if (fixed(i,j,k)) continue;
+                        const Real u = eikonal_update(d, bx, i, j, k, dx);
+                        if (u < d(i,j,k)) {
+                            change = std::max(change, d(i,j,k)-u);
+                            d(i,j,k) = u;
+                        }
+                    }
+                }
+            }
+        }
+        return change;
+    }
+}
+
+
+
+void LSFactory::fill_data_sweep (MultiFab & data, iMultiFab & valid,
+                                 const EBFArrayBoxFactory & eb_factory,
+                                 const MultiFab & eb_impfunc,
+                                 int band, int ls_ref, int eb_ref,
+                                 const Geometry & geom, const Geometry & geom_eb,
+                                 int max_iter) {
+
+    BL_PROFILE("LSFactory::fill_data_sweep()");
+
+    RealVect dx(AMREX_D_DECL(geom.CellSize(0),
+                             geom.CellSize(1),
+                             geom.CellSize(2)));
+
+    RealVect dx_eb(AMREX_D_DECL(geom_eb.CellSize(0),
+                                geom_eb.CellSize(1),
+                                geom_eb.CellSize(2)));
+
+    const int ls_pad = data.nGrow();
+
+    const BoxArray & ls_ba            = data.boxArray();
+    const BoxArray & eb_ba            = eb_factory.boxArray();
+    const DistributionMapping & ls_dm = data.DistributionMap();
+
+    const MultiCutFab & bndrycent = eb_factory.getBndryCent();
+    const auto & flags = eb_factory.getMultiEBCellFlagFab();
+    const int eb_pad = flags.nGrow();
+
+    MultiFab normal(eb_ba, ls_dm, 3, eb_pad); //deliberately use levelset DM
+    amrex::FillEBNormals(normal, eb_factory, geom_eb);
+
+    const Real min_dx = LSUtility::min_dx(geom_eb);
+
+    // Distances are computed from the EB facets only for nodes within
+    // `init_pad` EB cells of the surface.  Any facet that close to a node is
+    // guaranteed to be found in a search box grown by `init_pad`.
+    const int  init_pad       = std::min(eb_pad, 2);
+    const Real init_threshold = min_dx * init_pad;
+    const Real ls_threshold   = min_dx * (band + 1);
+
+
+    /****************************************************************************
+     *                                                                          *
+     * Initialize: exact (signed) distances near the EB, `fixed` = 1 there.     *
+     * Everywhere else, `dist` starts at the threshold, so that the sweeps      *
+     * below never look beyond the band.                                        *
+     *                                                                          *
+     ***************************************************************************/
+
+    iMultiFab eb_valid(ls_ba, ls_dm, 1, ls_pad);
+    eb_valid.setVal(0);
+    iMultiFab fixed(ls_ba, ls_dm, 1, ls_pad);
+    MultiFab dist(ls_ba, ls_dm, 1, ls_pad);
+
+    // Small tiles, so that only few nodes are compared with each facet
+    const IntVect init_tile_size(AMREX_D_DECL(8,8,8));
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(data, init_tile_size); mfi.isValid(); ++mfi)
+    {
+        Box tile_box = mfi.growntilebox();
+
+        auto & ls_tile = data[mfi];
+        const auto & if_tile = eb_impfunc[mfi];
+        auto & v_tile = eb_valid[mfi];
+
+        if (bndrycent.ok(mfi)) {
+            // Search for facets around the ghost nodes as well
+            Box eb_search = tile_box;
+            eb_search.coarsen(ls_ref);
+            eb_search.refine(eb_ref);
+            eb_search.enclosedCells();
+            eb_search.grow(init_pad);
+            eb_search &= flags[mfi].box();
+
+            std::unique_ptr<Vector<Real>> facets = eb_facets(normal[mfi], bndrycent[mfi],
+                                                             flags[mfi], dx_eb, eb_search);
+            int len_facets = facets->size();
+
+            if (len_facets > 0) {
+                amrex_eb_fill_levelset(BL_TO_FORTRAN_BOX(tile_box),
+                                       facets->dataPtr(), & len_facets,
+                                       BL_TO_FORTRAN_3D(v_tile),
+                                       BL_TO_FORTRAN_3D(ls_tile),
+                                       dx.dataPtr(), dx_eb.dataPtr() );
+            } else {
+                ls_tile.setVal<RunOn::Host>(ls_threshold, tile_box);
+            }
+        } else {
+            ls_tile.setVal<RunOn::Host>(ls_threshold, tile_box);
+        }
+
+        amrex_eb_validate_levelset(BL_TO_FORTRAN_BOX(tile_box), & ls_ref,
+                                   BL_TO_FORTRAN_3D(if_tile),
+                                   BL_TO_FORTRAN_3D(v_tile),
+                                   BL_TO_FORTRAN_3D(ls_tile)   );
+
+        auto const& phi = data.const_array(mfi);
+        auto const& d   = dist.array(mfi);
+        auto const& fx  = fixed.array(mfi);
+        amrex::LoopOnCpu(tile_box, [&] (int i, int j, int k) noexcept
+        {
+            const Real a = std::abs(phi(i,j,k));
+            fx(i,j,k) = (a <= init_threshold);
+            d(i,j,k) = (a <= init_threshold) ? a : ls_threshold;
+        });
+    }
+
+
+    /****************************************************************************
+     *                                                                          *
+     * Fast sweeping: propagate the distance to the rest of the band, and       *
+     * across boxes by exchanging ghost nodes between passes.                   *
+     *                                                                          *
+     ***************************************************************************/
+
+    const Real tol = 1.e-10 * min_dx;
+    Real change = 0.0;
+    for (int iter = 0; iter < max_iter; ++iter)
+    {
+        dist.FillBoundary(geom.periodicity());
+
+        change = 0.0;
+#ifdef _OPENMP
+#pragma omp parallel reduction(max:change)
+#endif
+        for (MFIter mfi(dist); mfi.isValid(); ++mfi)
+        {
+            change = std::max(change, fast_sweep(dist.array(mfi), fixed.const_array(mfi),
+                                                 mfi.fabbox(), dx.dataPtr()));
+        }
+
+        ParallelDescriptor::ReduceRealMax(change);
+        if (change <= tol) break;
+    }
+    if (change > tol && ParallelDescriptor::IOProcessor()) {
+        amrex::Warning("LSFactory::fill_data_sweep: the level-set has not converged after "
+                       + std::to_string(max_iter) + " passes, the last changed it by "
+                       + std::to_string(change));
+    }
+
+    // The nodes on the faces shared by two boxes are swept in both, from
+    // different initial distances (found from different facets), so the two
+    // copies can differ.  Use the owner's, and refresh the ghost nodes.
+    dist.OverrideSync(geom.periodicity());
+    dist.FillBoundary(geom.periodicity());
+
+
+    /****************************************************************************
+     *                                                                          *
+     * Sign the swept distances using the implicit function, and flag nodes     *
+     * informed by the EB (i.e. within the band) as valid.                      *
+     *                                                                          *
+     ***************************************************************************/
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(data, true); mfi.isValid(); ++mfi)
+    {
+        const Box & tile_box = mfi.growntilebox();
+        auto const& phi  = data.array(mfi);
+        auto const& d    = dist.const_array(mfi);
+        auto const& fx   = fixed.const_array(mfi);
+        auto const& impf = eb_impfunc.const_array(mfi);
+        auto const& region = valid.array(mfi);
+        amrex::LoopOnCpu(tile_box, [&] (int i, int j, int k) noexcept
+        {
+            if (fx(i,j,k)) {
+                phi(i,j,k) = std::max(std::min(phi(i,j,k), ls_threshold), -ls_threshold);
+            } else {
+                phi(i,j,k) = (impf(i,j,k) <= 0.0) ? d(i,j,k) : -d(i,j,k);
+            }
+            if (d(i,j,k) < ls_threshold) region(i,j,k) = 1;
+        });
+    }
+
+    // Likewise for the distances of the nodes next to the EB, which are
+    // not swept.
+    data.OverrideSync(geom.periodicity());
+    data.FillBoundary(geom.periodicity());
+}
+
+
+
 void LSFactory::fill_data (MultiFab & data, iMultiFab & valid,
                            const MultiFab & mf_impfunc,
                            int eb_pad, const Geometry & eb_geom) {
@@ -914,6 +1195,41 @@ std::unique_ptr<iMultiFab> LSFactory::Fill(const EBFArrayBoxFactory & eb_factory
 
 
 
+std::unique_ptr<iMultiFab> LSFactory::FillSweep(const EBFArrayBoxFactory & eb_factory,
+                                                const MultiFab & mf_impfunc) {
+    return FillSweep(eb_factory, mf_impfunc, eb_grid_pad);
+}
+
+
+
+std::unique_ptr<iMultiFab> LSFactory::FillSweep(const EBFArrayBoxFactory & eb_factory,
+                                                const MultiFab & mf_impfunc,
+                                                int band, int max_iter) {
+
+    /****************************************************************************
+     *                                                                          *
+     * Returns: iMultiFab indicating region that has been filled by a valid     *
+     * level-set function (i.e. the value of the level-set was informed by      *
+     * nearby EB facets)                                                        *
+     *                                                                          *
+     ***************************************************************************/
+
+    std::unique_ptr<iMultiFab> region_valid = std::unique_ptr<iMultiFab>(new iMultiFab);
+    region_valid->define(ls_ba, ls_dm, 1, ls_grid_pad);
+    region_valid->setVal(0);
+
+
+    LSFactory::fill_data_sweep(* ls_grid, * region_valid, eb_factory, mf_impfunc,
+                               band, ls_grid_ref, eb_grid_ref, geom_ls, geom_eb, max_iter);
+
+
+    fill_valid();
+
+    return region_valid;
+}
+
+
+
 std::unique_ptr<iMultiFab> LSFactory::Fill(const MultiFab & mf_impfunc,
                                            bool apply_threshold) {
 
@@ -0,0 +1,605 @@
+
+#include <AMReX_WriteEBSurfacePLY.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_EBCellFlag.H>
+#include <AMReX_MultiCutFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+#include <AMReX_BLProfiler.H>
+#include <AMReX_Loop.H>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+namespace amrex {
+
+namespace {
+
+    using Vec3 = std::array<double,3>;
+    using Tri = std::array<int,3>;
+
+    Vec3 sub (const Vec3& a, const Vec3& b) noexcept {
+        return Vec3{{a[0]-b[0], a[1]-b[1], a[2]-b[2]}};
+    }
+
+    double dot (const Vec3& a, const Vec3& b) noexcept {
+        return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    }
+
+    Vec3 cross (const Vec3& a, const Vec3& b) noexcept {
+        return Vec3{{a[1]*b[2]-a[2]*b[1], a[2]*b[0]-a[0]*b[2], a[0]*b[1]-a[1]*b[0]}};
+    }
+
+    // The twelve edges of a cell as (corner, direction).
+    constexpr int cell_edges[12][4] = {
+        {0,0,0,0}, {0,1,0,0}, {0,0,1,0}, {0,1,1,0},
+        {0,0,0,1}, {1,0,0,1}, {0,0,1,1}, {1,0,1,1},
+        {0,0,0,2}, {1,0,0,2}, {0,1,0,2}, {1,1,0,2}
+    };
+
+    // Intersect the plane n.x = n.c with the edges of the unit-offset cell
+    // of size dx (coordinates relative to the low corner of the cell).
+    int cutCell (const Vec3& n, const Vec3& c, const Real* dx,
+                 std::array<Vec3,12>& pts, std::array<int,12>& edge)
+    {
+        const double d = dot(n,c);
+        int count = 0;
+        for (int e = 0; e < 12; ++e) {
+            const int dir = cell_edges[e][3];
+            if (std::abs(n[dir]) <= std::numeric_limits<double>::epsilon()) continue;
+            Vec3 p0{{cell_edges[e][0]*dx[0], cell_edges[e][1]*dx[1], cell_edges[e][2]*dx[2]}};
+            const double alpha = (d - dot(n,p0)) / (n[dir]*dx[dir]);
+            if (alpha > 0.0 && alpha < 1.0) {
+                p0[dir] += alpha*dx[dir];
+                pts[count] = p0;
+                edge[count] = e;
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    // Symmetric 4x4 quadric: aa ab ac ad bb bc bd cc cd dd
+    struct Quadric
+    {
+        std::array<double,10> q {{0.,0.,0.,0.,0.,0.,0.,0.,0.,0.}};
+
+        void addPlane (const Vec3& n, double d, double w) noexcept {
+            q[0] += w*n[0]*n[0]; q[1] += w*n[0]*n[1]; q[2] += w*n[0]*n[2]; q[3] += w*n[0]*d;
+            q[4] += w*n[1]*n[1]; q[5] += w*n[1]*n[2]; q[6] += w*n[1]*d;
+            q[7] += w*n[2]*n[2]; q[8] += w*n[2]*d;
+            q[9] += w*d*d;
+        }
+
+        Quadric& operator+= (const Quadric& rhs) noexcept {
+            for (int i = 0; i < 10; ++i) q[i] += rhs.q[i];
+            return *this;
+        }
+
+        double eval (const Vec3& p) const noexcept {
+            const double x = p[0], y = p[1], z = p[2];
+            return q[0]*x*x + 2.*q[1]*x*y + 2.*q[2]*x*z + 2.*q[3]*x
+                +  q[4]*y*y + 2.*q[5]*y*z + 2.*q[6]*y
+                +  q[7]*z*z + 2.*q[8]*z
+                +  q[9];
+        }
+
+        // The minimizer, if the quadric is well conditioned.
+        bool optimum (Vec3& p, double scale) const noexcept {
+            const double a = q[0], b = q[1], c = q[2], e = q[4], f = q[5], i = q[7];
+            const double A = e*i-f*f, B = c*f-b*i, C = b*f-c*e;
+            const double det = a*A + b*B + c*C;
+            if (std::abs(det) <= 1.e-12*scale*scale*scale) return false;
+            const double D = a*i-c*c, E = b*c-a*f, F = a*e-b*b;
+            const double r0 = -q[3], r1 = -q[6], r2 = -q[8];
+            p[0] = (A*r0 + B*r1 + C*r2)/det;
+            p[1] = (B*r0 + D*r1 + E*r2)/det;
+            p[2] = (C*r0 + E*r1 + F*r2)/det;
+            return true;
+        }
+    };
+
+    /**
+     * Garland-Heckbert edge collapse driven by quadric error.  Vertices on
+     * the boundary of the mesh, or on non-manifold edges, are locked.
+     */
+    class Decimator
+    {
+    public:
+
+        Decimator (Vector<Vec3>& a_pos, Vector<Tri>& a_tri)
+            : m_pos(a_pos), m_tri(a_tri)
+        {}
+
+        void run (Long target);
+
+    private:
+
+        struct Entry
+        {
+            double cost;
+            int v0, v1;
+            int s0, s1;
+            Vec3 p;
+            bool operator> (const Entry& rhs) const noexcept { return cost > rhs.cost; }
+        };
+
+        Vec3 faceNormal (int f, int vold, const Vec3& pnew) const noexcept {
+            Vec3 p[3];
+            for (int m = 0; m < 3; ++m) {
+                const int v = m_tri[f][m];
+                p[m] = (v == vold) ? pnew : m_pos[v];
+            }
+            return cross(sub(p[1],p[0]), sub(p[2],p[0]));
+        }
+
+        void pushEdge (int v0, int v1);
+        bool canCollapse (int v0, int v1, const Vec3& p);
+        void collapse (int keep, int remove, const Vec3& p);
+        void neighbors (int v, Vector<int>& nb) const;
+
+        Vector<Vec3>& m_pos;
+        Vector<Tri>& m_tri;
+        Vector<Vector<int> > m_vface;
+        Vector<Quadric> m_quad;
+        Vector<int> m_version;
+        Vector<char> m_locked;
+        Vector<char> m_valive;
+        Vector<char> m_falive;
+        double m_scale = 1.0;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > m_heap;
+    };
+
+    void
+    Decimator::neighbors (int v, Vector<int>& nb) const
+    {
+        nb.clear();
+        for (int f : m_vface[v]) {
+            if (!m_falive[f]) continue;
+            for (int m = 0; m < 3; ++m) {
+                if (m_tri[f][m] != v) nb.push_back(m_tri[f][m]);
+            }
+        }
+        std::sort(nb.begin(), nb.end());
+        nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+    }
+
+    void
+    Decimator::pushEdge (int v0, int v1)
+    {
+        if (m_locked[v0] && m_locked[v1]) return;
+
+        Quadric q = m_quad[v0];
+        q += m_quad[v1];
+
+        Vec3 p;
+        if (m_locked[v0]) {
+            p = m_pos[v0];
+        } else if (m_locked[v1]) {
+            p = m_pos[v1];
+        } else {
+            const Vec3 mid{{0.5*(m_pos[v0][0]+m_pos[v1][0]),
+                            0.5*(m_pos[v0][1]+m_pos[v1][1]),
+                            0.5*(m_pos[v0][2]+m_pos[v1][2])}};
+            const Vec3 e = sub(m_pos[v1], m_pos[v0]);
+            bool ok = q.optimum(p, m_scale);
+            if (ok) {
+                // Do not trust a minimizer far away from the edge.
+                const Vec3 r = sub(p, mid);
+                ok = dot(r,r) <= 4.0*dot(e,e);
+            }
+            if (!ok) {
+                p = mid;
+                double c = q.eval(mid);
+                for (const Vec3& cand : {m_pos[v0], m_pos[v1]}) {
+                    const double cc = q.eval(cand);
+                    if (cc < c) { c = cc; p = cand; }
+                }
+            }
+        }
+
+        m_heap.push(Entry{std::max(q.eval(p),0.0), v0, v1, m_version[v0], m_version[v1], p});
+    }
+
+    bool
+    Decimator::canCollapse (int v0, int v1, const Vec3& p)
+    {
+        // Link condition: the common neighbors of v0 and v1 must be exactly
+        // the opposite vertices of the faces sharing the edge.
+        Vector<int> nb0, nb1, common;
+        neighbors(v0, nb0);
+        neighbors(v1, nb1);
+        std::set_intersection(nb0.begin(), nb0.end(), nb1.begin(), nb1.end(),
+                              std::back_inserter(common));
+        int nshared = 0;
+        for (int f : m_vface[v0]) {
+            if (!m_falive[f]) continue;
+            const Tri& t = m_tri[f];
+            if (t[0] == v1 || t[1] == v1 || t[2] == v1) ++nshared;
+        }
+        if (nshared == 0 || nshared > 2 || static_cast<int>(common.size()) != nshared) {
+            return false;
+        }
+
+        // The remaining faces must not flip.
+        for (int v : {v0, v1}) {
+            const int other = (v == v0) ? v1 : v0;
+            for (int f : m_vface[v]) {
+                if (!m_falive[f]) continue;
+                const Tri& t = m_tri[f];
+                if (t[0] == other || t[1] == other || t[2] == other) continue;
+                const Vec3 nold = faceNormal(f, -1, p);
+                const Vec3 nnew = faceNormal(f, v, p);
+                if (dot(nold,nnew) <= 0.0 || dot(nnew,nnew) <= 0.0) return false;
+            }
+        }
+        return true;
+    }
+
+    void
+    Decimator::collapse (int keep, int remove, const Vec3& p)
+    {
+        m_pos[keep] = p;
+        m_quad[keep] += m_quad[remove];
+
+        for (int f : m_vface[remove]) {
+            if (!m_falive[f]) continue;
+            Tri& t = m_tri[f];
+            if (t[0] == keep || t[1] == keep || t[2] == keep) {
+                m_falive[f] = 0;
+            } else {
+                for (int m = 0; m < 3; ++m) {
+                    if (t[m] == remove) t[m] = keep;
+                }
+                m_vface[keep].push_back(f);
+            }
+        }
+        m_vface[remove].clear();
+        m_valive[remove] = 0;
+
+        auto& vf = m_vface[keep];
+        vf.erase(std::remove_if(vf.begin(), vf.end(), [&] (int f) { return !m_falive[f]; }),
+                 vf.end());
+
+        ++m_version[keep];
+        Vector<int> nb;
+        neighbors(keep, nb);
+        for (int w : nb) pushEdge(keep, w);
+    }
+
+    void
+    Decimator::run (Long target)
+    {
+        const int nv = m_pos.size();
+        const int nf = m_tri.size();
+        if (nf <= target) return;
+
+        m_vface.resize(nv);
+        m_quad.resize(nv);
+        m_version.assign(nv, 0);
+        m_locked.assign(nv, 0);
+        m_valive.assign(nv, 1);
+        m_falive.assign(nf, 1);
+
+        std::unordered_map<Long,int> edge_count;
+        double area_sum = 0.0;
+        for (int f = 0; f < nf; ++f) {
+            const Tri& t = m_tri[f];
+            Vec3 n = cross(sub(m_pos[t[1]],m_pos[t[0]]), sub(m_pos[t[2]],m_pos[t[0]]));
+            const double len = std::sqrt(dot(n,n));
+            area_sum += 0.5*len;
+            if (len > 0.0) {
+                for (auto& x : n) x /= len;
+                const double d = -dot(n, m_pos[t[0]]);
+                for (int m = 0; m < 3; ++m) m_quad[t[m]].addPlane(n, d, 0.5*len);
+            }
+            for (int m = 0; m < 3; ++m) {
+                m_vface[t[m]].push_back(f);
+                const int a = std::min(t[m], t[(m+1)%3]);
+                const int b = std::max(t[m], t[(m+1)%3]);
+                ++edge_count[static_cast<Long>(a)*nv + b];
+            }
+        }
+        m_scale = (nf > 0) ? area_sum/nf : 1.0;
+
+        for (const auto& kv : edge_count) {
+            if (kv.second != 2) {
+                m_locked[kv.first / nv] = 1;
+                m_locked[kv.first % nv] = 1;
+            }
+        }
+
+        for (const auto& kv : edge_count) {
+            pushEdge(kv.first / nv, kv.first % nv);
+        }
+
+        Long nalive = nf;
+        while (nalive > target && !m_heap.empty())
+        {
+            const Entry e = m_heap.top();
+            m_heap.pop();
+            if (!m_valive[e.v0] || !m_valive[e.v1] ||
+                m_version[e.v0] != e.s0 || m_version[e.v1] != e.s1) continue;
+            if (!canCollapse(e.v0, e.v1, e.p)) continue;
+
+            int nshared = 0;
+            for (int f : m_vface[e.v0]) {
+                const Tri& t = m_tri[f];
+                if (m_falive[f] && (t[0] == e.v1 || t[1] == e.v1 || t[2] == e.v1)) ++nshared;
+            }
+
+            if (m_locked[e.v1]) {
+                collapse(e.v1, e.v0, e.p);
+            } else {
+                collapse(e.v0, e.v1, e.p);
+            }
+            nalive -= nshared;
+        }
+
+        // Compact
+        Vector<int> newid(nv, -1);
+        Vector<Vec3> pos;
+        Vector<Tri> tri;
+        tri.reserve(nalive);
+        for (int f = 0; f < nf; ++f) {
+            if (!m_falive[f]) continue;
+            Tri t = m_tri[f];
+            for (auto& v : t) {
+                if (newid[v] < 0) {
+                    newid[v] = pos.size();
+                    pos.push_back(m_pos[v]);
+                }
+                v = newid[v];
+            }
+            tri.push_back(t);
+        }
+        std::swap(m_pos, pos);
+        std::swap(m_tri, tri);
+    }
+
+    // Build the triangles of the cut cells in the valid boxes of this process.
+    void extractSurface (const EBFArrayBoxFactory& ebf, const Geometry& geom, bool weld,
+                         Vector<Vec3>& pos, Vector<Tri>& tri)
+    {
+        BL_PROFILE("WriteEBSurfacePLY::extract");
+
+        const auto& flags = ebf.getMultiEBCellFlagFab();
+        const auto& bndrycent = ebf.getBndryCent();
+        const auto areafrac = ebf.getAreaFrac();
+        const Real* dx = geom.CellSize();
+        const Real* plo = geom.ProbLo();
+        const double tol = std::min({dx[0],dx[1],dx[2]}) / 100.;
+
+        // Welded vertices are identified by the cell edge they lie on.
+        const Box nodebox = amrex::grow(amrex::surroundingNodes(geom.Domain()), 1);
+        std::unordered_map<Long,int> edge_vertex;
+        Vector<int> nsum;
+
+        std::array<Vec3,12> pts, pts_d;
+        std::array<int,12> edge, edge_d;
+
+        for (MFIter mfi(flags); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            const auto& flagfab = flags[mfi];
+            const FabType typ = flagfab.getType(bx);
+            if (typ == FabType::regular || typ == FabType::covered) continue;
+
+            const auto& flag = flagfab.const_array();
+            const auto& bcent = bndrycent.const_array(mfi);
+            const auto& apx = areafrac[0]->const_array(mfi);
+            const auto& apy = areafrac[1]->const_array(mfi);
+            const auto& apz = areafrac[2]->const_array(mfi);
+
+            amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+            {
+                if (!flag(i,j,k).isSingleValued()) return;
+
+                Vec3 n{{apx(i+1,j,k)-apx(i,j,k), apy(i,j+1,k)-apy(i,j,k), apz(i,j,k+1)-apz(i,j,k)}};
+                const double nnorm = std::sqrt(dot(n,n));
+                if (nnorm <= 0.0) return;
+                for (auto& x : n) x /= nnorm;
+
+                const Vec3 c{{(0.5+bcent(i,j,k,0))*dx[0],
+                              (0.5+bcent(i,j,k,1))*dx[1],
+                              (0.5+bcent(i,j,k,2))*dx[2]}};
+
+                int count = cutCell(n, c, dx, pts, edge);
+                // Nudge the plane if it misses the edges, as amrex_eb_to_polygon does.
+                if (count < 3 || count > 6) {
+                    for (double s : {tol, -tol}) {
+                        const Vec3 cd{{c[0]+s*n[0], c[1]+s*n[1], c[2]+s*n[2]}};
+                        const int count_d = cutCell(n, cd, dx, pts_d, edge_d);
+                        if (count_d >= 3 && count_d <= 6) {
+                            count = count_d;
+                            pts = pts_d;
+                            edge = edge_d;
+                        }
+                    }
+                }
+                if (count < 3 || count > 6) return;
+
+                // Order the points counterclockwise around the normal.
+                Vec3 m{{0.,0.,0.}};
+                for (int p = 0; p < count; ++p) {
+                    for (int d = 0; d < 3; ++d) m[d] += pts[p][d];
+                }
+                for (auto& x : m) x /= count;
+                int amin = 0;
+                for (int d = 1; d < 3; ++d) {
+                    if (std::abs(n[d]) < std::abs(n[amin])) amin = d;
+                }
+                Vec3 ax{{0.,0.,0.}};
+                ax[amin] = 1.0;
+                const Vec3 u = cross(n, ax);
+                const Vec3 v = cross(n, u);
+                std::array<std::pair<double,int>,12> order;
+                for (int p = 0; p < count; ++p) {
+                    const Vec3 r = sub(pts[p], m);
+                    order[p] = std::make_pair(std::atan2(dot(r,v), dot(r,u)), p);
+                }
+                std::sort(order.begin(), order.begin()+count);
+
+                const IntVect iv(AMREX_D_DECL(i,j,k));
+                std::array<int,12> vid;
+                for (int q = 0; q < count; ++q) {
+                    const int p = order[q].second;
+                    const Vec3 x{{plo[0]+i*dx[0]+pts[p][0],
+                                  plo[1]+j*dx[1]+pts[p][1],
+                                  plo[2]+k*dx[2]+pts[p][2]}};
+                    if (weld) {
+                        const int e = edge[p];
+                        const IntVect node = iv + IntVect(AMREX_D_DECL(cell_edges[e][0],
+                                                                       cell_edges[e][1],
+                                                                       cell_edges[e][2]));
+                        const Long key = nodebox.index(node)*3 + cell_edges[e][3];
+                        auto r = edge_vertex.insert(std::make_pair(key, static_cast<int>(pos.size())));
+                        if (r.second) {
+                            pos.push_back(x);
+                            nsum.push_back(1);
+                        } else {
+                            Vec3& y = pos[r.first->second];
+                            for (int d = 0; d < 3; ++d) y[d] += x[d];
+                            ++nsum[r.first->second];
+                        }
+                        vid[q] = r.first->second;
+                    } else {
+                        vid[q] = pos.size();
+                        pos.push_back(x);
+                    }
+                }
+
+                for (int q = 1; q+1 < count; ++q) {
+                    tri.push_back(Tri{{vid[0], vid[q], vid[q+1]}});
+                }
+            });
+        }
+
+        if (weld) {
+            for (int iv = 0, nv = pos.size(); iv < nv; ++iv) {
+                for (auto& x : pos[iv]) x /= nsum[iv];
+            }
+        }
+    }
+
+    template <typename T>
+    void appendBytes (Vector<char>& buf, const T& v)
+    {
+        const char* p = reinterpret_cast<const char*>(&v);
+        buf.insert(buf.end(), p, p+sizeof(T));
+    }
+}
+
+void
+WriteEBSurfacePLY (const std::string& filename, const EBFArrayBoxFactory& ebf,
+                   const Geometry& geom, const EBSurfacePLYInfo& info)
+{
+    BL_PROFILE("WriteEBSurfacePLY()");
+
+    const bool decimate = info.target_triangles > 0;
+
+    Vector<Vec3> pos;
+    Vector<Tri> tri;
+    extractSurface(ebf, geom, info.weld || decimate, pos, tri);
+
+    if (decimate)
+    {
+        BL_PROFILE("WriteEBSurfacePLY::decimate");
+        Long nf_global = tri.size();
+        ParallelDescriptor::ReduceLongSum(nf_global);
+        if (nf_global > info.target_triangles) {
+            const Long target = static_cast<Long>(std::ceil(static_cast<double>(tri.size())
+                                                            * info.target_triangles / nf_global));
+            Decimator(pos, tri).run(target);
+        }
+    }
+
+    // Offsets of this process's vertices and faces, and the totals.
+    Long nv = pos.size();
+    Long nf = tri.size();
+    Long voff = 0, foff = 0;
+#ifdef BL_USE_MPI
+    {
+        Long cnt[2] = {nv, nf};
+        Long off[2] = {0, 0};
+        MPI_Exscan(cnt, off, 2, ParallelDescriptor::Mpi_typemap<Long>::type(), MPI_SUM,
+                   ParallelDescriptor::Communicator());
+        if (ParallelDescriptor::MyProc() != 0) {
+            voff = off[0];
+            foff = off[1];
+        }
+    }
+#endif
+    Long ntot[2] = {nv, nf};
+    ParallelDescriptor::ReduceLongSum(ntot, 2);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ntot[0] <= std::numeric_limits<std::int32_t>::max(),
+                                     "WriteEBSurfacePLY: too many vertices");
+
+    std::ostringstream hdr;
+    {
+        const std::uint16_t one = 1;
+        const bool little = *reinterpret_cast<const unsigned char*>(&one) == 1;
+        hdr << "ply\n"
+            << "format " << (little ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+            << "comment AMReX EB surface\n"
+            << "element vertex " << ntot[0] << "\n"
+            << "property float x\n"
+            << "property float y\n"
+            << "property float z\n"
+            << "element face " << ntot[1] << "\n"
+            << "property list uchar int vertex_indices\n"
+            << "end_header\n";
+    }
+    const std::string& header = hdr.str();
+
+    constexpr Long vertex_bytes = 3*sizeof(float);
+    constexpr Long face_bytes = 1 + 3*sizeof(std::int32_t);
+
+    Vector<char> vbuf, fbuf;
+    vbuf.reserve(nv*vertex_bytes);
+    for (const auto& p : pos) {
+        for (int d = 0; d < 3; ++d) appendBytes(vbuf, static_cast<float>(p[d]));
+    }
+    fbuf.reserve(nf*face_bytes);
+    for (const auto& t : tri) {
+        appendBytes(fbuf, static_cast<unsigned char>(3));
+        for (int m = 0; m < 3; ++m) appendBytes(fbuf, static_cast<std::int32_t>(t[m]+voff));
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::ofstream ofs(filename.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!ofs.good()) amrex::FileOpenFailed(filename);
+        ofs.write(header.data(), header.size());
+    }
+    ParallelDescriptor::Barrier();
+
+    if (nv > 0 || nf > 0)
+    {
+        std::fstream fs(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        if (!fs.good()) amrex::FileOpenFailed(filename);
+        if (nv > 0) {
+            fs.seekp(header.size() + voff*vertex_bytes, std::ios::beg);
+            fs.write(vbuf.data(), vbuf.size());
+        }
+        if (nf > 0) {
+            fs.seekp(header.size() + ntot[0]*vertex_bytes + foff*face_bytes, std::ios::beg);
+            fs.write(fbuf.data(), fbuf.size());
+        }
+        if (!fs.good()) amrex::Error("WriteEBSurfacePLY: failed to write " + filename);
+    }
+    ParallelDescriptor::Barrier();
+}
+
+}
@@ -0,0 +1,966 @@
+// ----------------------------------------------------------------------
+//  AMReX_ProfIndex.cpp
+// ----------------------------------------------------------------------
+#include <AMReX_ProfIndex.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+
+using namespace amrex;
+
+namespace {
+  const std::string indexPrefix("bl_prof_index");
+  const std::string noRegionName("__NoRegion__");
+
+  inline Real RecordTime(const BLProfiler::CommStats &cs)  { return cs.timeStamp; }
+  inline Real RecordTime(const BLProfiler::RStartStop &rs) { return rs.rssTime;   }
+  inline Real RecordTime(const BLProfiler::CallStats &cs)  { return cs.callTime;  }
+
+  bool IsSend(BLProfiler::CommFuncType cft) {
+    return(cft == BLProfiler::AsendTsii  ||
+           cft == BLProfiler::AsendTsiiM ||
+           cft == BLProfiler::AsendvTii  ||
+           cft == BLProfiler::SendTsii   ||
+           cft == BLProfiler::SendvTii);
+  }
+
+  bool IsRecv(BLProfiler::CommFuncType cft) {   // ---- posted receives, no waits
+    return(cft == BLProfiler::ArecvTsii  ||
+           cft == BLProfiler::ArecvTsiiM ||
+           cft == BLProfiler::ArecvTii   ||
+           cft == BLProfiler::ArecvvTii  ||
+           cft == BLProfiler::RecvTsii   ||
+           cft == BLProfiler::RecvvTii);
+  }
+
+  // ---- the string between the first and last quotes of a header line
+  std::string QuotedName(const std::string &line, std::string &rest) {
+    std::string::size_type q0(line.find('"')), q1(line.rfind('"'));
+    if(q0 == std::string::npos || q1 == q0) {
+      rest = "";
+      return std::string();
+    }
+    rest = line.substr(q1 + 1);
+    return line.substr(q0 + 1, q1 - q0 - 1);
+  }
+
+  // ---- the HeaderFile names and NProcs of a global header, false if missing
+  bool ParseGlobalHeader(const std::string &filename, Vector<std::string> &headerFiles,
+                         int &nprocs, Vector<std::string> *regionNames = 0)
+  {
+    std::ifstream hf(filename.c_str());
+    if( ! hf.good()) {
+      return false;
+    }
+    std::string line;
+    while(std::getline(hf, line)) {
+      std::istringstream iss(line);
+      std::string key;
+      iss >> key;
+      if(key == "NProcs") {
+        iss >> nprocs;
+      } else if(key == "HeaderFile") {
+        std::string hname;
+        iss >> hname;
+        headerFiles.push_back(hname);
+      } else if(key == "RegionName" && regionNames) {
+        std::string rest;
+        std::string rname(QuotedName(line, rest));
+        int rnum(-1);
+        std::istringstream(rest) >> rnum;
+        if(rnum >= 0) {
+          if(rnum >= regionNames->size()) {
+            regionNames->resize(rnum + 1);
+          }
+          (*regionNames)[rnum] = rname;
+        }
+      }
+    }
+    return true;
+  }
+
+  // ---- a sorted, consistent union of the strings of all processes
+  void SyncSorted(Vector<std::string> &strings) {
+    std::sort(strings.begin(), strings.end());
+    strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+    Vector<std::string> synced;
+    bool alreadySynced;
+    amrex::SyncStrings(strings, synced, alreadySynced);
+    std::sort(synced.begin(), synced.end());
+    synced.erase(std::unique(synced.begin(), synced.end()), synced.end());
+    strings = synced;
+  }
+
+  int NameNumber(const Vector<std::string> &names, const std::string &name) {
+    Vector<std::string>::const_iterator it(std::lower_bound(names.begin(), names.end(), name));
+    return (it != names.end() && *it == name) ? (it - names.begin()) : -1;
+  }
+
+  // ---- the innermost region of a stack, noRegion is -1
+  int Innermost(const Vector<int> &stack, int noRegionNumber) {
+    for(int i(stack.size() - 1); i >= 0; --i) {
+      if(stack[i] != noRegionNumber) {
+        return stack[i];
+      }
+    }
+    return -1;
+  }
+}
+
+
+// ----------------------------------------------------------------------
+ProfIndex::ProfIndex(const std::string &profdirname)
+  : dirName(profdirname), dataNProcs(0), nBuckets(0), timeMax(0.0),
+    bucketTime(1.0), nIndexFiles(0), tableLo(0), tableHi(0)
+{ }
+
+
+// ----------------------------------------------------------------------
+bool ProfIndex::Exists(const std::string &profdirname) {
+  std::ifstream hf((profdirname + '/' + indexPrefix + "_H").c_str());
+  return hf.good();
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::ParseCommHeader(const std::string &filename, Vector<BlockInfo> &blocks,
+                                Real &tmax) const
+{
+  std::ifstream hf(filename.c_str());
+  if( ! hf.good()) {
+    amrex::FileOpenFailed(filename);
+  }
+  std::string line;
+  while(std::getline(hf, line)) {
+    std::istringstream iss(line);
+    std::string key;
+    iss >> key;
+    if(key == "CommProfProc") {
+      BlockInfo bi;
+      std::string word;
+      bi.stream = CommStream;
+      iss >> bi.proc >> word >> bi.nRecords >> word >> bi.dataFile >> word >> bi.seekPos;
+      blocks.push_back(bi);
+    } else if(key == "timeMinMax") {
+      Real t0, t1;
+      iss >> t0 >> t1;
+      tmax = std::max(tmax, t1);
+    }
+  }
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::ParseCallStatsHeader(const std::string &filename, Vector<BlockInfo> &blocks,
+                                     Real &tmax) const
+{
+  std::ifstream hf(filename.c_str());
+  if( ! hf.good()) {
+    amrex::FileOpenFailed(filename);
+  }
+  std::string line;
+  while(std::getline(hf, line)) {
+    std::istringstream iss(line);
+    std::string key;
+    iss >> key;
+    if(key == "CallStatsProc") {
+      BlockInfo rss, trace;
+      Long nRSS, nTrace;
+      std::string word, dataFile;
+      Long seekPos;
+      int proc;
+      iss >> proc >> word >> nRSS >> word >> nTrace >> word >> dataFile >> word >> seekPos;
+      rss.proc   = trace.proc   = proc;
+      rss.dataFile = trace.dataFile = dataFile;
+      rss.stream = RegionStream;
+      rss.seekPos = seekPos;
+      rss.nRecords = nRSS;
+      trace.stream = TraceStream;
+      trace.seekPos = seekPos + nRSS * sizeof(BLProfiler::RStartStop);
+      trace.nRecords = nTrace;
+      blocks.push_back(rss);
+      blocks.push_back(trace);
+    } else if(key == "fName" && ! blocks.empty()) {
+      std::string rest;
+      std::string fname(QuotedName(line, rest));
+      int fnum(-1);
+      std::istringstream(rest) >> fnum;
+      blocks.back().fNames.push_back(std::make_pair(fname, fnum));
+    } else if(key == "timeMinMax") {
+      Real t0, t1;
+      iss >> t0 >> t1;
+      tmax = std::max(tmax, t1);
+    }
+  }
+}
+
+
+// ----------------------------------------------------------------------
+int ProfIndex::Bucket(Real t) const {
+  const Real b(t / bucketTime);
+  if(b <= 0.0) {
+    return 0;
+  }
+  return (b >= nBuckets) ? nBuckets - 1 : static_cast<int>(b);
+}
+
+
+// ----------------------------------------------------------------------
+template<class T, class F>
+void ProfIndex::StreamRecords(const Block &block, Long rLo, Long rHi, F func) const
+{
+  if(rLo >= rHi) {
+    return;
+  }
+  const std::string fileName(dirName + '/' + dataFileNames[block.header.fileNumber]);
+  std::ifstream df(fileName.c_str(), std::ios::in | std::ios::binary);
+  if( ! df.good()) {
+    amrex::FileOpenFailed(fileName);
+  }
+  df.seekg(block.header.seekPos + rLo * sizeof(T), std::ios::beg);
+
+  Vector<T> chunk(std::min(static_cast<Long>(ChunkSize), rHi - rLo));
+  for(Long r(rLo); r < rHi; ) {
+    const Long n(std::min(static_cast<Long>(chunk.size()), rHi - r));
+    df.read((char *) chunk.dataPtr(), n * sizeof(T));
+    if( ! df.good()) {
+      amrex::Abort("ProfIndex:  short read of " + fileName);
+    }
+    for(Long i(0); i < n; ++i) {
+      func(r + i, chunk[i]);
+    }
+    r += n;
+  }
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::IndexBlock(const BlockInfo &bi, Block &block, Vector<int> &regionStack) const
+{
+  block.header.seekPos  = bi.seekPos;
+  block.header.nRecords = bi.nRecords;
+  block.bucketStart.resize(nBuckets + 1);
+  if(bi.stream == RegionStream) {
+    block.stackDepth.resize(nBuckets + 1);
+    block.stack.resize((nBuckets + 1) * MaxDepth, -1);
+  }
+
+  int nextBucket(0);
+  auto closeBuckets = [&] (Long r, int bucket) {
+    for( ; nextBucket <= bucket; ++nextBucket) {
+      block.bucketStart[nextBucket] = r;
+      if(bi.stream == RegionStream) {   // ---- keep the innermost MaxDepth regions
+        const int depth(std::min(static_cast<int>(regionStack.size()), static_cast<int>(MaxDepth)));
+        block.stackDepth[nextBucket] = depth;
+        for(int d(0); d < depth; ++d) {
+          block.stack[nextBucket * MaxDepth + d] = regionStack[regionStack.size() - depth + d];
+        }
+      }
+    }
+  };
+
+  if(bi.stream == CommStream) {
+    StreamRecords<BLProfiler::CommStats>(block, 0, bi.nRecords,
+      [&] (Long r, const BLProfiler::CommStats &cs) {
+        closeBuckets(r, Bucket(RecordTime(cs)));
+      });
+  } else if(bi.stream == TraceStream) {
+    StreamRecords<BLProfiler::CallStats>(block, 0, bi.nRecords,
+      [&] (Long r, const BLProfiler::CallStats &cs) {
+        closeBuckets(r, Bucket(RecordTime(cs)));
+      });
+  } else {
+    StreamRecords<BLProfiler::RStartStop>(block, 0, bi.nRecords,
+      [&] (Long r, const BLProfiler::RStartStop &rs) {
+        closeBuckets(r, Bucket(RecordTime(rs)));
+        if(rs.rssStart) {
+          regionStack.push_back(rs.rssRNumber);
+        } else {
+          for(int i(regionStack.size() - 1); i >= 0; --i) {
+            if(regionStack[i] == rs.rssRNumber) {
+              regionStack.erase(regionStack.begin() + i);
+              break;
+            }
+          }
+        }
+      });
+  }
+  closeBuckets(bi.nRecords, nBuckets);
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::Build(int nbuckets) {
+  BL_PROFILE("ProfIndex::Build()");
+
+  const int myProc(ParallelDescriptor::MyProc());
+  const int nProcs(ParallelDescriptor::NProcs());
+  const int ioProc(ParallelDescriptor::IOProcessorNumber());
+
+  nBuckets = std::max(1, nbuckets);
+  nIndexFiles = nProcs;
+  dataNProcs = 0;
+  regionNames.clear();
+
+  Vector<std::string> commHeaders, csHeaders;
+  bool bComm(ParseGlobalHeader(dirName + "/bl_comm_prof_H", commHeaders, dataNProcs));
+  bool bCallStats(ParseGlobalHeader(dirName + "/bl_call_stats_H", csHeaders, dataNProcs,
+                                    &regionNames));
+
+  // ---- the base profile:  names, the end time and a data block per rank
+  Real tmax(0.0);
+  Vector<BlockInfo> baseBlocks;
+  baseFNames.clear();
+  {
+    std::ifstream hf((dirName + "/bl_prof_H").c_str());
+    std::string line;
+    while(hf.good() && std::getline(hf, line)) {
+      std::istringstream iss(line);
+      std::string key;
+      iss >> key;
+      if(key == "NProcs") {
+        iss >> dataNProcs;
+      } else if(key == "phFName") {
+        std::string rest;
+        baseFNames.push_back(QuotedName(line, rest));
+      } else if(key == "calcEndTime") {
+        Real t;
+        iss >> t;
+        tmax = std::max(tmax, t);
+      } else if(key == "BLProfProc" && myProc == ioProc) {
+        BlockInfo bi;
+        std::string word;
+        bi.stream = BaseStream;
+        iss >> bi.proc >> word >> bi.dataFile >> word >> bi.seekPos;
+        bi.nRecords = baseFNames.size();
+        baseBlocks.push_back(bi);
+      }
+    }
+  }
+  if(dataNProcs <= 0) {
+    amrex::Abort("ProfIndex::Build:  no profile headers in " + dirName);
+  }
+  if( ! bComm && ! bCallStats) {
+    amrex::Print() << "ProfIndex::Build:  no comm stats or call traces, indexing the base profile.\n";
+  }
+
+  // ---- parse the headers round robin over the processes
+  Vector<BlockInfo> blocks;
+  for(int i(myProc); i < commHeaders.size(); i += nProcs) {
+    ParseCommHeader(dirName + '/' + commHeaders[i], blocks, tmax);
+  }
+  for(int i(myProc); i < csHeaders.size(); i += nProcs) {
+    ParseCallStatsHeader(dirName + '/' + csHeaders[i], blocks, tmax);
+  }
+  ParallelDescriptor::ReduceRealMax(tmax);
+  timeMax = (tmax > 0.0) ? tmax : 1.0;
+  bucketTime = timeMax / nBuckets;
+
+  // ---- keep each rank's blocks of a stream together and in file order
+  std::stable_sort(blocks.begin(), blocks.end(),
+                   [] (const BlockInfo &a, const BlockInfo &b) {
+                     return (a.proc < b.proc) || (a.proc == b.proc && a.stream < b.stream);
+                   });
+
+  // ---- global numbers for the data files and the function names
+  dataFileNames.clear();
+  fNames.clear();
+  for(int i(0); i < blocks.size(); ++i) {
+    dataFileNames.push_back(blocks[i].dataFile);
+    for(int n(0); n < blocks[i].fNames.size(); ++n) {
+      fNames.push_back(blocks[i].fNames[n].first);
+    }
+  }
+  for(int i(0); i < baseBlocks.size(); ++i) {
+    dataFileNames.push_back(baseBlocks[i].dataFile);
+  }
+  SyncSorted(dataFileNames);
+  SyncSorted(fNames);
+
+  // ---- index the blocks and write this process's index file
+  Vector<Long> tableOut(dataNProcs * NStreams * 3, -1);
+  const std::string indexFileName(amrex::Concatenate(indexPrefix + "_D_", myProc, 5));
+  std::ofstream df((dirName + '/' + indexFileName).c_str(),
+                   std::ios::out | std::ios::trunc | std::ios::binary);
+  if( ! df.good()) {
+    amrex::FileOpenFailed(dirName + '/' + indexFileName);
+  }
+
+  Vector<int> regionStack;
+  int stackProc(-1);
+  for(int ib(0); ib < blocks.size(); ) {
+    const int proc(blocks[ib].proc), stream(blocks[ib].stream);
+    int ie(ib);
+    while(ie < blocks.size() && blocks[ie].proc == proc && blocks[ie].stream == stream) {
+      ++ie;
+    }
+    Long *entry(&tableOut[(proc * NStreams + stream) * 3]);
+    entry[0] = myProc;
+    entry[1] = df.tellp();
+    entry[2] = ie - ib;
+
+    if(stream == RegionStream && stackProc != proc) {
+      regionStack.clear();
+      stackProc = proc;
+    }
+    for(int i(ib); i < ie; ++i) {
+      Block block;
+      block.header.fileNumber = NameNumber(dataFileNames, blocks[i].dataFile);
+      IndexBlock(blocks[i], block, regionStack);
+      df.write((char *) &block.header, sizeof(BlockHeader));
+      df.write((char *) block.bucketStart.dataPtr(), block.bucketStart.size() * sizeof(Long));
+      if(stream == RegionStream) {
+        df.write((char *) block.stackDepth.dataPtr(), block.stackDepth.size() * sizeof(int));
+        df.write((char *) block.stack.dataPtr(), block.stack.size() * sizeof(int));
+      }
+    }
+
+    if(stream == TraceStream) {   // ---- map the rank's function numbers to global numbers
+      Vector<int> nameMap;
+      for(int i(ib); i < ie; ++i) {
+        for(int n(0); n < blocks[i].fNames.size(); ++n) {
+          const int fnum(blocks[i].fNames[n].second);
+          if(fnum >= 0) {
+            if(fnum >= nameMap.size()) {
+              nameMap.resize(fnum + 1, -1);
+            }
+            nameMap[fnum] = NameNumber(fNames, blocks[i].fNames[n].first);
+          }
+        }
+      }
+      Long nNames(nameMap.size());
+      df.write((char *) &nNames, sizeof(Long));
+      if(nNames > 0) {
+        df.write((char *) nameMap.dataPtr(), nNames * sizeof(int));
+      }
+    }
+    ib = ie;
+  }
+  df.close();
+
+  for(int i(0); i < baseBlocks.size(); ++i) {
+    const BlockInfo &bi = baseBlocks[i];
+    if(bi.proc >= 0 && bi.proc < dataNProcs) {
+      Long *entry(&tableOut[(bi.proc * NStreams + BaseStream) * 3]);
+      entry[0] = NameNumber(dataFileNames, bi.dataFile);
+      entry[1] = bi.seekPos;
+      entry[2] = bi.nRecords;
+    }
+  }
+
+  ParallelDescriptor::ReduceLongMax(tableOut.dataPtr(), tableOut.size(), ioProc);
+
+  if(ParallelDescriptor::IOProcessor()) {
+    std::ofstream tf((dirName + '/' + indexPrefix + "_T").c_str(),
+                     std::ios::out | std::ios::trunc | std::ios::binary);
+    tf.write((char *) tableOut.dataPtr(), tableOut.size() * sizeof(Long));
+    tf.close();
+
+    const std::string headerName(dirName + '/' + indexPrefix + "_H");
+    std::ofstream hf(headerName.c_str(), std::ios::out | std::ios::trunc);
+    if( ! hf.good()) {
+      amrex::FileOpenFailed(headerName);
+    }
+    hf << "ProfIndexVersion  " << Version << '\n';
+    hf << "NProcs  " << dataNProcs << '\n';
+    hf << "NBuckets  " << nBuckets << '\n';
+    hf << std::setprecision(16) << "TimeMax  " << timeMax << '\n';
+    hf << "NIndexFiles  " << nIndexFiles << '\n';
+    hf << "MaxDepth  " << MaxDepth << '\n';
+    for(int i(0); i < dataFileNames.size(); ++i) {
+      hf << "DataFile  " << dataFileNames[i] << '\n';
+    }
+    for(int i(0); i < fNames.size(); ++i) {
+      hf << "FName " << '"' << fNames[i] << '"' << '\n';
+    }
+    for(int i(0); i < regionNames.size(); ++i) {
+      hf << "RegionName " << '"' << regionNames[i] << '"' << ' ' << i << '\n';
+    }
+    for(int i(0); i < baseFNames.size(); ++i) {
+      hf << "BaseFName " << '"' << baseFNames[i] << '"' << '\n';
+    }
+    hf.close();
+  }
+  ParallelDescriptor::Barrier("ProfIndex::Build");
+
+  amrex::Print() << "ProfIndex::Build:  indexed " << dataNProcs << " ranks in "
+                 << nBuckets << " buckets of " << bucketTime << " s.\n";
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::RankRange(int &pLo, int &pHi) const {
+  const Long myProc(ParallelDescriptor::MyProc());
+  const Long nProcs(ParallelDescriptor::NProcs());
+  pLo = (myProc * dataNProcs) / nProcs;
+  pHi = ((myProc + 1) * dataNProcs) / nProcs;
+}
+
+
+// ----------------------------------------------------------------------
+bool ProfIndex::Read() {
+  BL_PROFILE("ProfIndex::Read()");
+
+  const std::string headerName(dirName + '/' + indexPrefix + "_H");
+  std::ifstream hf(headerName.c_str());
+  if( ! hf.good()) {
+    return false;
+  }
+  dataFileNames.clear();
+  fNames.clear();
+  regionNames.clear();
+  baseFNames.clear();
+  int version(-1), maxDepth(-1);
+  std::string line;
+  while(std::getline(hf, line)) {
+    std::istringstream iss(line);
+    std::string key, rest;
+    iss >> key;
+    if(key == "ProfIndexVersion") {
+      iss >> version;
+    } else if(key == "NProcs") {
+      iss >> dataNProcs;
+    } else if(key == "NBuckets") {
+      iss >> nBuckets;
+    } else if(key == "TimeMax") {
+      iss >> timeMax;
+    } else if(key == "NIndexFiles") {
+      iss >> nIndexFiles;
+    } else if(key == "MaxDepth") {
+      iss >> maxDepth;
+    } else if(key == "DataFile") {
+      std::string dname;
+      iss >> dname;
+      dataFileNames.push_back(dname);
+    } else if(key == "FName") {
+      fNames.push_back(QuotedName(line, rest));
+    } else if(key == "RegionName") {
+      regionNames.push_back(QuotedName(line, rest));
+    } else if(key == "BaseFName") {
+      baseFNames.push_back(QuotedName(line, rest));
+    }
+  }
+  if(version != Version || maxDepth != MaxDepth || nBuckets <= 0) {
+    amrex::Print() << "**** Error:  ProfIndex::Read:  unsupported index in " << dirName << '\n';
+    return false;
+  }
+  bucketTime = timeMax / nBuckets;
+
+  // ---- only the table entries of this process's ranks
+  RankRange(tableLo, tableHi);
+  table.resize((tableHi - tableLo) * NStreams);
+  if(tableHi > tableLo) {
+    const std::string tableName(dirName + '/' + indexPrefix + "_T");
+    std::ifstream tf(tableName.c_str(), std::ios::in | std::ios::binary);
+    if( ! tf.good()) {
+      amrex::FileOpenFailed(tableName);
+    }
+    tf.seekg(static_cast<Long>(tableLo) * NStreams * sizeof(TableEntry), std::ios::beg);
+    tf.read((char *) table.dataPtr(), table.size() * sizeof(TableEntry));
+  }
+  return true;
+}
+
+
+// ----------------------------------------------------------------------
+const ProfIndex::TableEntry &ProfIndex::Entry(int proc, int stream) const {
+  BL_ASSERT(proc >= tableLo && proc < tableHi);
+  return table[(proc - tableLo) * NStreams + stream];
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::ReadBlocks(int proc, int stream, Vector<Block> &blocks,
+                           Vector<int> *nameMap) const
+{
+  blocks.clear();
+  const TableEntry &te = Entry(proc, stream);
+  if(te.nBlocks <= 0 || stream == BaseStream) {
+    return;
+  }
+  const std::string indexFileName(dirName + '/' +
+                                  amrex::Concatenate(indexPrefix + "_D_", te.indexFile, 5));
+  std::ifstream df(indexFileName.c_str(), std::ios::in | std::ios::binary);
+  if( ! df.good()) {
+    amrex::FileOpenFailed(indexFileName);
+  }
+  df.seekg(te.seekPos, std::ios::beg);
+  blocks.resize(te.nBlocks);
+  for(int i(0); i < blocks.size(); ++i) {
+    Block &block = blocks[i];
+    df.read((char *) &block.header, sizeof(BlockHeader));
+    block.bucketStart.resize(nBuckets + 1);
+    df.read((char *) block.bucketStart.dataPtr(), block.bucketStart.size() * sizeof(Long));
+    if(stream == RegionStream) {
+      block.stackDepth.resize(nBuckets + 1);
+      block.stack.resize((nBuckets + 1) * MaxDepth);
+      df.read((char *) block.stackDepth.dataPtr(), block.stackDepth.size() * sizeof(int));
+      df.read((char *) block.stack.dataPtr(), block.stack.size() * sizeof(int));
+    }
+  }
+  if(stream == TraceStream && nameMap) {
+    Long nNames(0);
+    df.read((char *) &nNames, sizeof(Long));
+    nameMap->resize(nNames);
+    if(nNames > 0) {
+      df.read((char *) nameMap->dataPtr(), nNames * sizeof(int));
+    }
+  }
+  if( ! df.good()) {
+    amrex::Abort("ProfIndex:  short read of " + indexFileName);
+  }
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::RecordRange(const Block &block, Real tStart, Real tStop,
+                            Long &rLo, Long &rHi) const
+{
+  rLo = block.bucketStart[Bucket(tStart)];
+  rHi = block.bucketStart[Bucket(tStop) + 1];
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::WriteSendRecvMatrix(const std::string &filename, Real tStart, Real tStop) {
+  BL_PROFILE("ProfIndex::WriteSendRecvMatrix()");
+
+  if(tStop <= tStart) {
+    tStart = 0.0;
+    tStop  = timeMax;
+  }
+
+  // ---- [from, to] -> nsends sendbytes nrecvs recvbytes
+  typedef std::map<std::pair<int, int>, std::array<Long, 4> > SRMap;
+  SRMap srMap;
+  Vector<Block> blocks;
+  for(int p(tableLo); p < tableHi; ++p) {
+    ReadBlocks(p, CommStream, blocks);
+    for(int ib(0); ib < blocks.size(); ++ib) {
+      Long rLo, rHi;
+      RecordRange(blocks[ib], tStart, tStop, rLo, rHi);
+      StreamRecords<BLProfiler::CommStats>(blocks[ib], rLo, rHi,
+        [&] (Long, const BLProfiler::CommStats &cs) {
+          if(cs.timeStamp < tStart || cs.timeStamp > tStop ||
+             cs.size < 0 || cs.commpid < 0 || cs.commpid >= dataNProcs)
+          {
+            return;
+          }
+          if(IsSend(cs.cfType)) {
+            std::array<Long, 4> &v = srMap[std::make_pair(p, cs.commpid)];
+            v[0] += 1;
+            v[1] += cs.size;
+          } else if(IsRecv(cs.cfType)) {
+            std::array<Long, 4> &v = srMap[std::make_pair(cs.commpid, p)];
+            v[2] += 1;
+            v[3] += cs.size;
+          }
+        });
+    }
+  }
+
+  // ---- the receives of a pair may have been counted on another process
+  const int nLong(6);
+  Vector<Long> local;
+  local.reserve(srMap.size() * nLong);
+  for(SRMap::const_iterator it = srMap.begin(); it != srMap.end(); ++it) {
+    local.push_back(it->first.first);
+    local.push_back(it->first.second);
+    for(int i(0); i < 4; ++i) {
+      local.push_back(it->second[i]);
+    }
+  }
+  const int ioProc(ParallelDescriptor::IOProcessorNumber());
+  const int nProcs(ParallelDescriptor::NProcs());
+  int nLocal(local.size());
+  std::vector<int> counts(nProcs, 0), offsets(nProcs, 0);
+  ParallelDescriptor::Gather(&nLocal, 1, counts.data(), 1, ioProc);
+  int nTotal(0);
+  for(int i(0); i < nProcs; ++i) {
+    offsets[i] = nTotal;
+    nTotal += counts[i];
+  }
+  Vector<Long> all(std::max(nTotal, 1));
+  if(local.empty()) {
+    local.push_back(0);   // ---- cannot be zero for the gather call
+  }
+  ParallelDescriptor::Gatherv(local.dataPtr(), nLocal, all.dataPtr(), counts, offsets, ioProc);
+
+  if(ParallelDescriptor::IOProcessor()) {
+    SRMap merged;
+    for(int i(0); i < nTotal; i += nLong) {
+      std::array<Long, 4> &v = merged[std::make_pair(static_cast<int>(all[i]),
+                                                     static_cast<int>(all[i+1]))];
+      for(int n(0); n < 4; ++n) {
+        v[n] += all[i + 2 + n];
+      }
+    }
+    std::ofstream sf(filename.c_str(), std::ios::out | std::ios::trunc);
+    if( ! sf.good()) {
+      amrex::FileOpenFailed(filename);
+    }
+    Long totals[4] = { 0, 0, 0, 0 };
+    sf << "# sends and posted receives in [" << tStart << ", " << tStop << "]\n";
+    sf << "# from  to  nsends  sendbytes  nrecvs  recvbytes\n";
+    for(SRMap::const_iterator it = merged.begin(); it != merged.end(); ++it) {
+      sf << it->first.first << ' ' << it->first.second;
+      for(int n(0); n < 4; ++n) {
+        sf << ' ' << it->second[n];
+        totals[n] += it->second[n];
+      }
+      sf << '\n';
+    }
+    sf.close();
+    amrex::Print() << "ProfIndex:  " << merged.size() << " rank pairs, "
+                   << totals[0] << " sends of " << totals[1] << " bytes, "
+                   << totals[2] << " receives of " << totals[3] << " bytes -> "
+                   << filename << '\n';
+  }
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::WriteFunctionStats(std::ostream &os, Real tStart, Real tStop) {
+  BL_PROFILE("ProfIndex::WriteFunctionStats()");
+
+  if(tStop <= tStart) {
+    tStart = 0.0;
+    tStop  = timeMax;
+  }
+
+  Long nTraceBlocks(0);
+  for(int p(tableLo); p < tableHi; ++p) {
+    nTraceBlocks += std::max(Entry(p, TraceStream).nBlocks, static_cast<Long>(0));
+  }
+  ParallelDescriptor::ReduceLongSum(nTraceBlocks);
+  const bool useTrace(nTraceBlocks > 0);
+  const Vector<std::string> &names = useTrace ? fNames : baseFNames;
+  const int nF(names.size());
+
+  // ---- over the ranks:  ncalls, sum excl, sum incl, then min and max
+  Vector<Long> nCalls(nF, 0);
+  Vector<Real> sums(2 * nF, 0.0);
+  Vector<Real> mins(2 * nF, std::numeric_limits<Real>::max());
+  Vector<Real> maxs(2 * nF, -std::numeric_limits<Real>::max());
+  Vector<Long> rCalls(nF);
+  Vector<Real> rExcl(nF), rIncl(nF);
+  Vector<Block> blocks;
+  Vector<int> nameMap;
+
+  for(int p(tableLo); p < tableHi; ++p) {
+    std::fill(rCalls.begin(), rCalls.end(), 0);
+    std::fill(rExcl.begin(), rExcl.end(), 0.0);
+    std::fill(rIncl.begin(), rIncl.end(), 0.0);
+    if(useTrace) {
+      ReadBlocks(p, TraceStream, blocks, &nameMap);
+      for(int ib(0); ib < blocks.size(); ++ib) {
+        Long rLo, rHi;
+        RecordRange(blocks[ib], tStart, tStop, rLo, rHi);
+        StreamRecords<BLProfiler::CallStats>(blocks[ib], rLo, rHi,
+          [&] (Long, const BLProfiler::CallStats &cs) {
+            if(cs.callTime < tStart || cs.callTime > tStop ||
+               cs.csFNameNumber < 0 || cs.csFNameNumber >= nameMap.size())
+            {
+              return;
+            }
+            const int f(nameMap[cs.csFNameNumber]);
+            if(f >= 0) {
+              rCalls[f] += cs.nCSCalls;
+              rExcl[f]  += cs.stackTime;
+              rIncl[f]  += cs.totalTime;
+            }
+          });
+      }
+    } else {   // ---- nCalls then exclusive times, see BLProfiler::WriteBaseProfile
+      const TableEntry &te = Entry(p, BaseStream);
+      if(te.nBlocks == nF && nF > 0) {
+        const std::string fileName(dirName + '/' + dataFileNames[te.indexFile]);
+        std::ifstream df(fileName.c_str(), std::ios::in | std::ios::binary);
+        if( ! df.good()) {
+          amrex::FileOpenFailed(fileName);
+        }
+        df.seekg(te.seekPos, std::ios::beg);
+        df.read((char *) rCalls.dataPtr(), nF * sizeof(Long));
+        df.read((char *) rExcl.dataPtr(), nF * sizeof(Real));
+        rIncl = rExcl;
+      }
+    }
+    for(int f(0); f < nF; ++f) {
+      nCalls[f] += rCalls[f];
+      const Real v[2] = { rExcl[f], rIncl[f] };
+      for(int i(0); i < 2; ++i) {
+        sums[i * nF + f] += v[i];
+        mins[i * nF + f] = std::min(mins[i * nF + f], v[i]);
+        maxs[i * nF + f] = std::max(maxs[i * nF + f], v[i]);
+      }
+    }
+  }
+
+  const int ioProc(ParallelDescriptor::IOProcessorNumber());
+  if(nF > 0) {
+    ParallelDescriptor::ReduceLongSum(nCalls.dataPtr(), nF, ioProc);
+    ParallelDescriptor::ReduceRealSum(sums.dataPtr(), 2 * nF, ioProc);
+    ParallelDescriptor::ReduceRealMin(mins.dataPtr(), 2 * nF, ioProc);
+    ParallelDescriptor::ReduceRealMax(maxs.dataPtr(), 2 * nF, ioProc);
+  }
+
+  if(ParallelDescriptor::IOProcessor()) {
+    Vector<int> order(nF);
+    for(int f(0); f < nF; ++f) {
+      order[f] = f;
+    }
+    std::sort(order.begin(), order.end(),
+              [&] (int a, int b) { return maxs[a] > maxs[b]; });
+    const Real runTime(tStop - tStart);
+    const int nameWidth(40);
+
+    os << "\nFunction stats from the "
+       << (useTrace ? "call traces" : "base profile (whole run)")
+       << " in [" << tStart << ", " << tStop << "] over " << dataNProcs << " ranks.\n";
+    os << std::setfill('-') << std::setw(nameWidth + 102) << '\n' << std::setfill(' ');
+    os << std::left << std::setw(nameWidth) << "Name" << std::right
+       << std::setw(12) << "NCalls"
+       << std::setw(12) << "Excl. Min" << std::setw(12) << "Excl. Avg"
+       << std::setw(12) << "Excl. Max" << std::setw(12) << "Incl. Min"
+       << std::setw(12) << "Incl. Avg" << std::setw(12) << "Incl. Max"
+       << std::setw(9)  << "Max %" << '\n';
+    os << std::setfill('-') << std::setw(nameWidth + 102) << '\n' << std::setfill(' ');
+    for(int i(0); i < nF; ++i) {
+      const int f(order[i]);
+      if(nCalls[f] == 0) {
+        continue;
+      }
+      std::string name(names[f]);
+      if(name.size() >= nameWidth) {
+        name = name.substr(0, nameWidth - 1);
+      }
+      os << std::left << std::setw(nameWidth) << name << std::right
+         << std::setw(12) << nCalls[f] << std::setprecision(4)
+         << std::setw(12) << mins[f]
+         << std::setw(12) << sums[f] / dataNProcs
+         << std::setw(12) << maxs[f]
+         << std::setw(12) << mins[nF + f]
+         << std::setw(12) << sums[nF + f] / dataNProcs
+         << std::setw(12) << maxs[nF + f]
+         << std::setw(8) << std::fixed << std::setprecision(2)
+         << ((runTime > 0.0) ? 100.0 * maxs[f] / runTime : 0.0) << '%'
+         << std::defaultfloat << '\n';
+    }
+    os << std::setfill('-') << std::setw(nameWidth + 102) << '\n' << std::setfill(' ');
+  }
+}
+
+
+// ----------------------------------------------------------------------
+void ProfIndex::WriteRegionTimeline(const std::string &filename, int nSlots,
+                                    Real tStart, Real tStop)
+{
+  BL_PROFILE("ProfIndex::WriteRegionTimeline()");
+
+  if(tStop <= tStart) {
+    tStart = 0.0;
+    tStop  = timeMax;
+  }
+  nSlots = std::max(1, nSlots);
+  const Real slotTime((tStop - tStart) / nSlots);
+  int noRegionNumber(-1);
+  for(int i(0); i < regionNames.size(); ++i) {
+    if(regionNames[i] == noRegionName) {
+      noRegionNumber = i;
+    }
+  }
+
+  const std::string binName(filename + ".bin");
+  if(ParallelDescriptor::IOProcessor()) {
+    std::ofstream hf((filename + ".H").c_str(), std::ios::out | std::ios::trunc);
+    if( ! hf.good()) {
+      amrex::FileOpenFailed(filename + ".H");
+    }
+    hf << "RegionTimeline  " << binName << '\n';
+    hf << "NProcs  " << dataNProcs << '\n';
+    hf << "NSlots  " << nSlots << '\n';
+    hf << "IntSize  " << sizeof(int) << '\n';
+    hf << std::setprecision(16) << "TimeRange  " << tStart << ' ' << tStop << '\n';
+    hf << "Region  -1  \"" << noRegionName << "\"\n";
+    for(int i(0); i < regionNames.size(); ++i) {
+      if(i != noRegionNumber) {
+        hf << "Region  " << i << "  " << '"' << regionNames[i] << '"' << '\n';
+      }
+    }
+    hf.close();
+    std::ofstream bf(binName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+    if( ! bf.good()) {
+      amrex::FileOpenFailed(binName);
+    }
+  }
+  ParallelDescriptor::Barrier("ProfIndex::WriteRegionTimeline");
+
+  // ---- each process writes the rows of its ranks
+  std::fstream bf;
+  if(tableHi > tableLo) {
+    bf.open(binName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    if( ! bf.good()) {
+      amrex::FileOpenFailed(binName);
+    }
+    bf.seekp(static_cast<Long>(tableLo) * nSlots * sizeof(int), std::ios::beg);
+  }
+
+  Vector<int> row(nSlots), stack;
+  Vector<Block> blocks;
+  for(int p(tableLo); p < tableHi; ++p) {
+    int slot(0);
+    stack.clear();
+    auto fillTo = [&] (Real t) {
+      const int inner(Innermost(stack, noRegionNumber));
+      for( ; slot < nSlots && tStart + (slot + 0.5) * slotTime < t; ++slot) {
+        row[slot] = inner;
+      }
+    };
+    ReadBlocks(p, RegionStream, blocks);
+    for(int ib(0); ib < blocks.size(); ++ib) {
+      const Block &block = blocks[ib];
+      Long rLo, rHi;
+      RecordRange(block, tStart, tStop, rLo, rHi);
+      if(rLo >= rHi) {
+        continue;
+      }
+      const int b0(Bucket(tStart));
+      stack.assign(block.stack.begin() + b0 * MaxDepth,
+                   block.stack.begin() + b0 * MaxDepth + block.stackDepth[b0]);
+      StreamRecords<BLProfiler::RStartStop>(block, rLo, rHi,
+        [&] (Long, const BLProfiler::RStartStop &rs) {
+          fillTo(rs.rssTime);
+          if(rs.rssStart) {
+            stack.push_back(rs.rssRNumber);
+          } else {
+            for(int i(stack.size() - 1); i >= 0; --i) {
+              if(stack[i] == rs.rssRNumber) {
+                stack.erase(stack.begin() + i);
+                break;
+              }
+            }
+          }
+        });
+    }
+    fillTo(std::numeric_limits<Real>::max());
+    bf.write((char *) row.dataPtr(), nSlots * sizeof(int));
+  }
+  if(bf.is_open()) {
+    bf.close();
+  }
+  ParallelDescriptor::Barrier("ProfIndex::WriteRegionTimeline::end");
+
+  amrex::Print() << "ProfIndex:  region timeline of " << dataNProcs << " ranks x "
+                 << nSlots << " slots -> " << filename << ".H\n";
+}
+
+// ----------------------------------------------------------------------
+// ----------------------------------------------------------------------
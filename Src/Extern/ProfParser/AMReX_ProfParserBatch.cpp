@@ -22,6 +22,7 @@ using std::string;
 #include <AMReX.H>
 # include <AMReX_DataServices.H>
 #include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ProfIndex.H>
 
 using namespace amrex;
 
@@ -31,6 +32,8 @@ extern void amrex::RedistFiles();
 namespace {
 #define SHOWVAL(val) { cout << #val << " = " << val << endl; }
   const int NTIMESLOTS(25600);
+  const int NINDEXBUCKETS(256);
+  const int NINDEXTLSLOTS(1024);
 }
 
 
@@ -45,8 +48,15 @@ void PrintProfParserBatchUsage(std::ostream &os) {
       os << "   [-gpct]    set percent threshold for xgraphs.  range [0, 100]" << '\n';
       os << "   [-html]    write html." << '\n';
       os << "   [-htmlnc]  write html showing ncalls." << '\n';
+      os << "   [-ifs]     indexed:  print function stats." << '\n';
+      os << "   [-index]   build the index of the database (also built by the first indexed query)." << '\n';
+      os << "   [-irtl n]  indexed:  write a region timeline with n time slots (default:  "
+         << NINDEXTLSLOTS << ")." << '\n';
+      os << "   [-isr]     indexed:  write the send/recv matrix." << '\n';
+      os << "   [-itr t0 t1] indexed:  restrict the indexed queries to the time range [t0, t1]." << '\n';
       os << "   [-msil n]  sets maxSmallImageLength." << '\n';
       os << "   [-mff]     make filter file." << '\n';
+      os << "   [-nbk  n]  sets number of index time buckets (default:  " << NINDEXBUCKETS << ")." << '\n';
       os << "   [-nocomb]  do not combine adjacent call traces." << '\n';
       os << "   [-nts  n]  sets number of time slots (default:  " << NTIMESLOTS << ")." << '\n';
       os << "   [-of  fn]  sets output file name." << '\n';
@@ -96,6 +106,10 @@ bool ProfParserBatchFunctions(int argc, char *argv[], bool runDefault,
   bool bMakeRegionPlt(false), simpleCombine(true);
   bool bWriteHTML(false), bWriteHTMLNC(false), bWriteTextTrace(false);
   bool bRunACTPF(false), bUseDispatch(false);
+  bool bBuildIndex(false), runIndexedSendRecv(false), runIndexedFuncStats(false);
+  bool runIndexedTimeline(false);
+  int nIndexBuckets(NINDEXBUCKETS), nIndexTLSlots(NINDEXTLSLOTS);
+  Real indexTStart(0.0), indexTStop(-1.0);
   string outfileName, delimString("\t");
   Vector<string> actFNames;
 
@@ -218,6 +232,36 @@ bool ProfParserBatchFunctions(int argc, char *argv[], bool runDefault,
         simpleCombine = false;
       } else if(strcmp(argv[ia], "-prof") == 0) {
         bParserProf = true;
+      } else if(strcmp(argv[ia], "-index") == 0) {   // ---- indexed options
+        if(bIOP) cout << "*** build the index." << endl;
+        bBuildIndex = true;
+      } else if(strcmp(argv[ia], "-nbk") == 0) {
+	if(ia < argc-2) {
+          nIndexBuckets = atoi(argv[ia+1]);
+	}
+        if(bIOP) cout << "*** nbk = " << nIndexBuckets << endl;
+	++ia;
+      } else if(strcmp(argv[ia], "-isr") == 0) {
+        if(bIOP) cout << "*** indexed send/recv matrix." << endl;
+        runIndexedSendRecv = true;
+      } else if(strcmp(argv[ia], "-ifs") == 0) {
+        if(bIOP) cout << "*** indexed function stats." << endl;
+        runIndexedFuncStats = true;
+      } else if(strcmp(argv[ia], "-irtl") == 0) {
+        runIndexedTimeline = true;
+	if(ia < argc-2 && atoi(argv[ia+1]) > 0) {
+          nIndexTLSlots = atoi(argv[ia+1]);
+	  ++ia;
+	}
+        if(bIOP) cout << "*** indexed region timeline:  nslots = " << nIndexTLSlots << endl;
+      } else if(strcmp(argv[ia], "-itr") == 0) {
+	if(ia < argc-3) {
+          indexTStart = atof(argv[ia+1]);
+          indexTStop  = atof(argv[ia+2]);
+	}
+        if(bIOP) cout << "*** indexed time range = [" << indexTStart << ", "
+	              << indexTStop << "]" << endl;
+	ia += 2;
       } else if(strcmp(argv[ia], "-dispatch") == 0) {
         if(bIOP) cout << "*** using dispatch interface." << endl;
         bUseDispatch = true;
@@ -236,6 +280,48 @@ bool ProfParserBatchFunctions(int argc, char *argv[], bool runDefault,
   BLProfStats::SetVerbose(verbose);
   std::string dirName(argv[argc - 1]);
 
+  // ---- the indexed queries stream only the records they need and
+  // ---- do not load the database into DataServices
+  bool anyIndexedRun = bBuildIndex || runIndexedSendRecv || runIndexedFuncStats ||
+                       runIndexedTimeline;
+  if(anyIndexedRun) {
+    ProfIndex profIndex(dirName);
+    if(bBuildIndex || ! ProfIndex::Exists(dirName)) {
+      if(bIOP) { cout << "Building the index of " << dirName << "." << endl; }
+      profIndex.Build(nIndexBuckets);
+    }
+    if( ! profIndex.Read()) {
+      amrex::Abort("ProfParserBatchFunctions:  cannot read the index of " + dirName);
+    }
+    if(runIndexedSendRecv) {
+      std::string srFileName("SendRecvMatrix.txt");
+      if(filenameSet) {
+        srFileName = outfileName;
+      }
+      profIndex.WriteSendRecvMatrix(srFileName, indexTStart, indexTStop);
+    }
+    if(runIndexedFuncStats) {
+      profIndex.WriteFunctionStats(cout, indexTStart, indexTStop);
+    }
+    if(runIndexedTimeline) {
+      std::string tlFileName("RegionTimeline");
+      if(filenameSet) {
+        tlFileName = outfileName;
+      }
+      profIndex.WriteRegionTimeline(tlFileName, nIndexTLSlots, indexTStart, indexTStop);
+    }
+  }
+
+  bool anyDataServicesRun = runCheck       || runSendRecv     || runSendRecvList || runSyncPointData   ||
+                            runSendsPF     || runTimelinePF   || tcEdisonOnly    || runStats           ||
+			    runRedist      || bMakeFilterFile || bWriteSummary   || bWriteTraceSummary ||
+                            bMakeRegionPlt || bWriteHTML      || bWriteHTMLNC    || bWriteTextTrace    ||
+                            glOnly         || bRunACTPF;
+  if(anyIndexedRun && ! anyDataServicesRun && ! proxMap) {
+    BL_PROFILE_VAR_STOP(ppbf);
+    return true;
+  }
+
   Amrvis::FileType fileType(Amrvis::PROFDATA);
   DataServices pdServices(dirName, fileType);
 
@@ -460,11 +546,7 @@ bool ProfParserBatchFunctions(int argc, char *argv[], bool runDefault,
 
 
 
-  bool anyFunctionsRun = runCheck       || runSendRecv     || runSendRecvList || runSyncPointData   ||
-                         runSendsPF     || runTimelinePF   || tcEdisonOnly    || runStats           ||
-			 runRedist      || bMakeFilterFile || bWriteSummary   || bWriteTraceSummary ||
-                         bMakeRegionPlt || bWriteHTML      || bWriteHTMLNC    || bWriteTextTrace    ||
-                         glOnly         || bRunACTPF;
+  bool anyFunctionsRun = anyDataServicesRun || anyIndexedRun;
 
   BL_PROFILE_VAR_STOP(ppbf);
 
@@ -0,0 +1,173 @@
+#include "Bench.H"
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace amrex;
+
+namespace {
+
+std::string escape (const std::string& s)
+{
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            r += '\\';
+            r += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            r += ' ';
+        } else {
+            r += c;
+        }
+    }
+    return r;
+}
+
+}
+
+int
+Bench::NWarmup ()
+{
+    int nwarmup = 1;
+    ParmParse pp("bench");
+    pp.query("nwarmup", nwarmup);
+    return nwarmup;
+}
+
+int
+Bench::NRepeat (const std::string& name)
+{
+    int nrepeat = 5;
+    {
+        ParmParse pp("bench");
+        pp.query("nrepeat", nrepeat);
+    }
+    ParmParse pp(name);
+    pp.query("nrepeat", nrepeat);
+    return std::max(nrepeat, 1);
+}
+
+BenchResult
+Bench::Time (const std::string& name, int nrepeat, const std::function<void()>& f)
+{
+    const int nwarmup = NWarmup();
+    for (int i = 0; i < nwarmup; ++i) {
+        f();
+    }
+
+    Vector<Real> t(nrepeat);
+    for (int i = 0; i < nrepeat; ++i) {
+        ParallelDescriptor::Barrier();
+        const Real t0 = amrex::second();
+        f();
+        t[i] = amrex::second() - t0;
+    }
+    ParallelDescriptor::ReduceRealMax(t.dataPtr(), nrepeat);
+
+    BenchResult r;
+    r.name = name;
+    r.nrepeat = nrepeat;
+    r.t_min = *std::min_element(t.begin(), t.end());
+    r.t_max = *std::max_element(t.begin(), t.end());
+    for (auto x : t) r.t_avg += x;
+    r.t_avg /= nrepeat;
+    return r;
+}
+
+Vector<int>
+Bench::Sweep (const std::string& name, const std::string& key, const Vector<int>& def)
+{
+    Vector<int> v;
+    ParmParse pp(name);
+    if (pp.countval(key.c_str()) > 0) {
+        pp.getarr(key.c_str(), v);
+    } else {
+        v = def;
+    }
+    return v;
+}
+
+void
+Bench::Report (Vector<BenchResult>& results, BenchResult&& r)
+{
+    std::string p;
+    for (auto const& kv : r.params) {
+        p += " " + kv.first + "=" + kv.second;
+    }
+    std::ostringstream os;
+    os << std::left << std::setw(14) << r.name << std::setw(44) << p << std::right
+       << std::setprecision(4) << std::setw(12) << r.t_min << std::setw(12) << r.t_avg;
+    if (r.cells > 0.0) {
+        os << std::setw(12) << r.cellsPerSec() << " cells/s";
+    }
+    if (r.bytes > 0.0) {
+        os << std::setw(12) << r.GBPerSec() << " GB/s";
+    }
+    if (r.particles > 0.0) {
+        os << std::setw(12) << r.particlesPerSec() << " particles/s";
+    }
+    amrex::Print() << os.str() << "\n";
+    results.push_back(std::move(r));
+}
+
+void
+Bench::WriteJSON (const std::string& filename, const Vector<BenchResult>& results)
+{
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    std::ofstream ofs(filename.c_str());
+    if (!ofs.good()) {
+        amrex::FileOpenFailed(filename);
+    }
+    ofs.precision(std::numeric_limits<double>::max_digits10);
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    ofs << "{\n"
+        << "  \"version\": 1,\n"
+        << "  \"amrex\": \"" << escape(amrex::Version()) << "\",\n"
+        << "  \"date\": \"" << date << "\",\n"
+        << "  \"dim\": " << AMREX_SPACEDIM << ",\n"
+        << "  \"nprocs\": " << ParallelDescriptor::NProcs() << ",\n"
+        << "  \"nthreads\": " << nthreads << ",\n"
+        << "  \"nwarmup\": " << NWarmup() << ",\n"
+        << "  \"results\": [";
+    for (int i = 0; i < results.size(); ++i)
+    {
+        auto const& r = results[i];
+        ofs << (i == 0 ? "\n" : ",\n")
+            << "    {\"name\": \"" << escape(r.name) << "\", \"params\": {";
+        for (int j = 0; j < r.params.size(); ++j) {
+            ofs << (j == 0 ? "" : ", ") << "\"" << escape(r.params[j].first) << "\": \""
+                << escape(r.params[j].second) << "\"";
+        }
+        ofs << "},\n"
+            << "     \"nrepeat\": " << r.nrepeat
+            << ", \"t_min\": " << r.t_min << ", \"t_avg\": " << r.t_avg << ", \"t_max\": " << r.t_max
+            << ",\n     \"cells\": " << r.cells << ", \"bytes\": " << r.bytes
+            << ", \"particles\": " << r.particles
+            << ",\n     \"cells_per_sec\": " << r.cellsPerSec() << ", \"GB_per_sec\": " << r.GBPerSec()
+            << ", \"particles_per_sec\": " << r.particlesPerSec() << "}";
+    }
+    ofs << "\n  ]\n}\n";
+
+    amrex::Print() << "Wrote " << results.size() << " results to " << filename << "\n";
+}
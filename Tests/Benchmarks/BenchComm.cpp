@@ -0,0 +1,178 @@
+#include "Bench.H"
+
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+
+using namespace amrex;
+
+namespace {
+
+int nCell (const std::string& name, int def)
+{
+    int n_cell = def;
+    ParmParse pp(name);
+    pp.query("n_cell", n_cell);
+    return n_cell;
+}
+
+Geometry periodicGeometry (const Box& domain)
+{
+    return Geometry(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                    CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+}
+
+}
+
+//
+// FillBoundary of a periodic domain.  cells is the number of ghost cells
+// filled and bytes the bytes of their data.
+//
+void benchFillBoundary (Vector<BenchResult>& results)
+{
+    const std::string name = "fillboundary";
+    const int n_cell = nCell(name, 128);
+    const int nrepeat = Bench::NRepeat(name);
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const Geometry geom = periodicGeometry(domain);
+
+    for (int box_size : Bench::Sweep(name, "box_size", {16, 32, 64}))
+    {
+        BoxArray ba(domain);
+        ba.maxSize(box_size);
+        DistributionMapping dm(ba);
+
+        for (int ngrow : Bench::Sweep(name, "ngrow", {1, 2, 4}))
+        {
+            for (int ncomp : Bench::Sweep(name, "ncomp", {1, 8}))
+            {
+                MultiFab mf(ba, dm, ncomp, ngrow);
+                mf.setVal(1.0);
+
+                BenchResult r = Bench::Time(name, nrepeat, [&] () {
+                    mf.FillBoundary(geom.periodicity());
+                });
+
+                double nghost = 0.0;
+                for (int i = 0; i < ba.size(); ++i) {
+                    nghost += amrex::grow(ba[i],ngrow).d_numPts() - ba[i].d_numPts();
+                }
+                r.cells = nghost;
+                r.bytes = nghost * ncomp * sizeof(Real);
+                Bench::AddParam(r, "n_cell", n_cell);
+                Bench::AddParam(r, "box_size", box_size);
+                Bench::AddParam(r, "ngrow", ngrow);
+                Bench::AddParam(r, "ncomp", ncomp);
+                Bench::Report(results, std::move(r));
+            }
+        }
+    }
+}
+
+//
+// ParallelCopy to boxes of half the size that are distributed round robin,
+// so that most of the data moves between processes.
+//
+void benchParallelCopy (Vector<BenchResult>& results)
+{
+    const std::string name = "parallelcopy";
+    const int n_cell = nCell(name, 128);
+    const int nrepeat = Bench::NRepeat(name);
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+
+    for (int box_size : Bench::Sweep(name, "box_size", {32, 64}))
+    {
+        BoxArray ba(domain);
+        ba.maxSize(box_size);
+        DistributionMapping dm(ba);
+
+        BoxArray dba(domain);
+        dba.maxSize(std::max(box_size/2, 1));
+        Vector<int> pmap(dba.size());
+        for (int i = 0; i < dba.size(); ++i) {
+            pmap[i] = i % ParallelDescriptor::NProcs();
+        }
+        DistributionMapping ddm(std::move(pmap));
+
+        for (int ncomp : Bench::Sweep(name, "ncomp", {1, 8}))
+        {
+            MultiFab src(ba, dm, ncomp, 0);
+            MultiFab dst(dba, ddm, ncomp, 0);
+            src.setVal(1.0);
+
+            BenchResult r = Bench::Time(name, nrepeat, [&] () {
+                dst.ParallelCopy(src, 0, 0, ncomp);
+            });
+
+            r.cells = domain.d_numPts();
+            r.bytes = domain.d_numPts() * ncomp * sizeof(Real);
+            Bench::AddParam(r, "n_cell", n_cell);
+            Bench::AddParam(r, "box_size", box_size);
+            Bench::AddParam(r, "ncomp", ncomp);
+            Bench::Report(results, std::move(r));
+        }
+    }
+}
+
+//
+// Global reductions of a MultiFab.  bytes is the data read.
+//
+void benchReduce (Vector<BenchResult>& results)
+{
+    const std::string name = "reduce";
+    const int n_cell = nCell(name, 128);
+    const int nrepeat = Bench::NRepeat(name);
+
+    int box_size = 32;
+    Vector<std::string> ops {"sum", "max", "norm2", "dot"};
+    {
+        ParmParse pp(name);
+        pp.query("box_size", box_size);
+        pp.queryarr("ops", ops);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(box_size);
+    DistributionMapping dm(ba);
+
+    for (int ncomp : Bench::Sweep(name, "ncomp", {1, 4}))
+    {
+        MultiFab x(ba, dm, ncomp, 0);
+        MultiFab y(ba, dm, ncomp, 0);
+        x.setVal(1.0);
+        y.setVal(2.0);
+
+        for (auto const& op : ops)
+        {
+            Real s = 0.0;
+            int nread = 1;
+            std::function<void()> f;
+            if (op == "sum") {
+                f = [&] () { for (int n = 0; n < ncomp; ++n) s += x.sum(n); };
+            } else if (op == "max") {
+                f = [&] () { for (int n = 0; n < ncomp; ++n) s += x.max(n); };
+            } else if (op == "norm2") {
+                f = [&] () { for (int n = 0; n < ncomp; ++n) s += x.norm2(n); };
+            } else if (op == "dot") {
+                f = [&] () { s += MultiFab::Dot(x, 0, y, 0, ncomp, 0); };
+                nread = 2;
+            } else {
+                amrex::Abort("amrex_bench: unknown reduce.ops " + op);
+            }
+
+            BenchResult r = Bench::Time(name, nrepeat, f);
+            amrex::ignore_unused(s);
+
+            r.name = name + "_" + op;
+            r.cells = domain.d_numPts() * ncomp;
+            r.bytes = domain.d_numPts() * ncomp * nread * sizeof(Real);
+            Bench::AddParam(r, "n_cell", n_cell);
+            Bench::AddParam(r, "box_size", box_size);
+            Bench::AddParam(r, "ncomp", ncomp);
+            Bench::Report(results, std::move(r));
+        }
+    }
+}
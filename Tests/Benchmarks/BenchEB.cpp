@@ -0,0 +1,68 @@
+#include "Bench.H"
+
+#include <AMReX_Print.H>
+
+#ifdef AMREX_USE_EB
+
+#include <AMReX_ParmParse.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF_Sphere.H>
+#include <AMReX_EBFabFactory.H>
+
+using namespace amrex;
+
+//
+// EB2::Build of a sphere and the EBFArrayBoxFactory of the finest level.
+// The parameters are under eb2_build, because eb2 is used by EB2 itself.
+// cells is the number of cells of the finest level.
+//
+void benchEB2 (Vector<BenchResult>& results)
+{
+    const std::string name = "eb2_build";
+    const int nrepeat = Bench::NRepeat(name);
+
+    int box_size = 32;
+    int max_coarsening_level = 2;
+    {
+        ParmParse pp(name);
+        pp.query("box_size", box_size);
+        pp.query("max_coarsening_level", max_coarsening_level);
+    }
+
+    for (int n_cell : Bench::Sweep(name, "n_cell", {64, 128}))
+    {
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        const Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                            CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        BoxArray ba(domain);
+        ba.maxSize(box_size);
+        DistributionMapping dm(ba);
+
+        EB2::SphereIF sphere(0.3, {AMREX_D_DECL(0.5,0.5,0.5)}, false);
+        auto gshop = EB2::makeShop(sphere);
+
+        BenchResult r = Bench::Time(name, nrepeat, [&] () {
+            EB2::Build(gshop, geom, max_coarsening_level, max_coarsening_level);
+            {
+                auto factory = makeEBFabFactory(geom, ba, dm, {2,2,2}, EBSupport::full);
+            }
+            EB2::IndexSpace::pop();
+        });
+
+        r.cells = domain.d_numPts();
+        Bench::AddParam(r, "n_cell", n_cell);
+        Bench::AddParam(r, "box_size", box_size);
+        Bench::AddParam(r, "max_coarsening_level", max_coarsening_level);
+        Bench::Report(results, std::move(r));
+    }
+}
+
+#else
+
+void benchEB2 (amrex::Vector<BenchResult>&)
+{
+    amrex::Print() << "amrex_bench: eb2_build skipped, AMReX was built without EB\n";
+}
+
+#endif
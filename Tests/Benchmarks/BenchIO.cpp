@@ -0,0 +1,71 @@
+#include "Bench.H"
+
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+//
+// VisMF::Write and VisMF::Read of a MultiFab with vismf.nfiles files.
+// bytes is the size of the data.  The files are written to vismf.dir and
+// removed at the end.
+//
+void benchVisMF (Vector<BenchResult>& results)
+{
+    const std::string name = "vismf";
+    const int nrepeat = Bench::NRepeat(name);
+
+    int n_cell = 128;
+    int box_size = 32;
+    int ncomp = 4;
+    std::string dir = "bench_vismf";
+    {
+        ParmParse pp(name);
+        pp.query("n_cell", n_cell);
+        pp.query("box_size", box_size);
+        pp.query("ncomp", ncomp);
+        pp.query("dir", dir);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(box_size);
+    DistributionMapping dm(ba);
+
+    MultiFab mf(ba, dm, ncomp, 0);
+    mf.setVal(1.0);
+    MultiFab mfin(ba, dm, ncomp, 0);
+
+    amrex::UtilCreateCleanDirectory(dir, true);
+    const std::string mfname = dir + "/mf";
+
+    for (int nfiles : Bench::Sweep(name, "nfiles", {1, 64}))
+    {
+        VisMF::SetNOutFiles(nfiles);
+        VisMF::SetMFFileInStreams(nfiles);
+
+        BenchResult w = Bench::Time(name, nrepeat, [&] () {
+            VisMF::Write(mf, mfname);
+        });
+        BenchResult r = Bench::Time(name, nrepeat, [&] () {
+            VisMF::Read(mfin, mfname);
+        });
+
+        w.name = "vismf_write";
+        r.name = "vismf_read";
+        for (auto* p : {&w, &r}) {
+            p->cells = domain.d_numPts();
+            p->bytes = domain.d_numPts() * ncomp * sizeof(Real);
+            Bench::AddParam(*p, "n_cell", n_cell);
+            Bench::AddParam(*p, "box_size", box_size);
+            Bench::AddParam(*p, "ncomp", ncomp);
+            Bench::AddParam(*p, "nfiles", nfiles);
+        }
+        Bench::Report(results, std::move(w));
+        Bench::Report(results, std::move(r));
+    }
+
+    VisMF::RemoveFiles(mfname);
+}
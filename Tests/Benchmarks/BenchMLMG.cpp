@@ -0,0 +1,87 @@
+#include "Bench.H"
+
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLPoisson.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+//
+// A fixed number of MLMG V-cycles of a Poisson problem with Dirichlet
+// boundaries, from a zero initial guess.  cells is the number of cells
+// times the number of V-cycles.
+//
+void benchMLMG (Vector<BenchResult>& results)
+{
+    const std::string name = "mlmg";
+    const int nrepeat = Bench::NRepeat(name);
+
+    int nvcycles = 4;
+    int box_size = 32;
+    {
+        ParmParse pp(name);
+        pp.query("nvcycles", nvcycles);
+        pp.query("box_size", box_size);
+    }
+
+    for (int n_cell : Bench::Sweep(name, "n_cell", {64, 128}))
+    {
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        const Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                            CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        BoxArray ba(domain);
+        ba.maxSize(box_size);
+        DistributionMapping dm(ba);
+
+        MultiFab phi(ba, dm, 1, 1);
+        MultiFab rhs(ba, dm, 1, 0);
+        phi.setVal(0.0);
+
+        const auto dx = geom.CellSizeArray();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(rhs,true); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            auto const& a = rhs.array(mfi);
+            amrex::LoopConcurrentOnCpu(bx, [=] (int i, int j, int k) noexcept
+            {
+                amrex::ignore_unused(j,k);
+                Real s = 1.0;
+                AMREX_D_TERM(s *= std::sin(3.14159265358979*(i+0.5)*dx[0]);,
+                             s *= std::sin(3.14159265358979*(j+0.5)*dx[1]);,
+                             s *= std::sin(3.14159265358979*(k+0.5)*dx[2]););
+                a(i,j,k) = s;
+            });
+        }
+
+        MLPoisson mlpoisson({geom}, {ba}, {dm});
+        mlpoisson.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                            LinOpBCType::Dirichlet,
+                                            LinOpBCType::Dirichlet)},
+                              {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                            LinOpBCType::Dirichlet,
+                                            LinOpBCType::Dirichlet)});
+        mlpoisson.setLevelBC(0, &phi);
+
+        MLMG mlmg(mlpoisson);
+        mlmg.setVerbose(0);
+        mlmg.setFixedIter(nvcycles);
+
+        BenchResult r = Bench::Time(name, nrepeat, [&] () {
+            phi.setVal(0.0);
+            mlmg.solve({&phi}, {&rhs}, 1.e-16, 0.0);
+        });
+
+        r.cells = domain.d_numPts() * nvcycles;
+        Bench::AddParam(r, "n_cell", n_cell);
+        Bench::AddParam(r, "box_size", box_size);
+        Bench::AddParam(r, "nvcycles", nvcycles);
+        Bench::Report(results, std::move(r));
+    }
+}
@@ -0,0 +1,140 @@
+#include "Bench.H"
+
+#include <AMReX_Print.H>
+
+#ifdef AMREX_PARTICLES
+
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleMesh.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+using BenchPC = ParticleContainer<1>;  // the mass
+using BenchParIter = ParIter<1>;
+
+// Move every particle by shift cells in each direction.
+void moveParticles (BenchPC& pc, Real shift)
+{
+    const auto dx = pc.Geom(0).CellSizeArray();
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (BenchParIter pti(pc, 0); pti.isValid(); ++pti)
+    {
+        auto& aos = pti.GetArrayOfStructs();
+        auto pstruct = aos().dataPtr();
+        const Long np = pti.numParticles();
+        AMREX_FOR_1D ( np, i,
+        {
+            auto& p = pstruct[i];
+            AMREX_D_TERM(p.pos(0) += shift*dx[0];,
+                         p.pos(1) += shift*dx[1];,
+                         p.pos(2) += shift*dx[2];);
+        });
+    }
+}
+
+}
+
+//
+// Redistribute after moving every particle particles.shift cells in each
+// direction, and the cloud-in-cell deposition of the mass with
+// ParticleToMesh, which includes the SumBoundary.  The redistribute time
+// includes the move.
+//
+void benchParticles (Vector<BenchResult>& results)
+{
+    const std::string name = "particles";
+    const int nrepeat = Bench::NRepeat(name);
+
+    int n_cell = 64;
+    int box_size = 32;
+    Real shift = 0.5;
+    {
+        ParmParse pp(name);
+        pp.query("n_cell", n_cell);
+        pp.query("box_size", box_size);
+        pp.query("shift", shift);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                        CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+    BoxArray ba(domain);
+    ba.maxSize(box_size);
+    DistributionMapping dm(ba);
+
+    for (int nppc : Bench::Sweep(name, "nppc", {1, 8}))
+    {
+        BenchPC pc(geom, dm, ba);
+        BenchPC::ParticleInitData pdata = {{1.0}, {}, {}, {}};
+        pc.InitNRandomPerCell(nppc, pdata);
+        const double np = static_cast<double>(pc.TotalNumberOfParticles());
+
+        {
+            BenchResult r = Bench::Time(name, nrepeat, [&] () {
+                moveParticles(pc, shift);
+                pc.Redistribute();
+            });
+            r.name = "redistribute";
+            r.particles = np;
+            Bench::AddParam(r, "n_cell", n_cell);
+            Bench::AddParam(r, "box_size", box_size);
+            Bench::AddParam(r, "nppc", nppc);
+            Bench::Report(results, std::move(r));
+        }
+
+        {
+            MultiFab rho(ba, dm, 1, 1);
+            const auto plo = geom.ProbLoArray();
+            const auto dxi = geom.InvCellSizeArray();
+
+            BenchResult r = Bench::Time(name, nrepeat, [&] () {
+                amrex::ParticleToMesh(pc, rho, 0,
+                    [=] AMREX_GPU_DEVICE (const BenchPC::ParticleType& p,
+                                          Array4<Real> const& a) noexcept
+                    {
+                        int iv[3] = {0, 0, 0};
+                        Real w[3][2] = {{1.0, 0.0}, {1.0, 0.0}, {1.0, 0.0}};
+                        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                            const Real x = (p.pos(d) - plo[d]) * dxi[d] - 0.5;
+                            iv[d] = static_cast<int>(std::floor(x));
+                            w[d][1] = x - iv[d];
+                            w[d][0] = 1.0 - w[d][1];
+                        }
+                        for (int kk = 0; kk < (AMREX_SPACEDIM > 2 ? 2 : 1); ++kk) {
+                            for (int jj = 0; jj < (AMREX_SPACEDIM > 1 ? 2 : 1); ++jj) {
+                                for (int ii = 0; ii < 2; ++ii) {
+                                    Gpu::Atomic::Add(&a(iv[0]+ii, iv[1]+jj, iv[2]+kk),
+                                                     w[0][ii]*w[1][jj]*w[2][kk]*p.rdata(0));
+                                }
+                            }
+                        }
+                    });
+            });
+            r.name = "deposit";
+            r.particles = np;
+            r.cells = domain.d_numPts();
+            Bench::AddParam(r, "n_cell", n_cell);
+            Bench::AddParam(r, "box_size", box_size);
+            Bench::AddParam(r, "nppc", nppc);
+            Bench::Report(results, std::move(r));
+        }
+    }
+}
+
+#else
+
+void benchParticles (amrex::Vector<BenchResult>&)
+{
+    amrex::Print() << "amrex_bench: particles skipped, AMReX was built without particles\n";
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include "Bench.H"
+
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_TagBox.H>
+#include <AMReX_Cluster.H>
+#include <AMReX_BoxDomain.H>
+
+using namespace amrex;
+
+namespace {
+
+// Tag a sphere of radius r cells at c on the coarse level.
+void tagSphere (TagBoxArray& tags, const RealVect& c, Real r)
+{
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(tags,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        auto const& a = tags.array(mfi);
+        amrex::LoopConcurrentOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            amrex::ignore_unused(j,k);
+            Real d2 = 0.0;
+            AMREX_D_TERM(d2 += (i+0.5-c[0])*(i+0.5-c[0]);,
+                         d2 += (j+0.5-c[1])*(j+0.5-c[1]);,
+                         d2 += (k+0.5-c[2])*(k+0.5-c[2]););
+            if (d2 <= r*r) a(i,j,k) = TagBox::SET;
+        });
+    }
+}
+
+}
+
+//
+// The steps of a regrid of a fine level with a refinement ratio of 2:
+// tagging a sphere on the coarse level, buffering, clustering, making the
+// new BoxArray and DistributionMapping, and copying the fine data from the
+// old fine grids.  The sphere moves back and forth by regrid.shift coarse
+// cells between the repeats.  cells is the number of coarse cells.
+//
+void benchRegrid (Vector<BenchResult>& results)
+{
+    const std::string name = "regrid";
+    const int nrepeat = Bench::NRepeat(name);
+
+    int n_cell = 128;
+    int box_size = 32;
+    int nbuf = 2;
+    int ncomp = 4;
+    Real grid_eff = 0.7;
+    Real shift = 4.0;
+    {
+        ParmParse pp(name);
+        pp.query("n_cell", n_cell);
+        pp.query("box_size", box_size);
+        pp.query("nbuf", nbuf);
+        pp.query("ncomp", ncomp);
+        pp.query("grid_eff", grid_eff);
+        pp.query("shift", shift);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(box_size);
+    DistributionMapping dm(ba);
+    const IntVect ratio(2);
+
+    MultiFab fine;
+    int iregrid = 0;
+
+    auto regrid = [&] ()
+    {
+        TagBoxArray tags(ba, dm, nbuf);
+        tags.setVal(TagBox::CLEAR);
+        const Real off = (iregrid++ % 2 == 0) ? 0.0 : shift;
+        tagSphere(tags, RealVect(AMREX_D_DECL(0.5*n_cell+off, 0.5*n_cell, 0.5*n_cell)), 0.25*n_cell);
+        tags.buffer(IntVect(nbuf));
+
+        Vector<IntVect> tagvec;
+        tags.collate(tagvec);
+        BoxList bl;
+        if (!tagvec.empty())
+        {
+            ClusterList clist(&tagvec[0], tagvec.size());
+            clist.chop(grid_eff);
+            BoxDomain bd;
+            bd.add(domain);
+            clist.intersect(bd);
+            clist.boxList(bl);
+            bl.simplify();
+            bl.maxSize(std::max(box_size/2, 1));
+            bl.refine(ratio);
+        }
+
+        BoxArray fba(std::move(bl));
+        DistributionMapping fdm(fba);
+        MultiFab newfine(fba, fdm, ncomp, 0);
+        newfine.setVal(0.0);
+        if (!fine.empty()) {
+            newfine.ParallelCopy(fine, 0, 0, ncomp);
+        }
+        fine = std::move(newfine);
+    };
+
+    BenchResult r = Bench::Time(name, nrepeat, regrid);
+    r.cells = domain.d_numPts();
+    Bench::AddParam(r, "n_cell", n_cell);
+    Bench::AddParam(r, "box_size", box_size);
+    Bench::AddParam(r, "nbuf", nbuf);
+    Bench::AddParam(r, "ncomp", ncomp);
+    Bench::Report(results, std::move(r));
+}
@@ -0,0 +1,71 @@
+//
+// amrex_bench: a suite of benchmarks of the core kernels with machine
+// readable results.
+//
+// The cases in bench.cases (all by default) are run in order.  Every case
+// sweeps its parameters, e.g., fillboundary.box_size = 16 32 64, and times
+// bench.nrepeat calls after bench.nwarmup calls for every combination.  A
+// line per result is printed, and all the results are written as JSON to
+// bench.output.  Tools/Benchmarks/bench_compare.py compares two such files
+// and reports the regressions.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include "Bench.H"
+
+#include <algorithm>
+#include <iomanip>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        const Vector<std::pair<std::string, void(*)(Vector<BenchResult>&)> > cases {
+            {"fillboundary", benchFillBoundary},
+            {"parallelcopy", benchParallelCopy},
+            {"reduce",       benchReduce},
+            {"mlmg",         benchMLMG},
+            {"particles",    benchParticles},
+            {"vismf",        benchVisMF},
+            {"regrid",       benchRegrid},
+            {"eb2_build",    benchEB2}
+        };
+
+        Vector<std::string> run;
+        std::string output = "bench.json";
+        {
+            ParmParse pp("bench");
+            pp.queryarr("cases", run);
+            pp.query("output", output);
+        }
+        if (run.empty()) {
+            for (auto const& c : cases) run.push_back(c.first);
+        }
+
+        amrex::Print() << std::left << std::setw(14) << "case" << std::setw(44) << " parameters"
+                       << std::right << std::setw(12) << "t_min (s)" << std::setw(12) << "t_avg (s)"
+                       << "    throughput\n";
+
+        Vector<BenchResult> results;
+        for (auto const& name : run)
+        {
+            auto it = std::find_if(cases.begin(), cases.end(),
+                                   [&] (const std::pair<std::string, void(*)(Vector<BenchResult>&)>& c)
+                                   { return c.first == name; });
+            if (it == cases.end()) {
+                amrex::Abort("amrex_bench: unknown case " + name);
+            }
+            it->second(results);
+        }
+
+        Bench::WriteJSON(output, results);
+    }
+    amrex::Finalize();
+}
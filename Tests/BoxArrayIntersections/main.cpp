@@ -0,0 +1,137 @@
+//
+// Compare the hash table and the sorted index of BoxArray (see
+// boxarray.sorted_index) on a BoxArray with many boxes.  For each index
+// the following are timed:
+//
+//   build: building the index
+//   query: intersections of all boxes grown by one cell (batched)
+//   FB:    FillBoundary metadata, including building the index
+//   CPC:   ParallelCopy metadata between two BoxArrays, including building
+//          the indices
+//
+// The results of the queries are checked to be the same.  Times are the
+// minimum over nrep repetitions and the maximum over the processes.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using namespace amrex;
+
+namespace {
+
+Real timeMin (int nrep, std::function<void()> const& f)
+{
+    Real tmin = std::numeric_limits<Real>::max();
+    for (int irep = 0; irep < nrep; ++irep) {
+        ParallelDescriptor::Barrier();
+        const Real t0 = amrex::second();
+        f();
+        tmin = std::min(tmin, amrex::second()-t0);
+    }
+    ParallelDescriptor::ReduceRealMax(tmin);
+    return tmin;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int n_cell = 512;
+        int max_grid_size = 8;
+        int max_grid_size_2 = 12;
+        int nrep = 3;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_grid_size_2", max_grid_size_2);
+            pp.query("nrep", nrep);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,1,1)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        // Unstructured copies, so that the hash table and the sorted index
+        // are used instead of the arithmetic of structured BoxArrays.
+        BoxArray ba(BoxArray(geom.Domain()).maxSize(max_grid_size).boxList());
+        DistributionMapping dm(ba);
+
+        BoxArray ba2(BoxArray(geom.Domain()).maxSize(max_grid_size_2).boxList());
+        DistributionMapping dm2(ba2);
+
+        MultiFab mf(ba, dm, 1, 1, MFInfo().SetAlloc(false));
+        MultiFab mf2(ba2, dm2, 1, 1, MFInfo().SetAlloc(false));
+
+        amrex::Print() << "Boxes: " << ba.size() << " and " << ba2.size() << "\n\n";
+
+        Vector<Box> query;
+        for (int i = 0; i < ba.size(); ++i) {
+            query.push_back(amrex::grow(ba[i],1));
+        }
+
+        Vector<Long> checksum(2, 0);
+        const bool use_sorted_index = BoxArray::UseSortedIndex();
+
+        for (int engine = 0; engine < 2; ++engine)
+        {
+            BoxArray::SetUseSortedIndex(engine == 1);
+
+            const Real t_build = timeMin(nrep, [&] () {
+                ba.clear_hash_bin();
+                ba.intersects(ba[0]);
+            });
+
+            Vector<std::vector<std::pair<int,Box> > > isects;
+            const Real t_query = timeMin(nrep, [&] () {
+                ba.intersections(query, isects);
+            });
+            for (int i = 0; i < isects.size(); ++i) {
+                for (int j = 0; j < isects[i].size(); ++j) {
+                    checksum[engine] += (j+1)*isects[i][j].first + isects[i][j].second.numPts();
+                }
+            }
+
+            const Real t_fb = timeMin(nrep, [&] () {
+                ba.clear_hash_bin();
+                FabArrayBase::FB fb(mf, IntVect(1), false, geom.periodicity(), false);
+            });
+
+            const Real t_cpc = timeMin(nrep, [&] () {
+                ba.clear_hash_bin();
+                ba2.clear_hash_bin();
+                FabArrayBase::CPC cpc(mf2, IntVect(1), mf, IntVect(0), geom.periodicity());
+            });
+
+            amrex::Print() << ((engine == 0) ? "Hash table" : "Sorted index") << ":\n"
+                           << "    build " << t_build << ", query " << t_query
+                           << ", FB " << t_fb << ", CPC " << t_cpc << " seconds\n";
+        }
+
+        ba.clear_hash_bin();
+        ba2.clear_hash_bin();
+        BoxArray::SetUseSortedIndex(use_sorted_index);
+
+        if (checksum[0] != checksum[1]) {
+            amrex::Abort("BoxArrayIntersections: the indices give different results");
+        }
+        amrex::Print() << "\nThe results are the same.\n";
+    }
+    amrex::Finalize();
+}
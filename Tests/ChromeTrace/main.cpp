@@ -0,0 +1,61 @@
+//
+// Write a Chrome trace of a few steps of FillBoundary calls, reductions and
+// regions.  Build with PROFILE = TRUE and COMM_PROFILE = TRUE and run with
+// blprofiler.chrome_trace = 1.  Open bl_prof/chrome_trace.json in
+// ui.perfetto.dev or chrome://tracing: every rank has a track of timers, one
+// of regions and one of MPI calls with arrows from the sends to the waits
+// that received them.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int nsteps = 5;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+        }
+
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+        MultiFab mf(ba, dm, 1, 1);
+        mf.setVal(1.0);
+
+        const Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                            CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+
+        Real sum = 0.0;
+        for (int step = 0; step < nsteps; ++step)
+        {
+            BL_PROFILE_REGION("Step");
+            {
+                BL_PROFILE("Exchange");
+                mf.FillBoundary(geom.periodicity());
+            }
+            {
+                BL_PROFILE("Reduce");
+                sum += mf.sum(0);
+            }
+        }
+
+        amrex::Print() << "sum = " << sum << "\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,309 @@
+//
+// Record and replay the communication pattern of FillBoundary, ParallelCopy
+// and SumBoundary.
+//
+// With mode = record, a few steps of these calls on a synthetic layout are
+// run with fabarray.comm_record = 1, which writes the messages of every call
+// to the directory fabarray.comm_record_file at Finalize.  Any application
+// run with fabarray.comm_record = 1 writes the same records.
+//
+// With mode = replay, the records of replay.file are re-issued with
+// synthetic buffers on any number of processes at or above the recorded
+// number, in the recorded order and with the recorded peers, bytes and tags.
+// The messages of a call are split into passes of fabarray.maxcomp
+// components like ParallelCopy does, and with replay.pack = 1 the buffers are
+// packed and unpacked.  The replay time of each kind of call is printed next
+// to its recorded time.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_Print.H>
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+using namespace amrex;
+
+namespace {
+
+struct Event
+{
+    int kind, tag, ncomp;
+    double t0, dt;
+    Vector<int>  send_rank, recv_rank;
+    Vector<Long> send_bytes, recv_bytes;
+};
+
+const char* const kind_names[] = {"FillBoundary", "ParallelCopy", "ParallelAdd"};
+const int nkinds = 3;
+
+void record ()
+{
+    int n_cell = 128;
+    int max_grid_size = 32;
+    int ncomp = 8;
+    int nsteps = 10;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("ncomp", ncomp);
+        pp.query("nsteps", nsteps);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+    MultiFab mf(ba, dm, ncomp, 2);
+    mf.setVal(1.0);
+
+    // Round robin, so that the copy to the smaller boxes is not all local.
+    BoxArray cba = ba;
+    cba.maxSize(max_grid_size/2);
+    Vector<int> pmap(cba.size());
+    for (int i = 0; i < cba.size(); ++i) pmap[i] = i % ParallelDescriptor::NProcs();
+    MultiFab cmf(cba, DistributionMapping(std::move(pmap)), ncomp, 0);
+
+    BoxArray nba = amrex::convert(ba, IntVect::TheNodeVector());
+    MultiFab nmf(nba, dm, 1, 1);
+    nmf.setVal(1.0);
+
+    const Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                        CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+
+    for (int step = 0; step < nsteps; ++step)
+    {
+        mf.FillBoundary(geom.periodicity());
+        cmf.ParallelCopy(mf, 0, 0, ncomp);
+        nmf.SumBoundary(geom.periodicity());
+    }
+
+    amrex::Print() << "Recorded " << nsteps << " steps, fabarray.comm_record = "
+                   << FabArrayBase::m_comm_record << "\n";
+}
+
+// Read the records of this process from the pattern directory.
+int readPattern (const std::string& dir, Vector<Event>& events)
+{
+    const std::string hname = dir + "/Header";
+    std::ifstream hf(hname.c_str());
+    if (!hf.good()) {
+        amrex::FileOpenFailed(hname);
+    }
+
+    const int myproc = ParallelDescriptor::MyProc();
+    int nprocs = -1;
+    std::string file;
+    Long seekpos = 0, nevents = 0;
+    std::string key;
+    while (hf >> key)
+    {
+        if (key == "NProcs") {
+            hf >> nprocs;
+        } else if (key == "Rank") {
+            int p;
+            std::string f;
+            Long s, n;
+            hf >> p >> f >> s >> n;
+            if (p == myproc) {
+                file = f;
+                seekpos = s;
+                nevents = n;
+            }
+        } else {
+            std::string rest;
+            std::getline(hf, rest);
+        }
+    }
+
+    if (nprocs > ParallelDescriptor::NProcs()) {
+        amrex::Abort("CommReplay: the pattern needs at least " + std::to_string(nprocs)
+                     + " processes");
+    }
+
+    events.clear();
+    if (myproc >= nprocs || nevents == 0) return nprocs;
+
+    const std::string dname = dir + "/" + file;
+    std::ifstream df(dname.c_str());
+    if (!df.good()) {
+        amrex::FileOpenFailed(dname);
+    }
+    df.seekg(seekpos, std::ios::beg);
+
+    events.resize(nevents);
+    for (auto& e : events)
+    {
+        std::string tok;
+        int ns, nr;
+        df >> tok >> e.kind >> e.tag >> e.ncomp >> e.t0 >> e.dt >> ns >> nr;
+        e.send_rank.resize(ns);
+        e.send_bytes.resize(ns);
+        e.recv_rank.resize(nr);
+        e.recv_bytes.resize(nr);
+        df >> tok;
+        for (int i = 0; i < ns; ++i) df >> e.send_rank[i] >> e.send_bytes[i];
+        df >> tok;
+        for (int i = 0; i < nr; ++i) df >> e.recv_rank[i] >> e.recv_bytes[i];
+        if (!df.good() || e.kind < 0 || e.kind >= nkinds) {
+            amrex::Abort("CommReplay: bad record in " + dname);
+        }
+    }
+    return nprocs;
+}
+
+// The bytes of a pass of nc of the ncomp components, aligned to 8 bytes.
+Long passBytes (Long bytes, int nc, int ncomp)
+{
+    const Long b = (bytes * nc + ncomp - 1) / ncomp;
+    return (b + 7) / 8 * 8;
+}
+
+void replayEvent (const Event& e, bool pack, Vector<char>& work)
+{
+#ifdef BL_USE_MPI
+    const int ns = e.send_rank.size();
+    const int nr = e.recv_rank.size();
+    const int ncomp = std::max(e.ncomp, 1);
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+
+    for (int ic = 0; ic < ncomp; ic += FabArrayBase::MaxComp)
+    {
+        const int nc = std::min(FabArrayBase::MaxComp, ncomp-ic);
+
+        Vector<Long> soff(ns+1, 0), roff(nr+1, 0);
+        for (int i = 0; i < ns; ++i) soff[i+1] = soff[i] + passBytes(e.send_bytes[i], nc, ncomp);
+        for (int i = 0; i < nr; ++i) roff[i+1] = roff[i] + passBytes(e.recv_bytes[i], nc, ncomp);
+
+        char* sbuf = (soff[ns] > 0) ? static_cast<char*>(The_FA_Arena()->alloc(soff[ns])) : nullptr;
+        char* rbuf = (roff[nr] > 0) ? static_cast<char*>(The_FA_Arena()->alloc(roff[nr])) : nullptr;
+
+        Vector<MPI_Request> rreqs(nr, MPI_REQUEST_NULL), sreqs(ns, MPI_REQUEST_NULL);
+        for (int i = 0; i < nr; ++i) {
+            MPI_Irecv(rbuf+roff[i], static_cast<int>(roff[i+1]-roff[i]), MPI_CHAR, e.recv_rank[i], e.tag,
+                      comm, &rreqs[i]);
+        }
+
+        if (pack && sbuf) {
+            // Gather from a FAB-sized work array like pack_send_buffer_cpu.
+            if (static_cast<Long>(work.size()) < soff[ns]) work.resize(soff[ns], 1);
+            std::memcpy(sbuf, work.data(), soff[ns]);
+        }
+        for (int i = 0; i < ns; ++i) {
+            MPI_Isend(sbuf+soff[i], static_cast<int>(soff[i+1]-soff[i]), MPI_CHAR, e.send_rank[i], e.tag,
+                      comm, &sreqs[i]);
+        }
+
+        if (nr > 0) {
+            MPI_Waitall(nr, rreqs.data(), MPI_STATUSES_IGNORE);
+        }
+        if (pack && rbuf) {
+            if (static_cast<Long>(work.size()) < roff[nr]) work.resize(roff[nr], 1);
+            std::memcpy(work.data(), rbuf, roff[nr]);
+        }
+        if (ns > 0) {
+            MPI_Waitall(ns, sreqs.data(), MPI_STATUSES_IGNORE);
+        }
+
+        if (sbuf) The_FA_Arena()->free(sbuf);
+        if (rbuf) The_FA_Arena()->free(rbuf);
+    }
+#else
+    amrex::ignore_unused(e, pack, work);
+#endif
+}
+
+void replay ()
+{
+    std::string file = "comm_pattern";
+    int nrepeat = 5;
+    bool pack = true;
+    {
+        ParmParse pp("replay");
+        pp.query("file", file);
+        pp.query("nrepeat", nrepeat);
+        pp.query("pack", pack);
+    }
+
+    Vector<Event> events;
+    const int nprocs_rec = readPattern(file, events);
+
+    // Per kind: calls, bytes sent, recorded time and replay time.
+    Vector<Long> ncalls(nkinds, 0), nbytes(nkinds, 0);
+    Vector<Real> trec(nkinds, 0.0), trep(nkinds, 0.0);
+    for (auto const& e : events) {
+        ncalls[e.kind] += 1;
+        for (auto b : e.send_bytes) nbytes[e.kind] += b;
+        trec[e.kind] += e.dt;
+    }
+
+    Vector<char> work;
+    Real twall = 0.0;
+    for (int irep = 0; irep < nrepeat; ++irep)
+    {
+        ParallelDescriptor::Barrier();
+        const Real t0 = amrex::second();
+        for (auto const& e : events)
+        {
+            const Real te = amrex::second();
+            replayEvent(e, pack, work);
+            trep[e.kind] += amrex::second() - te;
+        }
+        twall += amrex::second() - t0;
+    }
+    ParallelDescriptor::Barrier();
+
+    for (auto& t : trep) t /= std::max(nrepeat, 1);
+    twall /= std::max(nrepeat, 1);
+
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceLongSum(ncalls.dataPtr(), nkinds, ioproc);
+    ParallelDescriptor::ReduceLongSum(nbytes.dataPtr(), nkinds, ioproc);
+    ParallelDescriptor::ReduceRealMax(trec.dataPtr(), nkinds, ioproc);
+    ParallelDescriptor::ReduceRealMax(trep.dataPtr(), nkinds, ioproc);
+    ParallelDescriptor::ReduceRealMax(twall, ioproc);
+
+    amrex::Print() << "Replayed " << file << " of " << nprocs_rec << " processes on "
+                   << ParallelDescriptor::NProcs() << " with fabarray.maxcomp = "
+                   << FabArrayBase::MaxComp << " and replay.pack = " << pack << "\n"
+                   << "  times are the max over the processes, the replay is the average of "
+                   << nrepeat << " repeats\n\n";
+    amrex::Print() << std::setw(16) << std::left << "call" << std::right
+                   << std::setw(12) << "calls" << std::setw(16) << "bytes sent"
+                   << std::setw(14) << "recorded (s)" << std::setw(14) << "replay (s)" << "\n";
+    for (int k = 0; k < nkinds; ++k) {
+        if (ncalls[k] == 0) continue;
+        amrex::Print() << std::setw(16) << std::left << kind_names[k] << std::right
+                       << std::setw(12) << ncalls[k] << std::setw(16) << nbytes[k]
+                       << std::setw(14) << trec[k] << std::setw(14) << trep[k] << "\n";
+    }
+    amrex::Print() << "\nReplay wall time: " << twall << " s\n";
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        std::string mode = "replay";
+        {
+            ParmParse pp;
+            pp.query("mode", mode);
+        }
+
+        if (mode == "record") {
+            record();
+        } else if (mode == "replay") {
+            replay();
+        } else {
+            amrex::Abort("CommReplay: mode must be record or replay");
+        }
+    }
+    amrex::Finalize();
+}
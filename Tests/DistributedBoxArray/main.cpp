@@ -0,0 +1,150 @@
+//
+// Check that the FillBoundary and ParallelCopy metadata built from a
+// DistributedBoxArray are the same as those built from the replicated
+// BoxArray, for cell-centered and nodal boxes, with and without
+// periodicity, and print the metadata bytes per process.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_DistributedBoxArray.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+namespace {
+
+using Tag = FabArrayBase::CopyComTag;
+
+bool sameTag (const Tag& a, const Tag& b)
+{
+    return a.dbox == b.dbox && a.sbox == b.sbox && a.dstIndex == b.dstIndex && a.srcIndex == b.srcIndex;
+}
+
+bool sameTags (std::vector<Tag> a, std::vector<Tag> b)
+{
+    if (a.size() != b.size()) return false;
+    auto cmp = [] (const Tag& x, const Tag& y) {
+        return (x < y) || (!(y < x) && x.sbox.bigEnd() < y.sbox.bigEnd());
+    };
+    std::sort(a.begin(), a.end(), cmp);
+    std::sort(b.begin(), b.end(), cmp);
+    for (int i = 0, N = a.size(); i < N; ++i) {
+        if (!sameTag(a[i],b[i])) return false;
+    }
+    return true;
+}
+
+bool sameTags (const Tag::MapOfCopyComTagContainers& a, const Tag::MapOfCopyComTagContainers& b)
+{
+    if (a.size() != b.size()) return false;
+    for (const auto& kv : a) {
+        auto it = b.find(kv.first);
+        if (it == b.end() || kv.second.size() != it->second.size()) return false;
+        // The order matters for the messages.
+        for (int i = 0, N = kv.second.size(); i < N; ++i) {
+            if (!sameTag(kv.second[i], it->second[i])) return false;
+        }
+    }
+    return true;
+}
+
+bool sameMetaData (const FabArrayBase::CommMetaData& a, const FabArrayBase::CommMetaData& b)
+{
+    return sameTags(*a.m_LocTags, *b.m_LocTags)
+        && sameTags(*a.m_SndTags, *b.m_SndTags)
+        && sameTags(*a.m_RcvTags, *b.m_RcvTags);
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 128;
+        int max_grid_size = 16;
+        int max_grid_size_2 = 12;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_grid_size_2", max_grid_size_2);
+        }
+
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+
+        // Leave out a corner of the domain so that the BoxArrays are not trivial.
+        BoxList bl = amrex::boxDiff(domain, Box(IntVect(0), IntVect(n_cell/4-1)));
+        BoxArray ba(std::move(bl));
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        BoxArray ba2(domain);
+        ba2.maxSize(max_grid_size_2);
+        DistributionMapping dm2(ba2);
+
+        int nfail = 0;
+        Long dba_bytes = 0;
+
+        for (int nodal = 0; nodal < 2; ++nodal)
+        {
+            const IndexType typ = (nodal) ? IndexType::TheNodeType() : IndexType::TheCellType();
+            const BoxArray bat  = amrex::convert(ba,  typ);
+            const BoxArray bat2 = amrex::convert(ba2, typ);
+
+            MultiFab mf (bat , dm , 1, 2, MFInfo().SetAlloc(false));
+            MultiFab mf2(bat2, dm2, 1, 2, MFInfo().SetAlloc(false));
+
+            for (int periodic = 0; periodic < 2; ++periodic)
+            {
+                const Periodicity period = (periodic) ? Periodicity(IntVect(n_cell))
+                                                      : Periodicity::NonPeriodic();
+
+                DistributedBoxArray dba (bat , dm , IntVect(1), period);
+                DistributedBoxArray dba2(bat2, dm2, IntVect(1), period);
+                dba_bytes = std::max(dba_bytes, dba.bytes());
+
+                for (int ng = 0; ng <= 2; ++ng)
+                {
+                    for (int cross = 0; cross < 2; ++cross)
+                    {
+                        FabArrayBase::FB fb (mf , IntVect(ng), cross, period, false);
+                        FabArrayBase::FB dfb(dba, IntVect(ng), cross, period);
+                        if (!sameMetaData(fb, dfb)) {
+                            amrex::AllPrint() << "FB differs: nodal " << nodal << " periodic " << periodic
+                                              << " ng " << ng << " cross " << cross << "\n";
+                            ++nfail;
+                        }
+                    }
+
+                    FabArrayBase::CPC cpc (mf2 , IntVect(ng), mf , IntVect(0), period);
+                    FabArrayBase::CPC dcpc(dba2, IntVect(ng), dba, IntVect(0), period);
+                    if (!sameMetaData(cpc, dcpc)) {
+                        amrex::AllPrint() << "CPC differs: nodal " << nodal << " periodic " << periodic
+                                          << " ng " << ng << "\n";
+                        ++nfail;
+                    }
+                }
+            }
+        }
+
+        ParallelDescriptor::ReduceIntSum(nfail);
+        ParallelDescriptor::ReduceLongMax(dba_bytes);
+
+        const Long replicated_bytes = ba.size()*(sizeof(Box)+sizeof(int));
+        amrex::Print() << "Boxes: " << ba.size() << ", processes: " << ParallelDescriptor::NProcs() << "\n"
+                       << "Bytes of BoxArray and DistributionMapping: " << replicated_bytes << "\n"
+                       << "Max bytes of DistributedBoxArray per process: " << dba_bytes << "\n";
+
+        if (nfail > 0) {
+            amrex::Abort("DistributedBoxArray: the metadata differ");
+        }
+        amrex::Print() << "The metadata are the same.\n";
+    }
+    amrex::Finalize();
+}
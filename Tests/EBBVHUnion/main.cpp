@@ -0,0 +1,166 @@
+//
+// Check BVHUnionIF against the UnionIF of the same spheres, alone and
+// inside unions, intersections, differences, complements and translations.
+// The cell flags of every coarsening level must be the same, and the volume
+// fractions the same to the tolerance of the intercepts.  Most boxes of the
+// domain miss all the spheres, so they are classified by boxType, forwarded
+// through the composite functions, without sampling the function.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+// Number of cells with different flags and the max difference of volfrac.
+std::pair<Long,Real> compare (const EBFArrayBoxFactory& a, const EBFArrayBoxFactory& b)
+{
+    const auto& fa = a.getMultiEBCellFlagFab();
+    const auto& fb = b.getMultiEBCellFlagFab();
+    const auto& va = a.getVolFrac();
+    const auto& vb = b.getVolFrac();
+    Long nflags = 0;
+    Real vdiff = 0.0;
+    for (MFIter mfi(fa); mfi.isValid(); ++mfi)
+    {
+        Array4<EBCellFlag const> const& faa = fa.const_array(mfi);
+        Array4<EBCellFlag const> const& fba = fb.const_array(mfi);
+        Array4<Real const> const& vaa = va.const_array(mfi);
+        Array4<Real const> const& vba = vb.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k) noexcept
+        {
+            if (!(faa(i,j,k) == fba(i,j,k))) ++nflags;
+            vdiff = std::max(vdiff, std::abs(vaa(i,j,k)-vba(i,j,k)));
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(nflags);
+    ParallelDescriptor::ReduceRealMax(vdiff);
+    return std::make_pair(nflags, vdiff);
+}
+
+// Build the two functions and compare their index spaces on every level.
+template <class F, class G>
+int check (const std::string& name, F const& bvh, G const& plain, const Geometry& geom,
+           int max_grid_size, int max_coarsening_level)
+{
+    static_assert(EB2::HasBoxType<F>::value, "boxType is not forwarded");
+
+    EB2::Build(EB2::makeShop(bvh), geom, 0, max_coarsening_level);
+    const EB2::IndexSpace* is_bvh = &EB2::IndexSpace::top();
+    EB2::Build(EB2::makeShop(plain), geom, 0, max_coarsening_level);
+    const EB2::IndexSpace* is_plain = &EB2::IndexSpace::top();
+
+    int nfail = 0;
+    Geometry g = geom;
+    for (int ilev = 0; ilev <= max_coarsening_level; ++ilev)
+    {
+        // The coarse levels are built as long as the cells are single valued.
+        if (is_bvh->hasLevel(g.Domain()) != is_plain->hasLevel(g.Domain())) {
+            amrex::Print() << name << " on " << g.Domain() << ": only one is built  FAILED\n";
+            ++nfail;
+            break;
+        } else if (!is_bvh->hasLevel(g.Domain())) {
+            break;
+        }
+
+        BoxArray ba(g.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+        auto fa = makeEBFabFactory(is_bvh, g, ba, dm, {2,2,2}, EBSupport::full);
+        auto fb = makeEBFabFactory(is_plain, g, ba, dm, {2,2,2}, EBSupport::full);
+        auto r = compare(*fa, *fb);
+        const bool ok = r.first == 0 && r.second < 1.e-10;
+        amrex::Print() << name << " on " << g.Domain() << ": " << r.first << " different flags,"
+                       << " max diff of volfrac " << r.second << (ok ? "" : "  FAILED") << "\n";
+        if (!ok) ++nfail;
+        g.coarsen(IntVect(2));
+    }
+
+    EB2::IndexSpace::pop();
+    EB2::IndexSpace::pop();
+    return nfail;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int max_coarsening_level = 2;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_coarsening_level", max_coarsening_level);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        // Four spheres, two of them overlapping, with bounding boxes a
+        // little larger than the spheres.
+        const Real r[4] = {0.12, 0.1, 0.08, 0.15};
+        const RealArray c[4] = {{AMREX_D_DECL(0.3 , 0.3 , 0.3 )},
+                                {AMREX_D_DECL(0.42, 0.35, 0.31)},
+                                {AMREX_D_DECL(0.7 , 0.25, 0.6 )},
+                                {AMREX_D_DECL(0.6 , 0.7 , 0.7 )}};
+        Vector<EB2::SphereIF> spheres;
+        Vector<RealBox> bounds;
+        for (int i = 0; i < 4; ++i) {
+            spheres.emplace_back(r[i], c[i], false);
+            RealBox rb;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                rb.setLo(idim, c[i][idim]-1.01*r[i]);
+                rb.setHi(idim, c[i][idim]+1.01*r[i]);
+            }
+            bounds.push_back(rb);
+        }
+
+        auto bvh = EB2::makeBVHUnion(spheres, bounds);
+        auto plain = EB2::makeUnion(spheres[0], spheres[1], spheres[2], spheres[3]);
+        static_assert(!EB2::HasBoxType<decltype(plain)>::value,
+                      "a union of spheres cannot classify boxes");
+
+        EB2::BoxIF box({AMREX_D_DECL(0.15,0.15,0.15)}, {AMREX_D_DECL(0.85,0.85,0.85)}, true);
+        EB2::PlaneIF plane({AMREX_D_DECL(0.0,0.0,0.9)}, {AMREX_D_DECL(0.0,0.0,1.0)}, false);
+        const RealArray offset{AMREX_D_DECL(0.05,-0.03,0.02)};
+
+        int nfail = 0;
+        nfail += check("bvh", bvh, plain, geom, max_grid_size, max_coarsening_level);
+        nfail += check("union", EB2::makeUnion(bvh, plane), EB2::makeUnion(plain, plane),
+                       geom, max_grid_size, max_coarsening_level);
+        nfail += check("intersection", EB2::makeIntersection(bvh, EB2::makeComplement(box)),
+                       EB2::makeIntersection(plain, EB2::makeComplement(box)),
+                       geom, max_grid_size, max_coarsening_level);
+        nfail += check("difference", EB2::makeDifference(EB2::makeComplement(box), bvh),
+                       EB2::makeDifference(EB2::makeComplement(box), plain),
+                       geom, max_grid_size, max_coarsening_level);
+        nfail += check("complement", EB2::makeComplement(bvh), EB2::makeComplement(plain),
+                       geom, max_grid_size, max_coarsening_level);
+        nfail += check("translation", EB2::translate(bvh, offset), EB2::translate(plain, offset),
+                       geom, max_grid_size, max_coarsening_level);
+
+        if (nfail > 0) {
+            amrex::Abort("EBBVHUnion: the BVH union and the plain union differ");
+        }
+        amrex::Print() << "EBBVHUnion: the BVH union and the plain union agree\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,248 @@
+//
+// Fit the coefficients of the EB cost model (EBCostCoefficients) on this
+// machine.  Each box of a sphere geometry is timed with an EB kernel that
+// does what typical EB operators do: a plain stencil on regular boxes, and
+// area-fraction weighted fluxes plus a neighborhood redistribution on cut
+// cells.  The time of a box is then fitted as
+//
+//     t = c_regular * n_regular + c_cut * n_cut + c_covered * n_covered
+//
+// and the coefficients are printed, normalized so that c_regular = 1, as
+// inputs for eb2.cost_regular, eb2.cost_cut and eb2.cost_covered.  An
+// application with a very different kernel can replace ebKernel below.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_EBMultiFabUtil.H>
+#include <AMReX_MultiCutFab.H>
+#include <AMReX_Loop.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace amrex;
+
+namespace {
+
+void ebKernel (const Box& bx, FabType typ, Array4<Real> const& out, Array4<Real const> const& phi,
+               Array4<EBCellFlag const> const& flag, Array4<Real const> const& vfrac,
+               Array4<Real const> const& apx, Array4<Real const> const& apy,
+               Array4<Real const> const& apz)
+{
+    if (typ == FabType::covered)
+    {
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            out(i,j,k) = 0.0;
+        });
+    }
+    else if (typ == FabType::regular)
+    {
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            out(i,j,k) = phi(i-1,j,k) + phi(i+1,j,k) + phi(i,j-1,k) + phi(i,j+1,k)
+                +        phi(i,j,k-1) + phi(i,j,k+1) - 6.0*phi(i,j,k);
+        });
+    }
+    else
+    {
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            if (flag(i,j,k).isCovered()) {
+                out(i,j,k) = 0.0;
+            } else if (flag(i,j,k).isRegular()) {
+                out(i,j,k) = phi(i-1,j,k) + phi(i+1,j,k) + phi(i,j-1,k) + phi(i,j+1,k)
+                    +        phi(i,j,k-1) + phi(i,j,k+1) - 6.0*phi(i,j,k);
+            } else {
+                const Real fx = apx(i+1,j,k)*(phi(i+1,j,k)-phi(i,j,k))
+                    -           apx(i  ,j,k)*(phi(i,j,k)-phi(i-1,j,k));
+                const Real fy = apy(i,j+1,k)*(phi(i,j+1,k)-phi(i,j,k))
+                    -           apy(i,j  ,k)*(phi(i,j,k)-phi(i,j-1,k));
+                const Real fz = apz(i,j,k+1)*(phi(i,j,k+1)-phi(i,j,k))
+                    -           apz(i,j,k  )*(phi(i,j,k)-phi(i,j,k-1));
+                const Real div = (fx+fy+fz) / std::max(vfrac(i,j,k), Real(1.e-12));
+                // Redistribute to the connected neighbors, weighted by volume.
+                Real vtot = 0.0, wsum = 0.0;
+                for (int kk = -1; kk <= 1; ++kk) {
+                for (int jj = -1; jj <= 1; ++jj) {
+                for (int ii = -1; ii <= 1; ++ii) {
+                    if (flag(i,j,k).isConnected(ii,jj,kk)) {
+                        vtot += vfrac(i+ii,j+jj,k+kk);
+                        wsum += vfrac(i+ii,j+jj,k+kk)*phi(i+ii,j+jj,k+kk);
+                    }
+                }}}
+                out(i,j,k) = vfrac(i,j,k)*div + (1.0-vfrac(i,j,k))*wsum/std::max(vtot,Real(1.e-12));
+            }
+        });
+    }
+}
+
+// Solve the 3x3 system a x = b by Cramer's rule.
+bool solve3 (const Real a[3][3], const Real b[3], Real x[3])
+{
+    auto det3 = [] (const Real m[3][3]) {
+        return m[0][0]*(m[1][1]*m[2][2]-m[1][2]*m[2][1])
+            -  m[0][1]*(m[1][0]*m[2][2]-m[1][2]*m[2][0])
+            +  m[0][2]*(m[1][0]*m[2][1]-m[1][1]*m[2][0]);
+    };
+    const Real d = det3(a);
+    if (d == 0.0) return false;
+    for (int c = 0; c < 3; ++c) {
+        Real m[3][3];
+        for (int r = 0; r < 3; ++r) {
+            for (int cc = 0; cc < 3; ++cc) m[r][cc] = (cc == c) ? b[r] : a[r][cc];
+        }
+        x[c] = det3(m)/d;
+    }
+    return true;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int n_cell = 128;
+        int max_grid_size = 16;
+        int nrep = 5;
+        Real radius = 0.3;
+        Vector<Real> center {AMREX_D_DECL(0.5,0.5,0.5)};
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nrep", nrep);
+            pp.query("sphere_radius", radius);
+            pp.queryarr("sphere_center", center);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        EB2::SphereIF sphere(radius, {AMREX_D_DECL(center[0],center[1],center[2])}, false);
+        EB2::Build(EB2::makeShop(sphere), geom, 0, 0);
+
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        auto factory = makeEBFabFactory(geom, ba, dm, {2,2,2}, EBSupport::full);
+        const auto& flags = factory->getMultiEBCellFlagFab();
+        const auto& vfrac = factory->getVolFrac();
+        const auto areafrac = factory->getAreaFrac();
+
+        MultiFab phi(ba, dm, 1, 1, MFInfo(), *factory);
+        MultiFab out(ba, dm, 1, 0, MFInfo(), *factory);
+        for (MFIter mfi(phi); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.fabbox();
+            auto const& a = phi.array(mfi);
+            amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+            {
+                a(i,j,k) = std::sin(0.1*i) * std::cos(0.2*j) + 0.01*k;
+            });
+        }
+
+        const int nboxes = ba.size();
+        // n_regular, n_cut, n_covered, time
+        Vector<Real> data(4*nboxes, 0.0);
+
+        // Time each box serially; the minimum over the repetitions is used.
+        for (MFIter mfi(out); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            const auto& flagfab = flags[mfi];
+            const FabType typ = flagfab.getType(bx);
+            const auto& flag = flagfab.const_array();
+
+            Array4<Real const> apx, apy, apz;
+            if (typ != FabType::regular && typ != FabType::covered) {
+                apx = areafrac[0]->const_array(mfi);
+                apy = areafrac[1]->const_array(mfi);
+                apz = areafrac[2]->const_array(mfi);
+            }
+
+            Real tmin = std::numeric_limits<Real>::max();
+            for (int irep = 0; irep < nrep; ++irep) {
+                const Real t0 = amrex::second();
+                ebKernel(bx, typ, out.array(mfi), phi.const_array(mfi), flag,
+                         vfrac.const_array(mfi), apx, apy, apz);
+                tmin = std::min(tmin, amrex::second()-t0);
+            }
+
+            Long nregular = 0, ncovered = 0;
+            amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+            {
+                if (flag(i,j,k).isRegular()) {
+                    ++nregular;
+                } else if (flag(i,j,k).isCovered()) {
+                    ++ncovered;
+                }
+            });
+
+            const int i = mfi.index();
+            data[4*i  ] = nregular;
+            data[4*i+1] = bx.numPts() - nregular - ncovered;
+            data[4*i+2] = ncovered;
+            data[4*i+3] = tmin;
+        }
+
+        ParallelDescriptor::ReduceRealSum(data.data(), data.size());
+
+        // Least squares fit of the time per box.
+        Real ata[3][3] = {{0.,0.,0.},{0.,0.,0.},{0.,0.,0.}};
+        Real atb[3] = {0.,0.,0.};
+        Vector<int> ntype(3, 0);
+        for (int i = 0; i < nboxes; ++i) {
+            const Real* x = &data[4*i];
+            for (int r = 0; r < 3; ++r) {
+                for (int c = 0; c < 3; ++c) ata[r][c] += x[r]*x[c];
+                atb[r] += x[r]*x[3];
+                if (x[r] > 0.0) ++ntype[r];
+            }
+        }
+
+        Real coef[3];
+        if (ntype[0] == 0 || ntype[1] == 0 || ntype[2] == 0 || !solve3(ata, atb, coef)) {
+            amrex::Abort("EBCostCalibration: need boxes with regular, cut and covered cells");
+        }
+
+        Real ss_res = 0.0, ss_tot = 0.0, tmean = 0.0;
+        for (int i = 0; i < nboxes; ++i) tmean += data[4*i+3];
+        tmean /= nboxes;
+        for (int i = 0; i < nboxes; ++i) {
+            const Real* x = &data[4*i];
+            const Real r = x[3] - (coef[0]*x[0] + coef[1]*x[1] + coef[2]*x[2]);
+            ss_res += r*r;
+            ss_tot += (x[3]-tmean)*(x[3]-tmean);
+        }
+
+        amrex::Print() << "Boxes: " << nboxes << " (with regular cells: " << ntype[0]
+                       << ", cut cells: " << ntype[1] << ", covered cells: " << ntype[2] << ")\n"
+                       << "Time per cell (s): regular " << coef[0] << ", cut " << coef[1]
+                       << ", covered " << coef[2] << "\n"
+                       << "R^2 of the fit: " << ((ss_tot > 0.0) ? 1.0-ss_res/ss_tot : 1.0) << "\n\n";
+
+        if (coef[0] <= 0.0) {
+            amrex::Abort("EBCostCalibration: nonpositive cost of regular cells");
+        }
+        amrex::Print() << "eb2.cost_regular = 1.0\n"
+                       << "eb2.cost_cut     = " << std::max(coef[1]/coef[0], Real(0.0)) << "\n"
+                       << "eb2.cost_covered = " << std::max(coef[2]/coef[0], Real(0.0)) << "\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,176 @@
+//
+// Round trip of an EB2 index space through IndexSpace::write and
+// IndexSpaceFile.  The cell flags, volume fractions, centroids, boundary
+// data, area fractions and face centroids of every level of the index
+// space read back must be the same as those of the built one.  To check a
+// read with a different number of processes, run with mode = write on some
+// processes and then with mode = read on another number of processes.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_MultiCutFab.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+Real maxdiff (const MultiFab& a, const MultiFab& b)
+{
+    Real r = 0.0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        Array4<Real const> const& aa = a.const_array(mfi);
+        Array4<Real const> const& ba = b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), a.nComp(), [&] (int i, int j, int k, int n) noexcept
+        {
+            r = std::max(r, std::abs(aa(i,j,k,n)-ba(i,j,k,n)));
+        });
+    }
+    return r;
+}
+
+Real maxdiff (const MultiCutFab& a, const MultiCutFab& b, const FabArray<EBCellFlagFab>& flags)
+{
+    Real r = 0.0;
+    for (MFIter mfi(flags); mfi.isValid(); ++mfi)
+    {
+        if (a.ok(mfi) != b.ok(mfi)) return 1.0;
+        if (!a.ok(mfi)) continue;
+        Array4<Real const> const& aa = a.const_array(mfi);
+        Array4<Real const> const& ba = b.const_array(mfi);
+        amrex::LoopOnCpu(a[mfi].box(), a.nComp(), [&] (int i, int j, int k, int n) noexcept
+        {
+            r = std::max(r, std::abs(aa(i,j,k,n)-ba(i,j,k,n)));
+        });
+    }
+    return r;
+}
+
+// Number of cells with different flags
+Long ndiff (const FabArray<EBCellFlagFab>& a, const FabArray<EBCellFlagFab>& b)
+{
+    Long r = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        Array4<EBCellFlag const> const& aa = a.const_array(mfi);
+        Array4<EBCellFlag const> const& ba = b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k) noexcept
+        {
+            if (!(aa(i,j,k) == ba(i,j,k))) ++r;
+        });
+    }
+    return r;
+}
+
+// Compare the data of the two index spaces on the level of geom.
+int compare (const EB2::IndexSpace& built, const EB2::IndexSpace& read, const Geometry& geom,
+             int max_grid_size)
+{
+    BoxArray ba(geom.Domain());
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    auto fa = makeEBFabFactory(&built, geom, ba, dm, {2,2,2}, EBSupport::full);
+    auto fb = makeEBFabFactory(&read, geom, ba, dm, {2,2,2}, EBSupport::full);
+    const auto& flags = fa->getMultiEBCellFlagFab();
+
+    Long nflags = ndiff(flags, fb->getMultiEBCellFlagFab());
+    Vector<Real> diff{maxdiff(fa->getVolFrac(), fb->getVolFrac()),
+                      maxdiff(fa->getCentroid(), fb->getCentroid(), flags),
+                      maxdiff(fa->getBndryCent(), fb->getBndryCent(), flags),
+                      maxdiff(fa->getBndryArea(), fb->getBndryArea(), flags),
+                      maxdiff(fa->getBndryNormal(), fb->getBndryNormal(), flags),
+                      0.0, 0.0};
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        diff[5] = std::max(diff[5], maxdiff(*fa->getAreaFrac()[idim], *fb->getAreaFrac()[idim], flags));
+        diff[6] = std::max(diff[6], maxdiff(*fa->getFaceCent()[idim], *fb->getFaceCent()[idim], flags));
+    }
+    ParallelDescriptor::ReduceLongSum(nflags);
+    ParallelDescriptor::ReduceRealMax(diff.data(), diff.size());
+
+    const bool ok = nflags == 0 && *std::max_element(diff.begin(), diff.end()) == 0.0;
+    amrex::Print() << "domain " << geom.Domain() << ": " << nflags << " different flags,"
+                   << " max diff of volfrac " << diff[0] << ", centroid " << diff[1]
+                   << ", bndrycent " << diff[2] << ", bndryarea " << diff[3]
+                   << ", bndrynorm " << diff[4] << ", areafrac " << diff[5]
+                   << ", facecent " << diff[6] << (ok ? "" : "  FAILED") << "\n";
+    return ok ? 0 : 1;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int max_coarsening_level = 2;
+        Real radius = 0.3;
+        Vector<Real> center {AMREX_D_DECL(0.5,0.5,0.5)};
+        std::string mode = "both";
+        std::string dirname = "eb_index_space";
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_coarsening_level", max_coarsening_level);
+            pp.query("sphere_radius", radius);
+            pp.queryarr("sphere_center", center);
+            pp.query("mode", mode);
+            pp.query("dirname", dirname);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        EB2::SphereIF sphere(radius, {AMREX_D_DECL(center[0],center[1],center[2])}, false);
+        EB2::Build(EB2::makeShop(sphere), geom, max_coarsening_level, max_coarsening_level);
+        const EB2::IndexSpace& built = EB2::IndexSpace::top();
+
+        if (mode == "write" || mode == "both") {
+            built.write(dirname);
+            amrex::Print() << "EBIndexSpaceIO: wrote " << dirname << " on "
+                           << ParallelDescriptor::NProcs() << " processes\n";
+        }
+
+        if (mode == "read" || mode == "both")
+        {
+            EB2::IndexSpaceFile read(dirname);
+            amrex::Print() << "EBIndexSpaceIO: read " << dirname << " on "
+                           << ParallelDescriptor::NProcs() << " processes\n";
+
+            int nfail = 0;
+            Geometry g = geom;
+            for (int ilev = 0; ilev <= max_coarsening_level; ++ilev)
+            {
+                if (!read.hasLevel(g.Domain())) {
+                    amrex::Print() << "domain " << g.Domain() << " is missing  FAILED\n";
+                    ++nfail;
+                } else {
+                    nfail += compare(built, read, g, max_grid_size);
+                }
+                g.coarsen(IntVect(2));
+            }
+
+            if (nfail > 0) {
+                amrex::Abort("EBIndexSpaceIO: the index space read back differs");
+            }
+            amrex::Print() << "EBIndexSpaceIO: the index space read back agrees\n";
+        }
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,148 @@
+//
+// Check LSFactory::FillSweep on a sphere.  In the band, the level set must
+// be the exact signed distance to the sphere within tol cells, and the
+// nodes shared by two boxes must have the same value in both.  The error of
+// LSFactory::Fill is printed for reference.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_EB_levelset.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+// Max error, in cells, of the level set on the nodes within band cells of
+// the sphere.
+Real error (const MultiFab& ls, const Geometry& geom, Real radius, const RealArray& center,
+            int band)
+{
+    const auto problo = geom.ProbLoArray();
+    const auto dx = geom.CellSizeArray();
+    Real r = 0.0;
+    for (MFIter mfi(ls); mfi.isValid(); ++mfi)
+    {
+        Array4<Real const> const& phi = ls.const_array(mfi);
+        amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+        {
+            const int ii[3] = {i, j, k};
+            Real d2 = 0.0;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                const Real x = problo[idim] + ii[idim]*dx[idim] - center[idim];
+                d2 += x*x;
+            }
+            const Real exact = std::sqrt(d2) - radius;
+            if (std::abs(exact) < band*dx[0]) {
+                r = std::max(r, std::abs(phi(i,j,k)-exact)/dx[0]);
+            }
+        });
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+// Number of nodes shared by two boxes with different values.
+Long nshared_differ (const MultiFab& ls)
+{
+    const BoxArray& ba = ls.boxArray();
+    Vector<int> pmap(ba.size(), ParallelDescriptor::IOProcessorNumber());
+    MultiFab all(ba, DistributionMapping(pmap), 1, 0);
+    all.Redistribute(ls, 0, 0, 1, IntVect(0));
+
+    Long r = 0;
+    if (ParallelDescriptor::IOProcessor())
+    {
+        for (int ibox = 0; ibox < ba.size(); ++ibox)
+        {
+            Array4<Real const> const& a = all.const_array(ibox);
+            for (auto const& is : ba.intersections(ba[ibox]))
+            {
+                if (is.first <= ibox) continue;
+                Array4<Real const> const& b = all.const_array(is.first);
+                amrex::LoopOnCpu(is.second, [&] (int i, int j, int k) noexcept
+                {
+                    if (a(i,j,k) != b(i,j,k)) ++r;
+                });
+            }
+        }
+    }
+    ParallelDescriptor::Bcast(&r, 1, ParallelDescriptor::IOProcessorNumber());
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int band = 6;
+        Real radius = 0.3;
+        Vector<Real> center {AMREX_D_DECL(0.5,0.5,0.5)};
+        Real tol = 0.2;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("band", band);
+            pp.query("sphere_radius", radius);
+            pp.queryarr("sphere_center", center);
+            pp.query("tol", tol);
+        }
+        const RealArray c{AMREX_D_DECL(center[0],center[1],center[2])};
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        EB2::SphereIF sphere(radius, c, false);
+        auto gshop = EB2::makeShop(sphere);
+        EB2::Build(gshop, geom, 0, 0);
+        const EB2::Level& eb_level = EB2::IndexSpace::top().getLevel(geom);
+
+        LSFactory ls_sweep(0, 1, 1, 2, band, ba, geom, dm);
+        LSFactory ls_fill (0, 1, 1, 2, band, ba, geom, dm);
+
+        const int eb_pad = ls_sweep.get_eb_pad();
+        EBFArrayBoxFactory eb_factory(eb_level, geom, ba, dm, {eb_pad, eb_pad, eb_pad},
+                                      EBSupport::full);
+        GShopLSFactory<EB2::SphereIF> ls_gshop(gshop, ls_sweep);
+        std::unique_ptr<MultiFab> mf_impfunc = ls_gshop.fill_impfunc();
+
+        ls_sweep.FillSweep(eb_factory, *mf_impfunc, band);
+        ls_fill.Fill(eb_factory, *mf_impfunc, band);
+
+        const Real err_sweep = error(*ls_sweep.get_data(), geom, radius, c, band);
+        const Real err_fill  = error(*ls_fill.get_data(), geom, radius, c, band);
+        const Long nshared   = nshared_differ(*ls_sweep.get_data());
+
+        amrex::Print() << "max error in the band: FillSweep " << err_sweep << " cells, Fill "
+                       << err_fill << " cells" << (err_sweep <= tol ? "" : "  FAILED") << "\n"
+                       << "shared nodes with different values: " << nshared
+                       << (nshared == 0 ? "" : "  FAILED") << "\n";
+
+        if (err_sweep > tol || nshared > 0) {
+            amrex::Abort("EBLevelSetSweep: the swept level set is wrong");
+        }
+        amrex::Print() << "EBLevelSetSweep: the swept level set agrees with the distance\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,248 @@
+//
+// Check a MultiFab with the boxes covered by EB skipped
+// (eb2.skip_covered_boxes = 1).  FillBoundary must set the ghost cells
+// overlapping skipped boxes to the covered value and fill the others, and
+// ParallelCopy must set the cells it copies from skipped boxes to it.  An
+// MFIter of a MultiFab without skipped boxes must read the covered value in
+// the skipped boxes, and VisMF and the plotfile writer must write the
+// covered value there.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <limits>
+
+using namespace amrex;
+
+namespace {
+
+Real value (int i, int j, int k) noexcept
+{
+    return i + 100.*j + 10000.*k;
+}
+
+// Number of valid cells of mf that are not cv in the skipped boxes of
+// skipped, or not value elsewhere.
+Long nwrong (const MultiFab& mf, const MultiFab& skipped, Real cv)
+{
+    Long r = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const bool skip = skipped.isSkipped(mfi.index());
+        Array4<Real const> const& a = mf.const_array(mfi);
+        amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+        {
+            const Real v = skip ? cv : value(i,j,k);
+            if (a(i,j,k) != v) ++r;
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(r);
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        Vector<Real> box_lo {AMREX_D_DECL(0.2,0.2,0.2)};
+        Vector<Real> box_hi {AMREX_D_DECL(0.8,0.8,0.8)};
+        Real cv = -1.0;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.queryarr("box_lo", box_lo);
+            pp.queryarr("box_hi", box_hi);
+            pp.query("covered_value", cv);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,1,1)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        EB2::BoxIF box({AMREX_D_DECL(box_lo[0],box_lo[1],box_lo[2])},
+                       {AMREX_D_DECL(box_hi[0],box_hi[1],box_hi[2])}, false);
+        auto gshop = EB2::makeShop(box);
+        EB2::Build(gshop, geom, 0, 0);
+        const EB2::Level& eb_level = EB2::IndexSpace::top().getLevel(geom);
+        EBFArrayBoxFactory factory(eb_level, geom, ba, dm, {2,2,2}, EBSupport::full);
+
+        const int ng = 2;
+        MultiFab mf(ba, dm, 1, ng, MFInfo(), factory);
+        mf.setCoveredValue(cv);
+
+        int nskipped = 0;
+        for (int i = 0; i < ba.size(); ++i) {
+            if (mf.isSkipped(i)) ++nskipped;
+        }
+
+        bool failed = (nskipped == 0);
+        amrex::Print() << "skipped boxes: " << nskipped << " of " << ba.size()
+                       << (nskipped > 0 ? "" : "  FAILED") << "\n";
+
+        // The valid cells that are not skipped have value, the ghost cells NaN.
+        mf.setVal(std::numeric_limits<Real>::quiet_NaN(), ng);
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            Array4<Real> const& a = mf.array(mfi);
+            amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+            {
+                a(i,j,k) = value(i,j,k);
+            });
+        }
+
+        // FillBoundary
+        {
+            mf.FillBoundary(geom.periodicity());
+
+            // Which cells of the domain are in skipped boxes
+            Vector<char> covered(geom.Domain().numPts(), 0);
+            for (int ibox = 0; ibox < ba.size(); ++ibox) {
+                if (!mf.isSkipped(ibox)) continue;
+                amrex::LoopOnCpu(ba[ibox], [&] (int i, int j, int k) noexcept
+                {
+                    covered[i + n_cell*(j + n_cell*k)] = 1;
+                });
+            }
+
+            Long nbad = 0, ncov = 0;
+            for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+            {
+                Array4<Real const> const& a = mf.const_array(mfi);
+                const Box& vbx = mfi.validbox();
+                amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k) noexcept
+                {
+                    if (vbx.contains(IntVect(AMREX_D_DECL(i,j,k)))) return;
+                    const int ii = (i+n_cell) % n_cell;
+                    const int jj = (j+n_cell) % n_cell;
+                    const int kk = (k+n_cell) % n_cell;
+                    if (covered[ii + n_cell*(jj + n_cell*kk)]) {
+                        ++ncov;
+                        if (a(i,j,k) != cv) ++nbad;
+                    } else if (a(i,j,k) != value(ii,jj,kk)) {
+                        ++nbad;
+                    }
+                });
+            }
+            ParallelDescriptor::ReduceLongSum(nbad);
+            ParallelDescriptor::ReduceLongSum(ncov);
+            failed = failed || nbad > 0 || ncov == 0;
+            amrex::Print() << "FillBoundary: " << nbad << " wrong ghost cells, " << ncov
+                           << " overlapping skipped boxes"
+                           << (nbad == 0 && ncov > 0 ? "" : "  FAILED") << "\n";
+        }
+
+        // ParallelCopy into a MultiFab without skipped boxes, with another
+        // DistributionMapping, and into the ghost cells of one.
+        {
+            Vector<int> pmap = dm.ProcessorMap();
+            std::rotate(pmap.begin(), pmap.begin()+1, pmap.end());
+            DistributionMapping dm2(pmap);
+            MultiFab dst(ba, dm2, 1, 0);
+            dst.setVal(std::numeric_limits<Real>::quiet_NaN());
+            dst.ParallelCopy(mf, 0, 0, 1);
+            const Long n1 = nwrong(dst, mf, cv);
+
+            BoxArray ba2 = ba;
+            ba2.maxSize(max_grid_size/2);
+            MultiFab dst2(ba2, DistributionMapping(ba2), 1, 1);
+            dst2.setVal(std::numeric_limits<Real>::quiet_NaN());
+            dst2.ParallelCopy(mf, 0, 0, 1, IntVect(0), IntVect(1), geom.periodicity());
+            Long n2 = 0;
+            for (MFIter mfi(dst2); mfi.isValid(); ++mfi)
+            {
+                Array4<Real const> const& a = dst2.const_array(mfi);
+                amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k) noexcept
+                {
+                    if (a(i,j,k) != a(i,j,k)) ++n2;
+                });
+            }
+            ParallelDescriptor::ReduceLongSum(n2);
+
+            failed = failed || n1 > 0 || n2 > 0;
+            amrex::Print() << "ParallelCopy: " << n1 << " wrong cells"
+                           << (n1 == 0 ? "" : "  FAILED") << "\n"
+                           << "ParallelCopy into ghost cells: " << n2 << " cells not set"
+                           << (n2 == 0 ? "" : "  FAILED") << "\n";
+        }
+
+        // VisMF and plotfile output, read back without skipped boxes, and
+        // VisMF input into a MultiFab with skipped boxes.
+        {
+            VisMF::Write(mf, "skip_vismf");
+            WriteSingleLevelPlotfile("skip_plt", mf, {"phi"}, geom, 0.0, 0);
+
+            MultiFab r1(ba, dm, 1, 0), r2(ba, dm, 1, 0);
+            VisMF::Read(r1, "skip_vismf");
+            VisMF::Read(r2, "skip_plt/Level_0/Cell");
+            MultiFab r3(ba, dm, 1, 0, MFInfo(), factory);
+            VisMF::Read(r3, "skip_vismf");
+
+            const Long n1 = nwrong(r1, mf, cv);
+            const Long n2 = nwrong(r2, mf, cv);
+            const Long n3 = nwrong(r3, mf, cv);
+            failed = failed || n1 > 0 || n2 > 0 || n3 > 0;
+            amrex::Print() << "VisMF: " << n1 << " wrong cells" << (n1 == 0 ? "" : "  FAILED") << "\n"
+                           << "plotfile: " << n2 << " wrong cells" << (n2 == 0 ? "" : "  FAILED") << "\n"
+                           << "VisMF read into skipped: " << n3 << " wrong cells"
+                           << (n3 == 0 ? "" : "  FAILED") << "\n";
+        }
+
+        // An MFIter of a MultiFab without skipped boxes reads the covered
+        // value in the skipped boxes, with threads sharing their first
+        // access.  The MFIter of mf still skips them.
+        {
+            MultiFab other(ba, dm, 1, 0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for (MFIter mfi(other, IntVect(4)); mfi.isValid(); ++mfi)
+            {
+                Array4<Real const> const& a = mf.const_array(mfi);
+                Array4<Real> const& b = other.array(mfi);
+                amrex::LoopOnCpu(mfi.tilebox(), [&] (int i, int j, int k) noexcept
+                {
+                    b(i,j,k) = a(i,j,k);
+                });
+            }
+            const Long n = nwrong(other, mf, cv);
+
+            int nvisited = 0;
+            for (MFIter mfi(mf); mfi.isValid(); ++mfi) ++nvisited;
+            ParallelDescriptor::ReduceIntSum(nvisited);
+
+            failed = failed || n > 0 || nvisited != ba.size() - nskipped;
+            amrex::Print() << "MFIter of another MultiFab: " << n << " wrong cells"
+                           << (n == 0 ? "" : "  FAILED") << "\n"
+                           << "boxes visited by the MFIter of the skipped MultiFab: " << nvisited
+                           << (nvisited == ba.size() - nskipped ? "" : "  FAILED") << "\n";
+        }
+
+        if (failed) {
+            amrex::Abort("EBSkipCoveredBoxes: the skipped boxes are not handled");
+        }
+        amrex::Print() << "EBSkipCoveredBoxes: the skipped boxes are handled\n";
+    }
+    amrex::Finalize();
+}
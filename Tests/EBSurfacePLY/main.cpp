@@ -0,0 +1,174 @@
+//
+// Check WriteEBSurfacePLY on a sphere.  Without welding, every cut cell has
+// its own polygon, so the file has nf + 2 ncut vertices for nf triangles
+// and ncut cut cells.  With welding, and all the boxes on one process, the
+// surface must be closed and consistently oriented: every edge is in one
+// triangle in each direction, and nv = nf/2 + 2 as for any triangulated
+// sphere.  The same must hold after decimation.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_WriteEBSurfacePLY.H>
+#include <AMReX_Print.H>
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace amrex;
+
+namespace {
+
+struct Mesh
+{
+    Long nv = 0;
+    Vector<std::array<int,3> > tri;
+};
+
+// Read a binary PLY file written by WriteEBSurfacePLY.
+Mesh readPLY (const std::string& filename)
+{
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    if (!ifs.good()) amrex::FileOpenFailed(filename);
+    Mesh m;
+    Long nf = 0;
+    std::string line;
+    while (std::getline(ifs, line) && line != "end_header") {
+        std::istringstream ls(line);
+        std::string word, element;
+        ls >> word >> element;
+        if (word == "element" && element == "vertex") ls >> m.nv;
+        if (word == "element" && element == "face") ls >> nf;
+    }
+    ifs.seekg(m.nv*3*sizeof(float), std::ios::cur);
+    m.tri.resize(nf);
+    for (auto& t : m.tri) {
+        unsigned char n;
+        std::int32_t v[3];
+        ifs.read(reinterpret_cast<char*>(&n), 1);
+        ifs.read(reinterpret_cast<char*>(v), sizeof(v));
+        if (n != 3) amrex::Abort("EBSurfacePLY: a face is not a triangle");
+        for (int i = 0; i < 3; ++i) t[i] = v[i];
+    }
+    if (!ifs.good()) amrex::Abort("EBSurfacePLY: failed to read " + filename);
+    return m;
+}
+
+// Whether the vertex indices are in range, and every directed edge is in
+// one triangle with its reverse in another.
+bool isClosed (const Mesh& m)
+{
+    std::map<std::pair<int,int>,int> edges;
+    for (auto const& t : m.tri) {
+        for (int i = 0; i < 3; ++i) {
+            if (t[i] < 0 || t[i] >= m.nv) return false;
+            ++edges[std::make_pair(t[i], t[(i+1)%3])];
+        }
+    }
+    for (auto const& e : edges) {
+        auto r = edges.find(std::make_pair(e.first.second, e.first.first));
+        if (e.second != 1 || r == edges.end() || r->second != 1) return false;
+    }
+    return true;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        Real radius = 0.3;
+        Vector<Real> center {AMREX_D_DECL(0.5,0.5,0.5)};
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("sphere_radius", radius);
+            pp.queryarr("sphere_center", center);
+        }
+
+        Geometry geom;
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+            Box domain(IntVect(0), IntVect(n_cell-1));
+            geom.define(domain, rb, CoordSys::cartesian, is_periodic);
+        }
+
+        EB2::SphereIF sphere(radius, {AMREX_D_DECL(center[0],center[1],center[2])}, false);
+        EB2::Build(EB2::makeShop(sphere), geom, 0, 0);
+
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+        DistributionMapping dm_io(Vector<int>(ba.size(), ParallelDescriptor::IOProcessorNumber()));
+
+        auto factory = makeEBFabFactory(geom, ba, dm, {2,2,2}, EBSupport::full);
+        auto factory_io = makeEBFabFactory(geom, ba, dm_io, {2,2,2}, EBSupport::full);
+
+        Long ncut = 0;
+        const auto& flags = factory->getMultiEBCellFlagFab();
+        for (MFIter mfi(flags); mfi.isValid(); ++mfi) {
+            Array4<EBCellFlag const> const& flag = flags.const_array(mfi);
+            amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+            {
+                if (flag(i,j,k).isSingleValued()) ++ncut;
+            });
+        }
+        ParallelDescriptor::ReduceLongSum(ncut);
+
+        WriteEBSurfacePLY("sphere.ply", *factory, geom);
+        WriteEBSurfacePLY("sphere_welded.ply", *factory_io, geom,
+                          EBSurfacePLYInfo().setWeld(true));
+        Long target = 0;
+        {
+            Mesh m = readPLY("sphere.ply");
+            target = m.tri.size()/4;
+            ParallelDescriptor::Bcast(&target, 1);
+        }
+        WriteEBSurfacePLY("sphere_decimated.ply", *factory_io, geom,
+                          EBSurfacePLYInfo().setTargetTriangles(target));
+
+        int nfail = 0;
+        if (ParallelDescriptor::IOProcessor())
+        {
+            Mesh m = readPLY("sphere.ply");
+            const Long nf = m.tri.size();
+            bool ok = m.nv == nf + 2*ncut;
+            amrex::Print() << "unwelded: " << ncut << " cut cells, " << m.nv << " vertices, "
+                           << nf << " triangles" << (ok ? "" : "  FAILED") << "\n";
+            if (!ok) ++nfail;
+
+            m = readPLY("sphere_welded.ply");
+            ok = isClosed(m) && static_cast<Long>(m.tri.size()) == nf
+                && m.nv == static_cast<Long>(m.tri.size())/2 + 2;
+            amrex::Print() << "welded: " << m.nv << " vertices, " << m.tri.size() << " triangles"
+                           << (ok ? "" : "  FAILED") << "\n";
+            if (!ok) ++nfail;
+
+            m = readPLY("sphere_decimated.ply");
+            ok = isClosed(m) && static_cast<Long>(m.tri.size()) <= target
+                && m.nv == static_cast<Long>(m.tri.size())/2 + 2;
+            amrex::Print() << "decimated to " << target << ": " << m.nv << " vertices, "
+                           << m.tri.size() << " triangles" << (ok ? "" : "  FAILED") << "\n";
+            if (!ok) ++nfail;
+        }
+        ParallelDescriptor::Bcast(&nfail, 1);
+
+        if (nfail > 0) {
+            amrex::Abort("EBSurfacePLY: the surface is wrong");
+        }
+        amrex::Print() << "EBSurfacePLY: the surface is a closed sphere\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,164 @@
+//
+// Check FillPatchTwoLevels with a FillPatchCrseDataCache against the
+// uncached FillPatchTwoLevels over the fine substeps of subcycled coarse
+// steps.  The last check fills at the new coarse time while the old coarse
+// data are NaN, which the cached path must not read.  Run on several
+// processes.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_FillPatchUtil.H>
+#include <AMReX_PhysBCFunct.H>
+#include <AMReX_Interpolater.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+#include <limits>
+
+using namespace amrex;
+
+namespace {
+
+void set_data (MultiFab& mf, Real t)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        Array4<Real> const& a = mf.array(mfi);
+        amrex::LoopOnCpu(bx, mf.nComp(), [=] (int i, int j, int k, int n) noexcept
+        {
+            a(i,j,k,n) = std::sin(0.2*i + 0.3*t) * std::cos(0.1*j + n) + 0.01*k*(1.0+t);
+        });
+    }
+}
+
+Real maxdiff (const MultiFab& a, const MultiFab& b)
+{
+    Real r = 0.0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        Array4<Real const> const& aa = a.const_array(mfi);
+        Array4<Real const> const& ba = b.const_array(mfi);
+        amrex::LoopOnCpu(bx, a.nComp(), [&] (int i, int j, int k, int n) noexcept
+        {
+            const Real d = std::abs(aa(i,j,k,n)-ba(i,j,k,n));
+            r = (d == d) ? std::max(r, d) : std::numeric_limits<Real>::max();
+        });
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        int nsteps = 3;
+        int r = 2;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+            pp.query("ratio", r);
+        }
+        const int ncomp = 2;
+        const IntVect ratio(r);
+
+        const Box cdomain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(0,1,0)};
+        Geometry cgeom(cdomain, rb, CoordSys::cartesian, is_per);
+        Geometry fgeom(amrex::refine(cdomain,ratio), rb, CoordSys::cartesian, is_per);
+
+        BoxArray cba(cdomain);
+        cba.maxSize(max_grid_size);
+        DistributionMapping cdm(cba);
+
+        BoxArray fba(amrex::refine(Box(IntVect(n_cell/4), IntVect(3*n_cell/4-1)), ratio));
+        fba.maxSize(max_grid_size);
+        DistributionMapping fdm(fba);
+
+        MultiFab crse_old(cba, cdm, ncomp, 1);
+        MultiFab crse_new(cba, cdm, ncomp, 1);
+        MultiFab uncached_old(cba, cdm, ncomp, 1);
+        MultiFab uncached_new(cba, cdm, ncomp, 1);
+        MultiFab fine_src(fba, fdm, ncomp, 0);
+        MultiFab fine_cached(fba, fdm, ncomp, 2);
+        MultiFab fine_uncached(fba, fdm, ncomp, 2);
+
+        Vector<BCRec> bcs(ncomp);
+        for (int n = 0; n < ncomp; ++n) {
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                bcs[n].setLo(d, is_per[d] ? BCType::int_dir : BCType::foextrap);
+                bcs[n].setHi(d, is_per[d] ? BCType::int_dir : BCType::foextrap);
+            }
+        }
+        PhysBCFunctNoOp bc;
+
+        auto fill = [&] (MultiFab& dst, Vector<MultiFab*> const& cmf, Real time, Real t0, Real t1)
+        {
+            set_data(fine_src, time);
+            FillPatchTwoLevels(dst, time, cmf, {t0, t1},
+                               {&fine_src}, {time}, 0, 0, ncomp, cgeom, fgeom,
+                               bc, 0, bc, 0, ratio, &lincc_interp, bcs, 0);
+        };
+
+        int nfail = 0;
+        Real t0 = 0.0;
+        set_data(crse_new, t0);
+        for (int step = 0; step < nsteps; ++step)
+        {
+            const Real t1 = t0 + 1.0;
+            MultiFab::Copy(crse_old, crse_new, 0, 0, ncomp, 1);
+            set_data(crse_new, t1);
+            MultiFab::Copy(uncached_old, crse_old, 0, 0, ncomp, 1);
+            MultiFab::Copy(uncached_new, crse_new, 0, 0, ncomp, 1);
+
+            FillPatchCrseDataCache cache({&crse_old, &crse_new});
+            for (int s = 0; s <= r; ++s)
+            {
+                const Real time = t0 + s*(t1-t0)/r;
+                fill(fine_cached, {&crse_old, &crse_new}, time, t0, t1);
+                // Copies of the coarse data are not registered with the cache.
+                fill(fine_uncached, {&uncached_old, &uncached_new}, time, t0, t1);
+                const Real d = maxdiff(fine_cached, fine_uncached);
+                const bool ok = d <= 1.e-12;
+                if (!ok) ++nfail;
+                amrex::Print() << "step " << step << " time " << time << " max diff " << d
+                               << (ok ? "" : "  FAILED") << "\n";
+            }
+            t0 = t1;
+        }
+
+        {
+            // At the new coarse time the old coarse data are not read.
+            const Real t1 = t0 + 1.0;
+            set_data(crse_new, t1);
+            crse_old.setVal(std::numeric_limits<Real>::quiet_NaN());
+            MultiFab::Copy(uncached_old, crse_old, 0, 0, ncomp, 1);
+            MultiFab::Copy(uncached_new, crse_new, 0, 0, ncomp, 1);
+            FillPatchCrseDataCache cache({&crse_old, &crse_new});
+            fill(fine_cached, {&crse_old, &crse_new}, t1, t0, t1);
+            fill(fine_uncached, {&uncached_old, &uncached_new}, t1, t0, t1);
+            const Real d = maxdiff(fine_cached, fine_uncached);
+            const bool ok = d <= 1.e-12;
+            if (!ok) ++nfail;
+            amrex::Print() << "NaN old data, time " << t1 << " max diff " << d
+                           << (ok ? "" : "  FAILED") << "\n";
+        }
+
+        if (nfail > 0) {
+            amrex::Abort("FillPatchCrseCache: " + std::to_string(nfail) + " fills differ");
+        }
+        amrex::Print() << "FillPatchCrseCache: the cached fills agree\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,149 @@
+//
+// Check the fused cell conservative linear interpolation with linear
+// limiting, InterpFused, and CellConservativeLinear::interpBatch with
+// linear and MC limiting against CellConservativeLinear::interp.  The fine
+// regions are inside the domain, at its faces with ext_dir and hoextrap
+// boundaries, and not aligned with the coarse cells, with isotropic and
+// anisotropic ratios.  The TinyProfiler output compares their times.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_FArrayBox.H>
+#include <AMReX_FillPatchUtil.H>
+#include <AMReX_Interpolater.H>
+#include <AMReX_Random.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+Real maxdiff (const FArrayBox& a, const FArrayBox& b, const Box& bx, int ncomp)
+{
+    Array4<Real const> const& aa = a.const_array();
+    Array4<Real const> const& ba = b.const_array();
+    Real r = 0.0;
+    amrex::LoopOnCpu(bx, ncomp, [&] (int i, int j, int k, int n) noexcept
+    {
+        r = std::max(r, std::abs(aa(i,j,k,n)-ba(i,j,k,n)));
+    });
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int ncomp = 3;
+        Real tol = 1.e-12;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("ncomp", ncomp);
+            pp.query("tol", tol);
+        }
+
+        const Box cdomain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(0,0,0)};
+        Geometry cgeom(cdomain, rb, CoordSys::cartesian, is_per);
+
+        FArrayBox crse(amrex::grow(cdomain,1), ncomp);
+        Array4<Real> const& ca = crse.array();
+        amrex::LoopOnCpu(crse.box(), ncomp, [&] (int i, int j, int k, int n) noexcept
+        {
+            ca(i,j,k,n) = std::sin(0.3*i+n) * std::cos(0.2*j) + 0.1*k*k + amrex::Random();
+        });
+
+        Vector<BCRec> bcr(ncomp);
+        for (int n = 0; n < ncomp; ++n) {
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                bcr[n].setLo(d, (n+d)%2 == 0 ? BCType::ext_dir : BCType::foextrap);
+                bcr[n].setHi(d, (n+d)%2 == 0 ? BCType::hoextrap : BCType::ext_dir);
+            }
+        }
+
+        const Vector<IntVect> ratios{IntVect(2), IntVect(4),
+                                     IntVect(AMREX_D_DECL(2,4,2))};
+        int nfail = 0;
+        for (IntVect const& ratio : ratios)
+        {
+            Geometry fgeom(amrex::refine(cdomain,ratio), rb, CoordSys::cartesian, is_per);
+            const Box fdomain = fgeom.Domain();
+            const IntVect fhi = fdomain.bigEnd();
+
+            const Vector<Box> regions{
+                fdomain,
+                Box(IntVect(AMREX_D_DECL(8,12,16)), IntVect(AMREX_D_DECL(23,27,39))),
+                Box(IntVect(AMREX_D_DECL(3,5,1)), IntVect(AMREX_D_DECL(14,20,9))),
+                Box(IntVect(0), IntVect(AMREX_D_DECL(6,9,5))),
+                Box(fhi - IntVect(AMREX_D_DECL(9,4,7)), fhi),
+                Box(IntVect(AMREX_D_DECL(0,fhi[1]-2,7)), IntVect(AMREX_D_DECL(fhi[0],fhi[1],7)))};
+
+            const int nbox = regions.size();
+            Vector<FArrayBox> cfab(nbox);
+            for (int ib = 0; ib < nbox; ++ib)
+            {
+                const Box cbx = lincc_interp.CoarseBox(regions[ib], ratio);
+                cfab[ib].resize(cbx, ncomp);
+                cfab[ib].copy<RunOn::Host>(crse, cbx);
+            }
+
+            // Linear and MC limiting
+            for (CellConservativeLinear* mapper : {&lincc_interp, &cell_cons_interp})
+            {
+                const std::string lim = mapper->doLinearLimiting() ? "linlim" : "mclim";
+                Vector<FArrayBox> f_unfused(nbox), f_fused(nbox), f_batch(nbox);
+                Vector<FArrayBox const*> crse_ptrs(nbox);
+                Vector<FArrayBox*> fine_ptrs(nbox);
+                for (int ib = 0; ib < nbox; ++ib)
+                {
+                    f_unfused[ib].resize(regions[ib], ncomp);
+                    f_fused[ib].resize(regions[ib], ncomp);
+                    f_batch[ib].resize(regions[ib], ncomp);
+                    f_unfused[ib].setVal<RunOn::Host>(0.0);
+                    f_fused[ib].setVal<RunOn::Host>(0.0);
+                    f_batch[ib].setVal<RunOn::Host>(0.0);
+                    crse_ptrs[ib] = &cfab[ib];
+                    fine_ptrs[ib] = &f_batch[ib];
+                    mapper->interp(cfab[ib], 0, f_unfused[ib], 0, ncomp, regions[ib], ratio,
+                                   cgeom, fgeom, bcr, 0, 0, RunOn::Cpu);
+                }
+
+                mapper->interpBatch(crse_ptrs, 0, fine_ptrs, 0, ncomp, regions, ratio,
+                                    cgeom, fgeom, Vector<Vector<BCRec> >(nbox, bcr), RunOn::Cpu);
+
+                for (int ib = 0; ib < nbox; ++ib)
+                {
+                    const Real db = maxdiff(f_unfused[ib], f_batch[ib], regions[ib], ncomp);
+                    bool ok = db <= tol;
+                    amrex::Print() << lim << " ratio " << ratio << " region " << regions[ib]
+                                   << " batch max diff " << db;
+                    if (mapper->doLinearLimiting())
+                    {
+                        const bool fused = InterpFused(cfab[ib], 0, f_fused[ib], 0, ncomp,
+                                                       regions[ib], ratio, mapper, cgeom, bcr,
+                                                       RunOn::Cpu);
+                        const Real df = maxdiff(f_unfused[ib], f_fused[ib], regions[ib], ncomp);
+                        ok = ok && fused && df <= tol;
+                        amrex::Print() << ", fused max diff " << df;
+                    }
+                    if (!ok) ++nfail;
+                    amrex::Print() << (ok ? "" : "  FAILED") << "\n";
+                }
+            }
+        }
+
+        if (nfail > 0) {
+            amrex::Abort("FillPatchInterp: " + std::to_string(nfail) + " interpolations differ");
+        }
+        amrex::Print() << "FillPatchInterp: the fused and batch interpolations agree\n";
+    }
+    amrex::Finalize();
+}
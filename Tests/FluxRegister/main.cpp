@@ -0,0 +1,155 @@
+//
+// Check the batched FluxRegister, with the fluxes of all directions in one
+// CrseInit and FineAdd and the all-faces Reflux, against the per-direction
+// CrseInit and FineAdd and the per-face Reflux.  The results must be the
+// same bit for bit, with and without areas, before and after the fine
+// level is redefined.  Run on several processes.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_FluxRegister.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+void set_data (MultiFab& mf, Real a, Real b)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        Array4<Real> const& d = mf.array(mfi);
+        amrex::LoopOnCpu(bx, mf.nComp(), [=] (int i, int j, int k, int n) noexcept
+        {
+            d(i,j,k,n) = b + std::sin(a*i + 0.7*j*j + 1.3*k + n) * std::cos(0.1*i*k + a*j);
+        });
+    }
+}
+
+Real maxdiff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), 0);
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), 0);
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), 0);
+    Real r = 0.0;
+    for (int n = 0; n < a.nComp(); ++n) r = std::max(r, d.norm0(n));
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+        const int ncomp = 2;
+        const IntVect ratio(2);
+
+        const Box cdomain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,0,0)};
+        Geometry cgeom(cdomain, rb, CoordSys::cartesian, is_per);
+
+        BoxArray cba(cdomain);
+        cba.maxSize(max_grid_size);
+        DistributionMapping cdm(cba);
+
+        MultiFab volume(cba, cdm, 1, 0);
+        set_data(volume, 0.3, 2.0);
+
+        // Two fine levels, the first touches the periodic boundary.
+        const Vector<BoxList> fine_boxes{
+            BoxList(Box(IntVect(AMREX_D_DECL(0,4,8)), IntVect(AMREX_D_DECL(n_cell/2-1,n_cell/2+3,n_cell-9)))),
+            BoxList(Box(IntVect(AMREX_D_DECL(5,3,2)), IntVect(AMREX_D_DECL(n_cell-6,n_cell/2,n_cell/2+1))))};
+
+        int nfail = 0;
+        FluxRegister fr_batch, fr_face;
+        for (int ilev = 0; ilev < static_cast<int>(fine_boxes.size()); ++ilev)
+        {
+            BoxArray fba(fine_boxes[ilev]);
+            fba.refine(ratio);
+            fba.maxSize(max_grid_size);
+            DistributionMapping fdm(fba);
+
+            fr_batch.define(fba, fdm, ratio, 1, ncomp);
+            fr_face.define(fba, fdm, ratio, 1, ncomp);
+
+            Array<MultiFab,AMREX_SPACEDIM> cflux, fflux, carea, farea;
+            for (int d = 0; d < AMREX_SPACEDIM; ++d)
+            {
+                const IntVect typ = IntVect::TheDimensionVector(d);
+                cflux[d].define(amrex::convert(cba,typ), cdm, ncomp, 0);
+                fflux[d].define(amrex::convert(fba,typ), fdm, ncomp, 0);
+                carea[d].define(amrex::convert(cba,typ), cdm, 1, 0);
+                farea[d].define(amrex::convert(fba,typ), fdm, 1, 0);
+                set_data(cflux[d], 0.2+d, 0.0);
+                set_data(fflux[d], 0.5+d, 0.0);
+                set_data(carea[d], 0.1*d, 1.5);
+                set_data(farea[d], 0.4*d, 1.5);
+            }
+            Array<MultiFab const*,AMREX_SPACEDIM> cf{AMREX_D_DECL(&cflux[0],&cflux[1],&cflux[2])};
+            Array<MultiFab const*,AMREX_SPACEDIM> ff{AMREX_D_DECL(&fflux[0],&fflux[1],&fflux[2])};
+            Array<MultiFab const*,AMREX_SPACEDIM> ca{AMREX_D_DECL(&carea[0],&carea[1],&carea[2])};
+            Array<MultiFab const*,AMREX_SPACEDIM> fa{AMREX_D_DECL(&farea[0],&farea[1],&farea[2])};
+
+            for (int with_area = 0; with_area < 2; ++with_area)
+            {
+                fr_batch.setVal(0.0);
+                fr_face.setVal(0.0);
+                if (with_area) {
+                    fr_batch.CrseInit(cf, ca, 0, 0, ncomp, -1.0, FluxRegister::ADD);
+                    fr_batch.FineAdd(ff, fa, 0, 0, ncomp, 0.25);
+                    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                        fr_face.CrseInit(cflux[d], carea[d], d, 0, 0, ncomp, -1.0, FluxRegister::ADD);
+                        fr_face.FineAdd(fflux[d], farea[d], d, 0, 0, ncomp, 0.25);
+                    }
+                } else {
+                    fr_batch.CrseInit(cf, 0, 0, ncomp);
+                    fr_batch.FineAdd(ff, 0, 0, ncomp, 0.25);
+                    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                        fr_face.CrseInit(cflux[d], d, 0, 0, ncomp);
+                        fr_face.FineAdd(fflux[d], d, 0, 0, ncomp, 0.25);
+                    }
+                }
+
+                MultiFab s_batch(cba, cdm, ncomp, 0);
+                MultiFab s_face(cba, cdm, ncomp, 0);
+                set_data(s_batch, 0.9, 1.0);
+                set_data(s_face, 0.9, 1.0);
+
+                fr_batch.Reflux(s_batch, volume, 1.0, 0, 0, ncomp, cgeom);
+                for (OrientationIter fi; fi; ++fi) {
+                    fr_face.Reflux(s_face, volume, fi(), 1.0, 0, 0, ncomp, cgeom);
+                }
+
+                MultiFab s0(cba, cdm, ncomp, 0);
+                set_data(s0, 0.9, 1.0);
+                const Real corr = maxdiff(s_batch, s0);
+
+                const Real d = maxdiff(s_batch, s_face);
+                const bool ok = d == 0.0 && corr > 0.0;
+                if (!ok) ++nfail;
+                amrex::Print() << "fine level " << ilev << (with_area ? " with" : " without")
+                               << " area: max correction " << corr << ", max diff " << d << (ok ? "" : "  FAILED") << "\n";
+            }
+        }
+
+        if (nfail > 0) {
+            amrex::Abort("FluxRegister: " + std::to_string(nfail) + " refluxes differ");
+        }
+        amrex::Print() << "FluxRegister: the batched reflux agrees\n";
+    }
+    amrex::Finalize();
+}
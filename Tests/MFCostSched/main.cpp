@@ -0,0 +1,99 @@
+//
+// Run a loop whose work is concentrated in a few boxes with the static,
+// dynamic and cost-aware schedules, the last both with measured costs and
+// with box costs given by the application.  The results of all of them
+// must be the same.  Run with several OpenMP threads; with
+// mfcostsched.verbose = 1 the idle time of the cost-aware loops is printed.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MFCostSched.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+// The boxes that touch the low y side of the domain do 20 times the work.
+int work (const Box& vbx) { return (vbx.smallEnd(1) == 0) ? 200 : 10; }
+
+void kernel (MultiFab& dst, const MFItInfo& info)
+{
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(dst, info); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const int n = work(mfi.validbox());
+        Array4<Real> const& d = dst.array(mfi);
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            Real x = 0.0;
+            for (int m = 0; m < n; ++m) x += std::sqrt(Real(m+i+j+k));
+            d(i,j,k) = x;
+        });
+    }
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int n_cell = 64;
+        int max_grid_size = 32;
+        int nsteps = 10;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+        }
+
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        MultiFab ref(ba, dm, 1, 0);
+        MultiFab dst(ba, dm, 1, 0);
+
+        Vector<Real> box_costs;
+        for (MFIter mfi(ref); mfi.isValid(); ++mfi) {
+            box_costs.push_back(work(mfi.validbox()) * mfi.validbox().numPts());
+        }
+
+        Real maxdiff = 0.0;
+        const Vector<std::pair<std::string,MFItInfo> > schedules {
+            {"static",   MFItInfo().EnableTiling()},
+            {"dynamic",  MFItInfo().EnableTiling().SetDynamic(true)},
+            {"measured", MFItInfo().EnableTiling().SetCostAware("measured")},
+            {"given",    MFItInfo().EnableTiling().SetCostAware("given").SetBoxCosts(&box_costs)}
+        };
+
+        kernel(ref, schedules[0].second);
+        for (auto const& s : schedules)
+        {
+            double t0 = amrex::second();
+            for (int step = 0; step < nsteps; ++step) {
+                kernel(dst, s.second);
+                MultiFab::Subtract(dst, ref, 0, 0, 1, 0);
+                maxdiff = std::max(maxdiff, dst.norm0());
+            }
+            double t = amrex::second() - t0;
+            ParallelDescriptor::ReduceRealMax(t);
+            amrex::Print() << "Schedule " << s.first << ": " << t << " s\n";
+        }
+
+        amrex::Print() << "Max difference from the static schedule: " << maxdiff << "\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,112 @@
+//
+// Tune two MFIter loops with MFTuner: a stencil and a loop whose work grows
+// with the y index of the cells, so that the tiles have different costs.
+// Every step checks the results against an untuned loop.  Run with several
+// OpenMP threads; the second run reads the table written to mftuner.file.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MFTuner.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+void stencil (MultiFab& dst, const MultiFab& src, const MFItInfo& info)
+{
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(dst, info); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<Real> const& d = dst.array(mfi);
+        Array4<Real const> const& s = src.const_array(mfi);
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            d(i,j,k) = s(i-1,j,k) + s(i+1,j,k) + s(i,j-1,k) + s(i,j+1,k)
+                +      s(i,j,k-1) + s(i,j,k+1) - 6.0*s(i,j,k);
+        });
+    }
+}
+
+void uneven (MultiFab& dst, const MFItInfo& info)
+{
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(dst, info); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<Real> const& d = dst.array(mfi);
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            Real x = 0.0;
+            for (int n = 0; n < j; ++n) x += std::sqrt(Real(n+i+k));
+            d(i,j,k) = x;
+        });
+    }
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int n_cell = 128;
+        int max_grid_size = 64;
+        int nsteps = 60;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+        }
+
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        MultiFab src(ba, dm, 1, 1);
+        MultiFab dst(ba, dm, 1, 0);
+        MultiFab ref(ba, dm, 1, 0);
+        for (MFIter mfi(src); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.fabbox();
+            Array4<Real> const& a = src.array(mfi);
+            amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+            {
+                a(i,j,k) = std::sin(0.1*i) * std::cos(0.2*j) + 0.01*k;
+            });
+        }
+
+        const MFItInfo plain = MFItInfo().EnableTiling();
+        stencil(ref, src, plain);
+        MultiFab uref(ba, dm, 1, 0);
+        uneven(uref, plain);
+
+        Real maxdiff = 0.0;
+        for (int step = 0; step < nsteps; ++step)
+        {
+            stencil(dst, src, MFItInfo().EnableTiling().SetTuning("stencil"));
+            MultiFab::Subtract(dst, ref, 0, 0, 1, 0);
+            maxdiff = std::max(maxdiff, dst.norm0());
+
+            uneven(dst, MFItInfo().EnableTiling().SetTuning("uneven"));
+            MultiFab::Subtract(dst, uref, 0, 0, 1, 0);
+            maxdiff = std::max(maxdiff, dst.norm0());
+        }
+
+        amrex::Print() << "MFTuner enabled: " << MFTuner::Enabled()
+                       << ", max difference from the untuned loops: " << maxdiff << "\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,73 @@
+//
+// Allocate MultiFabs under nested FabArrayBase::RegionTags and report the
+// memory by site.  Every step allocates a temporary under Advance/Solve,
+// which sets the high-water mark, and the last process allocates twice as
+// much as the others, so it is the process with the highest mark.  With
+// telemetry, mem_bytes and mem_hwm of every step are in telemetry.csv.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MemSites.H>
+#include <AMReX_Telemetry.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int n_cell = 128;
+        int max_grid_size = 32;
+        int nsteps = 10;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+        }
+
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        std::unique_ptr<MultiFab> state;
+        {
+            FabArrayBase::RegionTag tag("Init");
+            state.reset(new MultiFab(ba, dm, 2, 2));
+            state->setVal(1.0);
+        }
+
+        const int ncomp = (ParallelDescriptor::MyProc() == ParallelDescriptor::NProcs()-1) ? 8 : 4;
+
+        for (int step = 0; step < nsteps; ++step)
+        {
+            Telemetry::StartStep(step, 0.1*step);
+            {
+                FabArrayBase::RegionTag tag("Advance");
+                MultiFab rhs(ba, dm, 1, 0);
+                rhs.setVal(0.0);
+                {
+                    FabArrayBase::RegionTag tag2("Solve");
+                    MultiFab tmp(ba, dm, 1, 1);
+                    BaseFab<Real> extra(Box(IntVect(0), IntVect(31)), ncomp);
+                    extra.setVal(0.0);
+                    tmp.setVal(2.0);
+                    MultiFab::Add(rhs, tmp, 0, 0, 1, 0);
+                }
+                MultiFab::Add(*state, rhs, 0, 0, 1, 0);
+            }
+            Telemetry::StopStep();
+        }
+
+        amrex::Print() << "MemSites enabled: " << MemSites::Enabled()
+                       << ", bytes now " << MemSites::CurrentBytes()
+                       << ", high-water mark " << MemSites::HWM() << "\n";
+    }
+    amrex::Finalize();
+}
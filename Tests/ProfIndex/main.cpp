@@ -0,0 +1,378 @@
+//
+// Check the indexed queries of the profile parser against its unindexed
+// path.
+//
+// With mode = run, a few steps of FillBoundary calls and reductions in
+// nested regions are profiled, which writes a bl_prof database with the
+// base profile, the call traces, the regions and the comm stats at
+// Finalize.
+//
+// With mode = check, the batch parser builds the index of prof_dir and runs
+// the queries -isr, -ifs and -irtl.  Their results are compared with the
+// unindexed parser on the same database:  -isr with the send/recv list,
+// -ifs with the function stats of the call traces, and -irtl with the
+// region time ranges.  Run it on at most the number of processes of the
+// run.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_Print.H>
+#include <AMReX_DataServices.H>
+
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace amrex;
+
+extern bool ProfParserBatchFunctions(int argc, char *argv[], bool runDefault,
+                                     bool &bParserProf);
+
+namespace {
+
+// [from, to] -> nsends sendbytes nrecvs recvbytes
+typedef std::map<std::pair<int,int>, std::array<Long,4> > SRMap;
+
+// [name] -> ncalls, max over the ranks of the exclusive time
+typedef std::map<std::string, std::pair<Long,Real> > FSMap;
+
+void run ()
+{
+    BL_PROFILE("run()");
+
+    int n_cell = 64;
+    int max_grid_size = 16;
+    int nsteps = 10;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nsteps", nsteps);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+    MultiFab mf(ba, dm, 1, 1);
+    mf.setVal(1.0);
+
+    const Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                        CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+
+    Real sum = 0.0;
+    for (int step = 0; step < nsteps; ++step)
+    {
+        BL_PROFILE_REGION_START("Step");
+        {
+            BL_PROFILE_REGION_START("Exchange");
+            BL_PROFILE("Exchange");
+            mf.FillBoundary(geom.periodicity());
+            BL_PROFILE_REGION_STOP("Exchange");
+        }
+        {
+            BL_PROFILE("Reduce");
+            sum += mf.sum(0);
+        }
+        BL_PROFILE_REGION_STOP("Step");
+    }
+
+    amrex::Print() << "sum = " << sum << "\n";
+}
+
+// Run the batch parser on args, with the output of the I/O process in os.
+void batch (const Vector<std::string>& args, std::ostream* os = nullptr)
+{
+    Vector<char*> argv;
+    for (auto const& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+
+    std::streambuf* cout_buf = std::cout.rdbuf();
+    if (os && ParallelDescriptor::IOProcessor()) std::cout.rdbuf(os->rdbuf());
+    bool bParserProf = false;
+    ProfParserBatchFunctions(args.size(), argv.data(), false, bParserProf);
+    std::cout.rdbuf(cout_buf);
+}
+
+bool isSend (const std::string& cft)
+{
+    for (auto t : {BLProfiler::AsendTsii, BLProfiler::AsendTsiiM, BLProfiler::AsendvTii,
+                   BLProfiler::SendTsii, BLProfiler::SendvTii}) {
+        if (cft == BLProfiler::CommStats::CFTToString(t)) return true;
+    }
+    return false;
+}
+
+// The matrix of -isr.
+SRMap readSendRecvMatrix (const std::string& file)
+{
+    SRMap r;
+    std::ifstream ifs(file);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream is(line);
+        int from, to;
+        std::array<Long,4> v;
+        is >> from >> to >> v[0] >> v[1] >> v[2] >> v[3];
+        r[std::make_pair(from,to)] = v;
+    }
+    return r;
+}
+
+// The matrix of the send/recv list of the unindexed parser, which has one
+// line per send and posted receive:  time, type, from, to, size, tag and
+// regions, separated by tabs.
+SRMap readSendRecvList (const std::string& file)
+{
+    SRMap r;
+    std::ifstream ifs(file);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream is(line);
+        std::string time, type;
+        int from, to;
+        Long size;
+        std::getline(is, time, '\t');
+        std::getline(is, type, '\t');
+        is >> from >> to >> size;
+        std::array<Long,4>& v = r[std::make_pair(from,to)];
+        if (isSend(type)) {
+            v[0] += 1;
+            v[1] += size;
+        } else {
+            v[2] += 1;
+            v[3] += size;
+        }
+    }
+    return r;
+}
+
+// The table of -ifs:  a name of 40 columns then NCalls, the min, avg and
+// max of the exclusive and inclusive times, and the max percentage.
+FSMap readFunctionStats (const std::string& out)
+{
+    FSMap r;
+    std::istringstream is(out);
+    std::string line;
+    bool intable = false;
+    while (std::getline(is, line)) {
+        if (line.compare(0, 4, "Name") == 0) {
+            intable = true;
+            continue;
+        }
+        if (!intable || line.empty() || line[0] == '-' || line.size() <= 40) continue;
+        std::string name = line.substr(0, 40);
+        name.erase(name.find_last_not_of(' ') + 1);
+        std::istringstream ls(line.substr(40));
+        Long ncalls;
+        Real emin, eavg, emax;
+        ls >> ncalls >> emin >> eavg >> emax;
+        r[name] = std::make_pair(ncalls, emax);
+    }
+    return r;
+}
+
+int compareSendRecv (const std::string& file)
+{
+    int nwrong = 0;
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const SRMap indexed = readSendRecvMatrix(file);
+        const SRMap unindexed = readSendRecvList("SendRecvList.txt");
+        for (auto const& kv : unindexed) {
+            auto it = indexed.find(kv.first);
+            if (it == indexed.end() || it->second != kv.second) {
+                ++nwrong;
+                amrex::Print() << "  " << kv.first.first << " -> " << kv.first.second
+                               << ":  " << kv.second[0] << " sends, " << kv.second[2]
+                               << " receives in the list, "
+                               << ((it == indexed.end()) ? "missing in the matrix"
+                                                         : "different in the matrix") << "\n";
+            }
+        }
+        for (auto const& kv : indexed) {
+            if (unindexed.find(kv.first) == unindexed.end()) ++nwrong;
+        }
+        amrex::Print() << "-isr:  " << indexed.size() << " rank pairs, " << nwrong << " wrong"
+                       << (nwrong == 0 && !unindexed.empty() ? "" : "  FAILED") << "\n";
+        if (unindexed.empty()) ++nwrong;
+    }
+    ParallelDescriptor::ReduceIntMax(nwrong);
+    return nwrong;
+}
+
+int compareFunctionStats (DataServices& ds, const std::string& out)
+{
+    int nwrong = 0;
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const FSMap indexed = readFunctionStats(out);
+
+        RegionsProfStats& rps = ds.GetRegionsProfStats();
+        Vector<Vector<BLProfStats::FuncStat> > funcStats;  // [fnum][proc]
+        rps.CollectFuncStats(funcStats);
+        const Vector<std::string>& fnames = rps.NumbersToFName();
+
+        int nfuncs = 0;
+        for (int f = 0; f < funcStats.size(); ++f)
+        {
+            Long ncalls = 0;
+            Real emax = 0.0;
+            for (auto const& fs : funcStats[f]) {
+                ncalls += fs.nCalls;
+                emax = std::max(emax, fs.totalTime);
+            }
+            if (ncalls == 0) continue;
+            ++nfuncs;
+            std::string name = fnames[f];
+            if (name.size() >= 40) name = name.substr(0, 39);
+            auto it = indexed.find(name);
+            const bool ok = it != indexed.end() && it->second.first == ncalls
+                && std::abs(it->second.second - emax) <= 1.e-3*emax + 1.e-12;
+            if (!ok) {
+                ++nwrong;
+                amrex::Print() << "  " << name << ":  " << ncalls << " calls, " << emax
+                               << " s in the call traces, ";
+                if (it == indexed.end()) {
+                    amrex::Print() << "missing in the table\n";
+                } else {
+                    amrex::Print() << it->second.first << " calls, " << it->second.second
+                                   << " s in the table\n";
+                }
+            }
+        }
+        nwrong += indexed.size() - std::min<int>(indexed.size(), nfuncs);
+        amrex::Print() << "-ifs:  " << indexed.size() << " functions, " << nwrong << " wrong"
+                       << (nwrong == 0 && nfuncs > 0 ? "" : "  FAILED") << "\n";
+        if (nfuncs == 0) ++nwrong;
+    }
+    ParallelDescriptor::ReduceIntMax(nwrong);
+    return nwrong;
+}
+
+int compareRegionTimeline (DataServices& ds, const std::string& file, int nslots)
+{
+    int nwrong = 0;
+    if (ParallelDescriptor::IOProcessor())
+    {
+        Real tstart = 0.0, tstop = 0.0;
+        {
+            std::ifstream hf(file + ".H");
+            std::string line, key;
+            while (std::getline(hf, line)) {
+                std::istringstream is(line);
+                is >> key;
+                if (key == "TimeRange") is >> tstart >> tstop;
+            }
+        }
+        const int nprocs = BLProfStats::GetNProcs();
+        Vector<int> timeline(nprocs*nslots, -2);
+        {
+            std::ifstream bf(file + ".bin", std::ios::binary);
+            bf.read((char*) timeline.dataPtr(), timeline.size()*sizeof(int));
+        }
+
+        // The innermost region at a time is the open region that started last.
+        RegionsProfStats& rps = ds.GetRegionsProfStats();
+        const auto& ranges = rps.GetRegionTimeRanges();  // [proc][rnum][range]
+        // The region names of the unindexed parser keep their quotes.
+        int noregion = -1;
+        auto it = rps.RegionNames().find("\"__NoRegion__\"");
+        if (it != rps.RegionNames().end()) noregion = it->second;
+
+        const Real dt = (tstop - tstart) / nslots;
+        int nregion = 0;
+        for (int p = 0; p < nprocs; ++p) {
+            for (int s = 0; s < nslots; ++s)
+            {
+                const Real t = tstart + (s + 0.5)*dt;
+                int inner = -1;
+                Real tinner = -1.0;
+                for (int r = 0; r < ranges[p].size(); ++r) {
+                    if (r == noregion) continue;
+                    for (auto const& tr : ranges[p][r]) {
+                        if (tr.startTime <= t && (tr.stopTime < 0.0 || t < tr.stopTime)
+                            && tr.startTime > tinner) {
+                            inner = r;
+                            tinner = tr.startTime;
+                        }
+                    }
+                }
+                if (inner >= 0) ++nregion;
+                if (timeline[p*nslots+s] != inner) ++nwrong;
+            }
+        }
+        amrex::Print() << "-irtl:  " << nprocs << " ranks x " << nslots << " slots, "
+                       << nregion << " in a region, " << nwrong << " wrong"
+                       << (nwrong == 0 && nregion > 0 ? "" : "  FAILED") << "\n";
+        if (nregion == 0) ++nwrong;
+    }
+    ParallelDescriptor::ReduceIntMax(nwrong);
+    return nwrong;
+}
+
+void check (const std::string& prog)
+{
+    std::string dir = "bl_prof";
+    int nbuckets = 16;
+    int nslots = 200;
+    {
+        ParmParse pp;
+        pp.query("prof_dir", dir);
+        pp.query("nbuckets", nbuckets);
+        pp.query("nslots", nslots);
+    }
+
+    // The indexed queries
+    std::ostringstream fs;
+    batch({prog, "-index", "-nbk", std::to_string(nbuckets),
+           "-isr", "-of", "SendRecvMatrix.txt", dir});
+    batch({prog, "-ifs", dir}, &fs);
+    batch({prog, "-irtl", std::to_string(nslots), "-of", "RegionTimeline", dir});
+
+    // The unindexed parser
+    DataServices::SetBatchMode();
+    DataServices ds(dir, Amrvis::PROFDATA);
+    ds.InitRegionTimeRanges();
+    ds.RunSendRecvList();
+
+    int nfailed = 0;
+    if (compareSendRecv("SendRecvMatrix.txt") > 0) ++nfailed;
+    if (compareFunctionStats(ds, fs.str()) > 0) ++nfailed;
+    if (compareRegionTimeline(ds, "RegionTimeline", nslots) > 0) ++nfailed;
+
+    if (nfailed > 0) {
+        amrex::Abort("ProfIndex: the indexed queries do not match the unindexed parser");
+    }
+    amrex::Print() << "ProfIndex: the indexed queries match the unindexed parser\n";
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        std::string mode = "run";
+        {
+            ParmParse pp;
+            pp.query("mode", mode);
+        }
+        if (mode == "run") {
+            run();
+        } else if (mode == "check") {
+            check(argv[0]);
+            BLProfiler::SetNoOutput();
+        } else {
+            amrex::Abort("ProfIndex: mode must be run or check");
+        }
+    }
+    amrex::Finalize();
+}
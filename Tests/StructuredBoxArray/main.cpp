@@ -0,0 +1,203 @@
+//
+// Check that a structured BoxArray (domain, chunk size and holes) has the
+// same boxes as the maxSize-chopped domain, that its intersections are the
+// same as those of an unstructured copy for cell-centered, nodal and
+// coarsened BoxArrays, and that it survives writeOn/readFrom in the compact
+// form.  maxSize must make a structured BoxArray only if asked to.  The
+// times of the intersections and of the SFC distribution are printed.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+using namespace amrex;
+
+namespace {
+
+using Isects = std::vector<std::pair<int,Box> >;
+
+void sortIsects (Isects& v)
+{
+    std::sort(v.begin(), v.end(), [] (const std::pair<int,Box>& a, const std::pair<int,Box>& b)
+              { return a.first < b.first; });
+}
+
+bool sameIntersections (const BoxArray& ba, const BoxArray& ref, const Vector<Box>& queries,
+                        const IntVect& ng)
+{
+    Isects a, b;
+    for (const Box& q : queries) {
+        ba.intersections(q, a, false, ng);
+        ref.intersections(q, b, false, ng);
+        sortIsects(a);
+        sortIsects(b);
+        if (a != b) return false;
+        if (ba.intersects(q, ng) != ref.intersects(q, ng)) return false;
+    }
+    return true;
+}
+
+Vector<Box> randomBoxes (const Box& domain, int n, int maxlen, std::mt19937& gen, IndexType typ)
+{
+    Vector<Box> r;
+    for (int i = 0; i < n; ++i) {
+        IntVect lo, hi;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            std::uniform_int_distribution<int> pos(domain.smallEnd(idim)-maxlen, domain.bigEnd(idim));
+            std::uniform_int_distribution<int> len(1, maxlen);
+            lo[idim] = pos(gen);
+            hi[idim] = lo[idim] + len(gen) - 1;
+        }
+        r.push_back(amrex::convert(Box(lo,hi), typ));
+    }
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int n_cell = 512;
+        int max_grid_size = 16;
+        int nholes = 100;
+        int nqueries = 20000;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nholes", nholes);
+            pp.query("nqueries", nqueries);
+        }
+
+        // maxSize makes a structured BoxArray only if asked to.
+        bool ok = !BoxArray(Box(IntVect(0), IntVect(n_cell-1))).maxSize(max_grid_size).isStructured();
+        if (!ok) amrex::Print() << "maxSize made a structured BoxArray by default  FAILED\n";
+        BoxArray::SetUseStructuredMaxSize(true);
+
+        std::mt19937 gen(42);
+
+        // Boxes of odd and even sizes, with negative and positive offsets.
+        const Vector<Box> domains {
+            Box(IntVect(0), IntVect(n_cell-1)),
+            Box(IntVect(AMREX_D_DECL(-5,3,-17)), IntVect(AMREX_D_DECL(90,44,60))),
+            Box(IntVect(AMREX_D_DECL(0,0,0)), IntVect(AMREX_D_DECL(63,11,200)))
+        };
+        const Vector<IntVect> chunks {
+            IntVect(max_grid_size),
+            IntVect(AMREX_D_DECL(12,7,32)),
+            IntVect(AMREX_D_DECL(64,5,24))
+        };
+
+        for (const Box& domain : domains) {
+            for (const IntVect& chunk : chunks) {
+                BoxArray ref(domain);
+                ref.maxSize(chunk);
+
+                const int N = ref.size();
+                std::uniform_int_distribution<int> pick(0, N-1);
+                Vector<int> holes;
+                for (int i = 0; i < std::min(nholes, N/2); ++i) {
+                    holes.push_back(pick(gen));
+                }
+                std::sort(holes.begin(), holes.end());
+                holes.erase(std::unique(holes.begin(), holes.end()), holes.end());
+
+                BoxArray ba(domain, chunk, holes);
+                BoxList bl;
+                for (int i = 0, h = 0; i < N; ++i) {
+                    if (h < static_cast<int>(holes.size()) && holes[h] == i) {
+                        ++h;
+                    } else {
+                        bl.push_back(ref[i]);
+                    }
+                }
+                // An unstructured copy.
+                BoxArray plain(bl);
+
+                const bool same_size = ba.size() == plain.size() && ref.isStructured();
+                const Vector<Box> queries = randomBoxes(domain, 500, 2*chunk.max(), gen,
+                                                        IndexType::TheCellType());
+                // Query before the boxes are built.
+                const bool same_isects = sameIntersections(ba, plain, queries, IntVect(1));
+                const bool same_boxes = ba == plain;
+
+                BoxArray nba = amrex::convert(ba, IntVect(1));
+                BoxArray nplain = amrex::convert(plain, IntVect(1));
+                const Vector<Box> nqueries_v = randomBoxes(domain, 500, 2*chunk.max(), gen,
+                                                           IndexType(IntVect(1)));
+                const bool same_nodal = sameIntersections(nba, nplain, nqueries_v, IntVect(0))
+                    &&                  sameIntersections(nba, nplain, nqueries_v, IntVect(2));
+
+                BoxArray cba = amrex::coarsen(ba, 2);
+                BoxArray cplain = amrex::coarsen(plain, 2);
+                const bool same_coarse = sameIntersections(cba, cplain, queries, IntVect(1));
+
+                const bool same_complement = BoxArray(ba.complementIn(domain)).numPts()
+                    ==                       BoxArray(plain.complementIn(domain)).numPts();
+
+                BoxArray::SetUseCompactIO(true);
+                std::stringstream ss;
+                ba.writeOn(ss);
+                BoxArray::SetUseCompactIO(false);
+                BoxArray rba;
+                rba.readFrom(ss);
+                const bool same_io = rba.isStructured() && rba == plain;
+
+                const bool pass = same_size && same_isects && same_boxes && same_nodal
+                    && same_coarse && same_complement && same_io;
+                ok = ok && pass;
+                amrex::Print() << domain << " chunk " << chunk << ": " << plain.size()
+                               << " boxes, " << holes.size() << " holes, compact header "
+                               << ss.str().size() << " bytes"
+                               << (pass ? "" : "  FAILED") << "\n";
+            }
+        }
+
+        // Timings on the first domain.
+        {
+            const Box domain(IntVect(0), IntVect(n_cell-1));
+            BoxArray ba(domain);
+            ba.maxSize(max_grid_size);
+            BoxArray plain(BoxList(ba.boxList()));
+            const Vector<Box> queries = randomBoxes(domain, nqueries, 2*max_grid_size, gen,
+                                                    IndexType::TheCellType());
+            Isects isects;
+
+            double t0 = ParallelDescriptor::second();
+            for (const Box& q : queries) ba.intersections(q, isects, false, IntVect(1));
+            const double t_structured = ParallelDescriptor::second() - t0;
+
+            t0 = ParallelDescriptor::second();
+            plain.intersections(queries[0], isects);
+            const double t_hash_build = ParallelDescriptor::second() - t0;
+            t0 = ParallelDescriptor::second();
+            for (const Box& q : queries) plain.intersections(q, isects, false, IntVect(1));
+            const double t_hash = ParallelDescriptor::second() - t0;
+
+            t0 = ParallelDescriptor::second();
+            DistributionMapping dm(ba, 64);
+            const double t_sfc = ParallelDescriptor::second() - t0;
+
+            amrex::Print() << "\n" << ba.size() << " boxes, " << nqueries << " queries\n"
+                           << "  structured intersections: " << t_structured << " s\n"
+                           << "  hash build: " << t_hash_build << " s, intersections: "
+                           << t_hash << " s\n"
+                           << "  SFC distribution on 64 processes: " << t_sfc << " s\n";
+        }
+
+        amrex::Print() << "\n" << (ok ? "PASSED" : "FAILED") << "\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,82 @@
+//
+// Record the per-step telemetry of a loop of FillBoundary and ParallelCopy
+// calls and some work.  From slow_step on, the last process does four times
+// the work of the others, which shows up in Tools/Telemetry/telemetry.py
+// as a regression of step_compute with that process as the slowest.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Telemetry.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+double work (int n)
+{
+    double s = 0.0;
+    for (int i = 0; i < n; ++i) s += std::sqrt(double(i));
+    return s;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int n_cell = 128;
+        int max_grid_size = 32;
+        int nsteps = 40;
+        int slow_step = 30;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+            pp.query("slow_step", slow_step);
+        }
+
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+        MultiFab mf(ba, dm, 1, 2);
+        mf.setVal(1.0);
+
+        BoxArray cba = ba;
+        cba.maxSize(max_grid_size/2);
+        MultiFab cmf(cba, DistributionMapping(cba), 1, 0);
+
+        const Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                            CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+
+        double sum = 0.0;
+        for (int step = 0; step < nsteps; ++step)
+        {
+            Telemetry::StartStep(step, 0.1*step);
+
+            mf.FillBoundary(geom.periodicity());
+            {
+                Telemetry::Region tel("Work");
+                const bool slow = step >= slow_step
+                    && ParallelDescriptor::MyProc() == ParallelDescriptor::NProcs()-1;
+                sum += work(slow ? 4000000 : 1000000);
+            }
+            cmf.ParallelCopy(mf);
+
+            Telemetry::StopStep();
+        }
+
+        amrex::Print() << "Telemetry enabled: " << Telemetry::Enabled()
+                       << " (checksum " << sum << ")\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,111 @@
+//
+// Measure the cost of a BL_PROFILE timer and show the per-thread tables of
+// TinyProfiler.  Run with tiny_profiler.per_thread = 1 and several OpenMP
+// threads.  The "Imbalanced" timer does twice as much work on odd threads.
+// With tiny_profiler.perf_counters, the "Stream" timer shows the bandwidth
+// and the bytes per cell of a triad.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_TinyProfiler.H>
+#include <AMReX_Print.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <cmath>
+#include <vector>
+
+using namespace amrex;
+
+namespace {
+
+double work (int n)
+{
+    double s = 0.0;
+    for (int i = 0; i < n; ++i) s += std::sqrt(double(i));
+    return s;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        int ncalls = 1000000;
+        {
+            ParmParse pp;
+            pp.query("ncalls", ncalls);
+        }
+
+        double sum = 0.0;
+
+        // The loop without a timer, and with an empty one.
+        double t0 = ParallelDescriptor::second();
+        for (int i = 0; i < ncalls; ++i) {
+            sum += work(8);
+        }
+        const double t_bare = ParallelDescriptor::second() - t0;
+
+        t0 = ParallelDescriptor::second();
+        for (int i = 0; i < ncalls; ++i) {
+            BL_PROFILE("Empty");
+            sum += work(8);
+        }
+        const double t_timed = ParallelDescriptor::second() - t0;
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:sum)
+#endif
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            for (int i = 0; i < 100; ++i) {
+                BL_PROFILE("Imbalanced");
+                sum += work((tid%2 == 0) ? 20000 : 40000);
+                {
+                    BL_PROFILE("Imbalanced::inner");
+                    sum += work(10000);
+                }
+            }
+        }
+
+        // A triad on arrays larger than the last level cache, 24 bytes per cell.
+        {
+            const int n = 1 << 23;
+            std::vector<double> a(n, 1.0), b(n, 2.0), c(n, 0.0);
+            for (int iter = 0; iter < 10; ++iter) {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+                {
+                    BL_PROFILE("Stream");
+                    int nthreads = 1;
+#ifdef _OPENMP
+                    nthreads = omp_get_num_threads();
+#pragma omp for
+#endif
+                    for (int i = 0; i < n; ++i) {
+                        c[i] = a[i] + 3.0*b[i];
+                    }
+                    TinyProfiler::AddCells(n/nthreads);
+                }
+            }
+            sum += c[n/2];
+        }
+
+        amrex::Print() << "Per-thread mode: " << TinyProfiler::PerThread() << "\n"
+                       << "Cost of a timer: "
+                       << (t_timed - t_bare) / ncalls * 1.e9 << " ns per call\n"
+                       << "(checksum " << sum << ")\n";
+    }
+    amrex::Finalize();
+}
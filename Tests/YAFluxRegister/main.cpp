@@ -0,0 +1,156 @@
+//
+// Check the sparse mode of YAFluxRegister against the default mode.  The
+// coarse and fine fluxes of a step are added to both registers, which are
+// then refluxed into copies of the coarse state.  The corrections must be
+// the same bit for bit.  The fine level has several patches, one of them at
+// a periodic boundary and one at a non-periodic boundary.  Run on several
+// processes.
+//
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_YAFluxRegister.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+void set_data (MultiFab& mf, Real a, Real b)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        Array4<Real> const& d = mf.array(mfi);
+        amrex::LoopOnCpu(bx, mf.nComp(), [=] (int i, int j, int k, int n) noexcept
+        {
+            d(i,j,k,n) = b + std::sin(a*i + 0.7*j*j + 1.3*k + n) * std::cos(0.1*i*k + a*j);
+        });
+    }
+}
+
+Real maxdiff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), 0);
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), 0);
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), 0);
+    Real r = 0.0;
+    for (int n = 0; n < a.nComp(); ++n) r = std::max(r, d.norm0(n));
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+        const int ncomp = 2;
+        const IntVect ratio(2);
+        const Real dt = 0.1;
+
+        const Box cdomain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,0,0)};
+        Geometry cgeom(cdomain, rb, CoordSys::cartesian, is_per);
+        Geometry fgeom(amrex::refine(cdomain,ratio), rb, CoordSys::cartesian, is_per);
+
+        BoxArray cba(cdomain);
+        cba.maxSize(max_grid_size);
+        DistributionMapping cdm(cba);
+
+        BoxList fbl;
+        fbl.push_back(Box(IntVect(AMREX_D_DECL(0,4,8)), IntVect(AMREX_D_DECL(n_cell/2-1,n_cell/2+3,n_cell-9))));
+        fbl.push_back(Box(IntVect(AMREX_D_DECL(n_cell/2+4,n_cell-6,2)), IntVect(AMREX_D_DECL(n_cell-3,n_cell-1,n_cell/2))));
+        BoxArray fba(fbl);
+        fba.refine(ratio);
+        fba.maxSize(max_grid_size);
+        DistributionMapping fdm(fba);
+
+        YAFluxRegister fr_dense(fba, cba, fdm, cdm, fgeom, cgeom, ratio, 1, ncomp);
+        YAFluxRegister fr_sparse(fba, cba, fdm, cdm, fgeom, cgeom, ratio, 1, ncomp, true);
+
+        Array<MultiFab,AMREX_SPACEDIM> cflux, fflux;
+        for (int d = 0; d < AMREX_SPACEDIM; ++d)
+        {
+            const IntVect typ = IntVect::TheDimensionVector(d);
+            cflux[d].define(amrex::convert(cba,typ), cdm, ncomp, 0);
+            fflux[d].define(amrex::convert(fba,typ), fdm, ncomp, 0);
+            set_data(cflux[d], 0.2+d, 0.0);
+            set_data(fflux[d], 0.5+d, 0.0);
+        }
+
+        // The registers take the cell-centered boxes of the MFIters.
+        MultiFab cstate(cba, cdm, ncomp, 0, MFInfo().SetAlloc(false));
+        MultiFab fstate(fba, fdm, ncomp, 0, MFInfo().SetAlloc(false));
+
+        int nfail = 0;
+        for (int step = 0; step < 2; ++step)
+        {
+            fr_dense.reset();
+            fr_sparse.reset();
+
+            for (YAFluxRegister* fr : {&fr_dense, &fr_sparse})
+            {
+                for (MFIter mfi(cstate); mfi.isValid(); ++mfi)
+                {
+                    if (fr->CrseHasWork(mfi)) {
+                        std::array<FArrayBox const*,AMREX_SPACEDIM> f{
+                            AMREX_D_DECL(&cflux[0][mfi],&cflux[1][mfi],&cflux[2][mfi])};
+                        fr->CrseAdd(mfi, f, cgeom.CellSize(), dt, RunOn::Cpu);
+                    }
+                }
+                // Two fine substeps
+                for (int s = 0; s < 2; ++s)
+                {
+                    for (MFIter mfi(fstate); mfi.isValid(); ++mfi)
+                    {
+                        if (fr->FineHasWork(mfi)) {
+                            std::array<FArrayBox const*,AMREX_SPACEDIM> f{
+                                AMREX_D_DECL(&fflux[0][mfi],&fflux[1][mfi],&fflux[2][mfi])};
+                            fr->FineAdd(mfi, f, fgeom.CellSize(), 0.5*dt, RunOn::Cpu);
+                        }
+                    }
+                }
+            }
+
+            MultiFab s0(cba, cdm, ncomp, 0);
+            MultiFab s_dense(cba, cdm, ncomp, 0);
+            MultiFab s_sparse(cba, cdm, ncomp, 0);
+            set_data(s0, 0.9+step, 1.0);
+            MultiFab::Copy(s_dense, s0, 0, 0, ncomp, 0);
+            MultiFab::Copy(s_sparse, s0, 0, 0, ncomp, 0);
+
+            fr_dense.Reflux(s_dense);
+            fr_sparse.Reflux(s_sparse);
+
+            const Real corr = maxdiff(s_dense, s0);
+            const Real d = maxdiff(s_dense, s_sparse);
+            const bool ok = d == 0.0 && corr > 0.0;
+            if (!ok) ++nfail;
+            amrex::Print() << "step " << step << ": max correction " << corr
+                           << ", max diff " << d << (ok ? "" : "  FAILED") << "\n";
+
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                set_data(cflux[d], 0.3+d, 0.5);
+                set_data(fflux[d], 0.6+d, -0.5);
+            }
+        }
+
+        if (nfail > 0) {
+            amrex::Abort("YAFluxRegister: " + std::to_string(nfail) + " refluxes differ");
+        }
+        amrex::Print() << "YAFluxRegister: the sparse reflux agrees\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+
+"""Compare two result files of amrex_bench (Tests/Benchmarks).
+
+The results are matched by case name and parameters.  For every match the
+time of the base and of the new file and the change of the throughput are
+printed.  A result whose time grew by more than --threshold (10% by default)
+is flagged as a regression, and one whose time shrank by as much as an
+improvement.  By default the time is t_min, the fastest repeat; with
+--metric t_avg the average of the repeats is used instead.
+
+The exit status is 1 if there is a regression, so the script can be used in
+a test.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+
+def read(filename):
+    """Return (run info, {(name, params): result})."""
+    with open(filename) as f:
+        data = json.load(f)
+    results = {}
+    for r in data["results"]:
+        key = (r["name"], tuple(sorted(r["params"].items())))
+        results[key] = r
+    return data, results
+
+
+def label(key):
+    name, params = key
+    return name + " " + " ".join("{}={}".format(k, v) for k, v in params)
+
+
+def throughput(r):
+    """The main throughput of a result and its unit."""
+    if r.get("bytes", 0.0) > 0.0:
+        return r["GB_per_sec"], "GB/s"
+    if r.get("particles", 0.0) > 0.0:
+        return r["particles_per_sec"], "particles/s"
+    if r.get("cells", 0.0) > 0.0:
+        return r["cells_per_sec"], "cells/s"
+    return 0.0, ""
+
+
+def compare(base_file, new_file, metric, threshold):
+    base_info, base = read(base_file)
+    new_info, new = read(new_file)
+
+    for k in ("dim", "nprocs", "nthreads"):
+        if base_info.get(k) != new_info.get(k):
+            print("warning: {} differs: {} in {}, {} in {}".format(
+                k, base_info.get(k), base_file, new_info.get(k), new_file))
+
+    width = max([len(label(k)) for k in base] + [4])
+    print("{:<{w}s} {:>11s} {:>11s} {:>8s} {:>12s} {:>12s}".format(
+        "case", "base (s)", "new (s)", "change", "throughput", "", w=width))
+
+    nregress = 0
+    for key in sorted(base):
+        if key not in new:
+            continue
+        b, n = base[key], new[key]
+        tb, tn = b[metric], n[metric]
+        tp, unit = throughput(n)
+        flag = ""
+        if tb > 0.0 and tn > tb*(1.0 + threshold):
+            flag = "REGRESSION"
+            nregress += 1
+        elif tb > 0.0 and tn < tb*(1.0 - threshold):
+            flag = "improved"
+        change = (tb/tn - 1.0)*100.0 if tn > 0.0 else 0.0
+        print("{:<{w}s} {:>11.4g} {:>11.4g} {:>+7.1f}% {:>12.4g} {:<12s} {}".format(
+            label(key), tb, tn, change, tp, unit, flag, w=width))
+
+    for key in sorted(set(base) - set(new)):
+        print("only in {}: {}".format(base_file, label(key)))
+    for key in sorted(set(new) - set(base)):
+        print("only in {}: {}".format(new_file, label(key)))
+
+    print()
+    if nregress > 0:
+        print("{} regression(s) of more than {:.0f}% in {}".format(
+            nregress, threshold*100.0, metric))
+    else:
+        print("no regressions of more than {:.0f}% in {}".format(threshold*100.0, metric))
+    return nregress
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("base", help="the reference results")
+    parser.add_argument("new", help="the results to check")
+    parser.add_argument("--metric", choices=("t_min", "t_avg"), default="t_min",
+                        help="time compared (default t_min)")
+    parser.add_argument("--threshold", type=float, default=0.1,
+                        help="relative slowdown reported as a regression (default 0.1)")
+    args = parser.parse_args()
+
+    nregress = compare(args.base, args.new, args.metric, args.threshold)
+    sys.exit(1 if nregress > 0 else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+
+"""Read the per-step telemetry written by amrex::Telemetry.
+
+Each line of the CSV file is
+
+    step,time,metric,min,avg,max,imbalance,max_rank
+
+where min, avg and max are over the processes, imbalance is max/avg and
+max_rank is the process with the max.
+
+Without options, a summary of every metric over the steps is printed.  With
+--metric, the time series of a metric is printed.  Steps where a metric is
+--factor times slower than the median of the --window previous steps are
+reported as regressions, and the processes that are most often the slowest
+in step_compute are listed.
+"""
+
+from __future__ import print_function
+
+import argparse
+import collections
+import csv
+import sys
+
+
+def read(filename):
+    """Return {metric: [(step, time, min, avg, max, imbalance, max_rank)]}."""
+    series = collections.OrderedDict()
+    with open(filename) as f:
+        for row in csv.DictReader(f):
+            series.setdefault(row["metric"], []).append(
+                (int(row["step"]), float(row["time"]),
+                 float(row["min"]), float(row["avg"]), float(row["max"]),
+                 float(row["imbalance"]), int(row["max_rank"])))
+    return series
+
+
+def median(values):
+    v = sorted(values)
+    n = len(v)
+    if n == 0:
+        return 0.0
+    return v[n//2] if n % 2 == 1 else 0.5*(v[n//2-1] + v[n//2])
+
+
+def summary(series):
+    print("{:<24s} {:>7s} {:>12s} {:>12s} {:>12s} {:>8s}".format(
+        "metric", "steps", "avg", "max", "total", "imbal."))
+    for metric, rows in series.items():
+        avgs = [r[3] for r in rows]
+        print("{:<24s} {:>7d} {:>12.4g} {:>12.4g} {:>12.4g} {:>8.3f}".format(
+            metric, len(rows), sum(avgs)/len(avgs), max(r[4] for r in rows),
+            sum(avgs), sum(r[5] for r in rows)/len(rows)))
+
+
+def timeseries(series, metric):
+    if metric not in series:
+        sys.exit("no metric " + metric)
+    print("{:>7s} {:>12s} {:>12s} {:>12s} {:>12s} {:>8s} {:>8s}".format(
+        "step", "time", "min", "avg", "max", "imbal.", "rank"))
+    for r in series[metric]:
+        print("{:>7d} {:>12.6g} {:>12.4g} {:>12.4g} {:>12.4g} {:>8.3f} {:>8d}".format(*r))
+
+
+def regressions(series, factor, window):
+    found = False
+    for metric, rows in series.items():
+        if metric in ("comm_msgs", "comm_bytes", "fab_bytes"):
+            continue
+        for i in range(window, len(rows)):
+            ref = median([r[4] for r in rows[i-window:i]])
+            if ref > 0.0 and rows[i][4] > factor*ref:
+                found = True
+                print("step {}: {} max {:.4g} is {:.1f}x the median {:.4g} "
+                      "of the previous {} steps (rank {})".format(
+                          rows[i][0], metric, rows[i][4], rows[i][4]/ref, ref,
+                          window, rows[i][6]))
+    if not found:
+        print("no regressions above {}x".format(factor))
+
+
+def slow_ranks(series, n):
+    rows = series.get("step_compute", [])
+    if not rows:
+        return
+    count = collections.Counter(r[6] for r in rows)
+    print("slowest ranks in step_compute (rank: steps):",
+          ", ".join("{}: {}".format(k, v) for k, v in count.most_common(n)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", default="telemetry.csv")
+    parser.add_argument("--metric", help="print the time series of a metric")
+    parser.add_argument("--factor", type=float, default=2.0,
+                        help="slowdown reported as a regression (default 2)")
+    parser.add_argument("--window", type=int, default=10,
+                        help="number of previous steps for the median (default 10)")
+    parser.add_argument("--ranks", type=int, default=5,
+                        help="number of slowest ranks listed (default 5)")
+    args = parser.parse_args()
+
+    series = read(args.file)
+    if args.metric:
+        timeseries(series, args.metric)
+    else:
+        summary(series)
+        print()
+        regressions(series, args.factor, args.window)
+        slow_ranks(series, args.ranks)
+
+
+if __name__ == "__main__":
+    main()